@@ -30,3 +30,422 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+TEST_CASE ("State performance")
+{
+    PluginProcessor plugin;
+
+    juce::MemoryBlock binaryState;
+    plugin.getStateInformation (binaryState);
+
+    juce::MemoryBlock xmlState;
+    std::unique_ptr<juce::XmlElement> xml (plugin.getAPVTS().copyState().createXml());
+    juce::AudioProcessor::copyXmlToBinary (*xml, xmlState);
+
+    BENCHMARK ("Save binary state")
+    {
+        juce::MemoryBlock destData;
+        plugin.getStateInformation (destData);
+        return destData.getSize();
+    };
+
+    BENCHMARK ("Restore binary state")
+    {
+        plugin.setStateInformation (binaryState.getData(), static_cast<int> (binaryState.getSize()));
+    };
+
+    BENCHMARK ("Restore legacy XML state")
+    {
+        plugin.setStateInformation (xmlState.getData(), static_cast<int> (xmlState.getSize()));
+    };
+}
+
+TEST_CASE ("MIDI controller performance")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer notes;
+    for (int note = 0; note < 4; ++note)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 7, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    // Mod wheel, aftertouch and pitch bend on every other sample
+    juce::MidiBuffer denseControllers;
+    for (int i = 0; i < blockSize; i += 2)
+    {
+        denseControllers.addEvent (juce::MidiMessage::controllerEvent (1, 1, i % 128), i);
+        denseControllers.addEvent (juce::MidiMessage::channelPressureChange (1, (i / 2) % 128), i);
+        denseControllers.addEvent (juce::MidiMessage::pitchWheel (1, 8192 + i * 8), i);
+    }
+
+    juce::MidiBuffer noControllers;
+
+    BENCHMARK ("Block without controllers")
+    {
+        auto midi = noControllers;
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    BENCHMARK ("Block with dense controller stream")
+    {
+        auto midi = denseControllers;
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Modulation matrix performance")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer notes;
+    for (int note = 0; note < 4; ++note)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 7, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    auto setRoutes = [&plugin] (int source, int destination) {
+        auto& apvts = plugin.getAPVTS();
+        for (int route = 0; route < ModulationMatrix::numUserRoutes; ++route)
+        {
+            auto* sourceParameter = apvts.getParameter (PluginProcessor::MOD_SOURCE_IDS[route]);
+            auto* destinationParameter = apvts.getParameter (PluginProcessor::MOD_DESTINATION_IDS[route]);
+            sourceParameter->setValueNotifyingHost (sourceParameter->convertTo0to1 (static_cast<float> (source + route)));
+            destinationParameter->setValueNotifyingHost (destinationParameter->convertTo0to1 (static_cast<float> (destination)));
+        }
+    };
+
+    juce::MidiBuffer midi;
+
+    setRoutes (static_cast<int> (ModSource::none), static_cast<int> (ModDestination::none));
+    BENCHMARK ("Block without user routes")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    // LFO 1, LFO 2, filter and amp envelope all into the cutoff
+    setRoutes (static_cast<int> (ModSource::lfo1), static_cast<int> (ModDestination::cutoff));
+    BENCHMARK ("Block with four cutoff routes")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("LFO mode performance")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    plugin.getAPVTS().getParameter (PluginProcessor::LFO_AMOUNT_ID)->setValueNotifyingHost (0.5f);
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    // Full polyphony
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer notes;
+    for (int note = 0; note < 8; ++note)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 5, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    juce::MidiBuffer midi;
+    auto* lfoMode = plugin.getAPVTS().getParameter (PluginProcessor::LFO_MODE_ID);
+
+    lfoMode->setValueNotifyingHost (0.0f);
+    BENCHMARK ("Block with per-voice LFOs")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    lfoMode->setValueNotifyingHost (1.0f);
+    BENCHMARK ("Block with global LFOs")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Unison kernel performance")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer midi;
+    auto* unison = plugin.getAPVTS().getParameter (PluginProcessor::UNISON_VOICES_ID);
+
+    // Full polyphony
+    juce::MidiBuffer notes;
+    for (int note = 0; note < 8; ++note)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 5, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    unison->setValueNotifyingHost (unison->convertTo0to1 (1.0f));
+    BENCHMARK ("Block with 1 unison voice")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    unison->setValueNotifyingHost (unison->convertTo0to1 (5.0f));
+    BENCHMARK ("Block with 5 unison voices")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("HQ filter performance")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    auto& apvts = plugin.getAPVTS();
+    apvts.getParameter (PluginProcessor::FILTER_RESONANCE_ID)->setValueNotifyingHost (0.9f);
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    // Full polyphony
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer notes;
+    for (int note = 0; note < 8; ++note)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 5, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    juce::MidiBuffer midi;
+    auto* hqFilter = apvts.getParameter (PluginProcessor::FILTER_OVERSAMPLING_ID);
+    auto* drive = apvts.getParameter (PluginProcessor::DRIVE_AMOUNT_ID);
+
+    // Without drive the base-rate ladder needs no resampling at all, with drive
+    // both modes pay one 2x round trip and HQ adds the filter at twice the rate
+    for (const auto driveAmount : { 0.0f, 0.8f })
+    {
+        drive->setValueNotifyingHost (driveAmount);
+        const auto suffix = driveAmount > 0.0f ? juce::String (" with drive") : juce::String();
+
+        hqFilter->setValueNotifyingHost (0.0f);
+        BENCHMARK (("Block with base-rate filter" + suffix).toStdString())
+        {
+            plugin.processBlock (buffer, midi);
+            return buffer.getSample (0, 0);
+        };
+
+        hqFilter->setValueNotifyingHost (1.0f);
+        BENCHMARK (("Block with HQ filter" + suffix).toStdString())
+        {
+            plugin.processBlock (buffer, midi);
+            return buffer.getSample (0, 0);
+        };
+    }
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("FX rack performance")
+{
+    constexpr int blockSize = 512;
+
+    PluginProcessor plugin;
+    auto& apvts = plugin.getAPVTS();
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer notes;
+    notes.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0);
+    plugin.processBlock (buffer, notes);
+
+    juce::MidiBuffer midi;
+    const std::array<const char*, 4> modules { PluginProcessor::FX_EQ_ENABLED_ID, PluginProcessor::FX_COMP_ENABLED_ID,
+                                               PluginProcessor::FX_CHORUS_ENABLED_ID, PluginProcessor::FX_MONO_ENABLED_ID };
+
+    // Bypassed modules are skipped per block, so this should match the bare synth
+    BENCHMARK ("Block with the FX rack bypassed")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    for (const auto* id : modules)
+        apvts.getParameter (id)->setValueNotifyingHost (1.0f);
+
+    BENCHMARK ("Block with every FX module on")
+    {
+        plugin.processBlock (buffer, midi);
+        return buffer.getSample (0, 0);
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Convolution performance")
+{
+    constexpr int blockSize = 512;
+    constexpr double sampleRate = 48000.0;
+
+    juce::Random random (1);
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            buffer.setSample (ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+    // A short cab IR stays on the audio thread, longer ones hand the tail to the worker
+    for (const auto seconds : { 0.02, 0.2, 1.0 })
+    {
+        juce::AudioBuffer<float> impulse (1, static_cast<int> (seconds * sampleRate));
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            impulse.setSample (0, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-5.0f * static_cast<float> (i) / static_cast<float> (impulse.getNumSamples())));
+
+        PartitionedConvolution convolution;
+        convolution.prepare (sampleRate, 2);
+        convolution.loadImpulseResponse (impulse, sampleRate);
+
+        BENCHMARK (("Stereo block with a " + juce::String (seconds * 1000.0) + " ms IR").toStdString())
+        {
+            convolution.process (buffer, 1.0f);
+            return buffer.getSample (0, 0);
+        };
+    }
+}
+
+TEST_CASE ("Note cache performance")
+{
+    constexpr int blockSize = 512;
+    constexpr int phraseBlocks = 80;  // notes held for ~0.5 s, then released
+    PluginProcessor plugin;
+    auto& apvts = plugin.getAPVTS();
+    apvts.getParameter (PluginProcessor::LFO_AMOUNT_ID)->setValueNotifyingHost (0.0f);
+    apvts.getParameter (PluginProcessor::GLIDE_TIME_ID)->setValueNotifyingHost (0.0f);
+    plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+    juce::MidiBuffer noteOns, noteOffs, midi;
+    for (int note = 0; note < 8; ++note)
+    {
+        noteOns.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 5, (juce::uint8) 100), 0);
+        noteOffs.addEvent (juce::MidiMessage::noteOff (1, 36 + note * 5), 0);
+    }
+
+    auto playPhrase = [&] {
+        for (int block = 0; block < phraseBlocks; ++block)
+        {
+            auto& events = block == 0 ? noteOns : (block == phraseBlocks / 2 ? noteOffs : midi);
+            plugin.processBlock (buffer, events);
+        }
+        return buffer.getSample (0, 0);
+    };
+
+    BENCHMARK ("Phrase rendered live")
+    {
+        return playPhrase();
+    };
+
+    // The first phrase requests the entries, later ones play from memory
+    apvts.getParameter (PluginProcessor::NOTE_CACHE_ID)->setValueNotifyingHost (1.0f);
+    playPhrase();
+    for (int i = 0; i < 500 && ! plugin.getPrerenderCache().isUpToDate(); ++i)
+        juce::Thread::sleep (10);
+
+    BENCHMARK ("Phrase played from the note cache")
+    {
+        return playPhrase();
+    };
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Voice bank stepping performance")
+{
+    // The bank on its own: the same increments stepped one voice at a time (as
+    // every voice used to inside its own render loop) and through the bank's
+    // tiles, for each number of sounding voices and block size
+    for (const auto blockSize : { 64, 256, 1024 })
+    {
+        for (const auto numSounding : { 1, 2, 4, 8 })
+        {
+            VoiceBank bank (8);  // the synth's polyphony
+            bank.prepare (blockSize);
+            const auto tileSize = bank.getTileSize();
+
+            auto writeIncrements = [&] (int numSamples) {
+                for (int voice = 0; voice < numSounding; ++voice)
+                    for (int sample = 0; sample < numSamples; ++sample)
+                        for (int lane = 0; lane < VoiceBank::numLanes; ++lane)
+                            bank.increment (sample, lane, voice) = 0.001 * (voice + 1) + 0.0001 * lane;
+            };
+
+            const auto suffix = juce::String (numSounding) + " voices, block " + juce::String (blockSize);
+
+            BENCHMARK (("Per-voice stepping, " + suffix).toStdString())
+            {
+                for (int start = 0; start < blockSize; start += tileSize)
+                {
+                    const auto numSamples = juce::jmin (tileSize, blockSize - start);
+                    writeIncrements (numSamples);
+                    for (int voice = 0; voice < numSounding; ++voice)
+                        bank.stepVoice (voice, numSamples);
+                }
+                return bank.phase (0, 0);
+            };
+
+            BENCHMARK (("Bank stepping, " + suffix).toStdString())
+            {
+                for (int start = 0; start < blockSize; start += tileSize)
+                {
+                    const auto numSamples = juce::jmin (tileSize, blockSize - start);
+                    writeIncrements (numSamples);
+                    bank.beginTile();
+                    for (int voice = 0; voice < numSounding; ++voice)
+                        bank.markActive (voice);
+                    bank.stepActive (numSamples);
+                }
+                return bank.phase (0, 0);
+            };
+        }
+    }
+
+    // And the whole synth, where the bank sets the render chunk size
+    for (const auto blockSize : { 64, 256, 1024 })
+    {
+        for (const auto numSounding : { 1, 2, 4, 8 })
+        {
+            PluginProcessor plugin;
+            plugin.setRateAndBufferSizeDetails (48000.0, blockSize);
+            plugin.prepareToPlay (48000.0, blockSize);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            juce::MidiBuffer notes;
+            for (int note = 0; note < numSounding; ++note)
+                notes.addEvent (juce::MidiMessage::noteOn (1, 36 + note * 5, (juce::uint8) 100), 0);
+            plugin.processBlock (buffer, notes);
+
+            juce::MidiBuffer midi;
+            BENCHMARK (("Block with " + juce::String (numSounding) + " voices, block " + juce::String (blockSize)).toStdString())
+            {
+                plugin.processBlock (buffer, midi);
+                return buffer.getSample (0, 0);
+            };
+
+            plugin.releaseResources();
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#include "RenderDaemon.h"
+#include <iostream>
+#include <string>
+
+// Long-running headless renderer: JSON requests on stdin, one JSON response
+// per finished job on stdout (see RenderDaemon.h for the protocol). Put it
+// behind socat or a job runner to serve it over a UNIX socket.
+//
+//   RenderDaemon [--instances N] [--sample-rate HZ] [--block-size N]
+int main (int argc, char* argv[])
+{
+    // The processors' parameter trees and preset library want a message manager
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const juce::ArgumentList arguments (argc, argv);
+    auto option = [&arguments] (const juce::String& name, double fallback) {
+        const auto value = arguments.getValueForOption (name);
+        return value.isEmpty() ? fallback : value.getDoubleValue();
+    };
+
+    RenderDaemon::Options options;
+    options.numInstances = static_cast<int> (option ("--instances", juce::SystemStats::getNumPhysicalCpus()));
+    options.sampleRate = option ("--sample-rate", options.sampleRate);
+    options.blockSize = static_cast<int> (option ("--block-size", options.blockSize));
+
+    RenderDaemon daemon (options, [] (const juce::String& line) { std::cout << line << std::endl; });
+
+    // Clients wait for this before timing anything: the pool is warm
+    std::cout << "{\"status\": \"ready\", \"instances\": " << juce::jmax (1, options.numInstances) << "}" << std::endl;
+
+    for (std::string line; std::getline (std::cin, line);)
+    {
+        if (! daemon.handleLine (juce::String::fromUTF8 (line.c_str())))
+            break;
+    }
+
+    daemon.waitForJobs();
+    return 0;
+}
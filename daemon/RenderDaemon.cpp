@@ -0,0 +1,364 @@
+#include "RenderDaemon.h"
+
+namespace
+{
+    juce::var makeResponse (const juce::String& id, const juce::String& status)
+    {
+        auto* object = new juce::DynamicObject();
+        if (id.isNotEmpty())
+            object->setProperty ("id", id);
+        object->setProperty ("status", status);
+        return object;
+    }
+
+    juce::var makeError (const juce::String& id, const juce::String& message)
+    {
+        auto response = makeResponse (id, "error");
+        response.getDynamicObject()->setProperty ("message", message);
+        return response;
+    }
+
+    juce::File resolvePath (const juce::var& path)
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile (path.toString());
+    }
+}
+
+RenderDaemon::RenderDaemon (const Options& daemonOptions, ResponseCallback callback)
+    : options (daemonOptions),
+      onResponse (std::move (callback)),
+      workers (juce::ThreadPoolOptions {}
+                   .withThreadName ("Thicc Bass render worker")
+                   .withNumberOfThreads (juce::jmax (1, daemonOptions.numInstances)))
+{
+    // Construction and the first prepare are paid here, before any job arrives
+    for (int i = 0; i < juce::jmax (1, options.numInstances); ++i)
+    {
+        auto instance = std::make_unique<Instance>();
+        instance->processor = std::make_unique<PluginProcessor>();
+
+        if (i == 0)
+            instance->processor->getStateInformation (defaultState);
+
+        instance->state = defaultState;
+        prepare (*instance, options.sampleRate, options.blockSize);
+        instances.push_back (std::move (instance));
+    }
+}
+
+RenderDaemon::~RenderDaemon()
+{
+    waitForJobs();
+}
+
+bool RenderDaemon::handleLine (const juce::String& line)
+{
+    const auto text = line.trim();
+    if (text.isEmpty())
+        return true;
+
+    juce::var request;
+    if (juce::JSON::parse (text, request).failed() || ! request.isObject())
+    {
+        respond (makeError ({}, "requests are one JSON object per line"));
+        return true;
+    }
+
+    const auto command = request["command"].toString();
+    if (command == "quit")
+        return false;
+
+    if (command == "stats")
+    {
+        const auto current = getStats();
+        auto response = makeResponse ({}, "ok");
+        auto* object = response.getDynamicObject();
+        object->setProperty ("instances", static_cast<int> (instances.size()));
+        object->setProperty ("jobsRendered", current.jobsRendered);
+        object->setProperty ("jobsFailed", current.jobsFailed);
+        object->setProperty ("statesRestored", current.statesRestored);
+        object->setProperty ("instancesPrepared", current.instancesPrepared);
+        respond (response);
+        return true;
+    }
+
+    if (command.isNotEmpty())
+    {
+        respond (makeError ({}, "unknown command \"" + command + "\""));
+        return true;
+    }
+
+    Job job;
+    juce::String error;
+    if (! parseJob (request, job, error))
+    {
+        respond (makeError (job.id, error));
+        return true;
+    }
+
+    {
+        const std::lock_guard guard (lock);
+        ++jobsPending;
+    }
+
+    workers.addJob ([this, job] { runJob (job); });
+    return true;
+}
+
+void RenderDaemon::waitForJobs()
+{
+    std::unique_lock guard (lock);
+    jobsFinished.wait (guard, [this] { return jobsPending == 0; });
+}
+
+RenderDaemon::Stats RenderDaemon::getStats() const
+{
+    const std::lock_guard guard (lock);
+    return stats;
+}
+
+bool RenderDaemon::parseJob (const juce::var& request, Job& job, juce::String& error) const
+{
+    job.id = request["id"].toString();
+
+    if (! request.hasProperty ("midi") || ! request.hasProperty ("output"))
+    {
+        error = "a job needs \"midi\" and \"output\"";
+        return false;
+    }
+
+    job.midiFile = resolvePath (request["midi"]);
+    job.outputFile = resolvePath (request["output"]);
+    if (request.hasProperty ("state"))
+        job.stateFile = resolvePath (request["state"]);
+
+    job.presetIndex = request.getProperty ("preset", -1);
+    job.sampleRate = request.getProperty ("sampleRate", options.sampleRate);
+    job.blockSize = request.getProperty ("blockSize", options.blockSize);
+    job.tailSeconds = request.getProperty ("tail", 2.0);
+    job.bitDepth = request.getProperty ("bitDepth", 24);
+
+    if (! job.midiFile.existsAsFile())
+        error = "no MIDI file at " + job.midiFile.getFullPathName();
+    else if (request.hasProperty ("state") && ! job.stateFile.existsAsFile())
+        error = "no state file at " + job.stateFile.getFullPathName();
+    else if (request.hasProperty ("state") && request.hasProperty ("preset"))
+        error = "a job takes either \"state\" or \"preset\"";
+    else if (request.hasProperty ("preset") && job.presetIndex < 0)
+        error = "\"preset\" is a factory preset index";
+    else if (job.sampleRate < 8000.0 || job.sampleRate > 384000.0)
+        error = "\"sampleRate\" must be between 8000 and 384000";
+    else if (job.blockSize < 1 || job.blockSize > 16384)
+        error = "\"blockSize\" must be between 1 and 16384";
+    else if (job.tailSeconds < 0.0 || job.tailSeconds > 60.0)
+        error = "\"tail\" must be between 0 and 60 seconds";
+    else if (job.bitDepth != 16 && job.bitDepth != 24 && job.bitDepth != 32)
+        error = "\"bitDepth\" must be 16, 24 or 32";
+
+    return error.isEmpty();
+}
+
+RenderDaemon::Instance& RenderDaemon::acquireInstance (const juce::MemoryBlock& state, int presetIndex)
+{
+    std::unique_lock guard (lock);
+    Instance* chosen = nullptr;
+
+    // There are as many workers as instances, so this only waits if a
+    // release is still on its way
+    instanceFreed.wait (guard, [&] {
+        chosen = nullptr;
+        for (auto& instance : instances)
+        {
+            if (instance->busy)
+                continue;
+
+            // An instance that already holds the job's state skips restoring it
+            if (instance->holds (state, presetIndex))
+            {
+                chosen = instance.get();
+                break;
+            }
+
+            if (chosen == nullptr)
+                chosen = instance.get();
+        }
+        return chosen != nullptr;
+    });
+
+    chosen->busy = true;
+    return *chosen;
+}
+
+void RenderDaemon::releaseInstance (Instance& instance)
+{
+    {
+        const std::lock_guard guard (lock);
+        instance.busy = false;
+    }
+    instanceFreed.notify_one();
+}
+
+void RenderDaemon::runJob (const Job& job)
+{
+    // The state is read first, so the job can go to an instance that holds it
+    juce::MemoryBlock state;
+    juce::var response;
+
+    if (job.stateFile != juce::File() && ! job.stateFile.loadFileAsData (state))
+    {
+        response = makeError (job.id, "can't read state file " + job.stateFile.getFullPathName());
+    }
+    else
+    {
+        if (job.stateFile == juce::File() && job.presetIndex < 0)
+            state = defaultState;
+
+        auto& instance = acquireInstance (state, job.presetIndex);
+        response = render (instance, job, state);
+        releaseInstance (instance);
+    }
+
+    {
+        const std::lock_guard guard (lock);
+        if (response["status"].toString() == "ok")
+            ++stats.jobsRendered;
+        else
+            ++stats.jobsFailed;
+    }
+
+    respond (response);
+
+    {
+        const std::lock_guard guard (lock);
+        --jobsPending;
+    }
+    jobsFinished.notify_all();
+}
+
+juce::var RenderDaemon::render (Instance& instance, const Job& job, const juce::MemoryBlock& state)
+{
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    auto& processor = *instance.processor;
+
+    // MIDI first, so a bad file doesn't cost a state change. Every track is
+    // merged into one sequence, timed in seconds
+    juce::FileInputStream midiStream (job.midiFile);
+    juce::MidiFile midiFile;
+    if (! midiStream.openedOk() || ! midiFile.readFrom (midiStream))
+        return makeError (job.id, "can't read MIDI file " + job.midiFile.getFullPathName());
+
+    midiFile.convertTimestampTicksToSeconds();
+    juce::MidiMessageSequence sequence;
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+        sequence.addSequence (*midiFile.getTrack (track), 0.0);
+
+    if (! instance.holds (state, job.presetIndex))
+    {
+        if (job.presetIndex >= 0)
+        {
+            auto& presets = processor.getPresetManager();
+            if (job.presetIndex >= static_cast<int> (presets.getPresets().size()))
+                return makeError (job.id, "no factory preset " + juce::String (job.presetIndex));
+
+            // A preset only sets the sound parameters - everything else (FX
+            // rack, matrix, morph, cabinet...) goes back to a fresh instance's
+            // first, not whatever the previous job on this instance left
+            processor.setStateInformation (defaultState.getData(), static_cast<int> (defaultState.getSize()));
+            presets.setCurrentPresetIndex (job.presetIndex);
+            processor.loadPreset (presets.getCurrentPreset());
+        }
+        else
+        {
+            processor.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        }
+
+        instance.state = state;
+        instance.presetIndex = job.presetIndex;
+
+        const std::lock_guard guard (lock);
+        ++stats.statesRestored;
+    }
+
+    if (! juce::exactlyEqual (instance.sampleRate, job.sampleRate) || instance.blockSize != job.blockSize)
+        prepare (instance, job.sampleRate, job.blockSize);
+
+    // Nothing of the previous job rings on into this one, and a preset
+    // switch starts without its crossfade
+    processor.reset();
+
+    // The audio goes to disk block by block as it renders
+    const auto numChannels = processor.getTotalNumOutputChannels();
+    job.outputFile.getParentDirectory().createDirectory();
+    job.outputFile.deleteFile();
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (job.outputFile),
+        job.sampleRate,
+        static_cast<unsigned int> (numChannels),
+        job.bitDepth,
+        {},
+        0));
+
+    if (writer == nullptr)
+        return makeError (job.id, "can't write " + job.outputFile.getFullPathName());
+
+    const auto totalSamples = static_cast<int> (std::ceil ((sequence.getEndTime() + job.tailSeconds) * job.sampleRate));
+    juce::AudioBuffer<float> block (numChannels, job.blockSize);
+    juce::MidiBuffer blockMidi;
+    int nextEvent = 0;
+
+    for (int position = 0; position < totalSamples; position += job.blockSize)
+    {
+        const int numSamples = juce::jmin (job.blockSize, totalSamples - position);
+        block.setSize (numChannels, numSamples, false, false, true);
+
+        blockMidi.clear();
+        for (; nextEvent < sequence.getNumEvents(); ++nextEvent)
+        {
+            const auto& message = sequence.getEventPointer (nextEvent)->message;
+            const auto samplePosition = juce::roundToInt (message.getTimeStamp() * job.sampleRate);
+            if (samplePosition >= position + numSamples)
+                break;
+
+            if (! message.isMetaEvent())
+                blockMidi.addEvent (message, juce::jmax (0, samplePosition - position));
+        }
+
+        processor.processBlock (block, blockMidi);
+
+        if (! writer->writeFromAudioSampleBuffer (block, 0, numSamples))
+        {
+            writer.reset();
+            job.outputFile.deleteFile();
+            return makeError (job.id, "writing " + job.outputFile.getFullPathName() + " failed");
+        }
+    }
+
+    writer.reset();
+
+    auto response = makeResponse (job.id, "ok");
+    auto* object = response.getDynamicObject();
+    object->setProperty ("output", job.outputFile.getFullPathName());
+    object->setProperty ("samples", totalSamples);
+    object->setProperty ("renderSeconds", (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0);
+    return response;
+}
+
+void RenderDaemon::prepare (Instance& instance, double sampleRate, int blockSize)
+{
+    // Every job is a bounce: the processors render with the offline quality profile
+    instance.processor->setNonRealtime (true);
+    instance.processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+    instance.processor->prepareToPlay (sampleRate, blockSize);
+    instance.sampleRate = sampleRate;
+    instance.blockSize = blockSize;
+
+    const std::lock_guard guard (lock);
+    ++stats.instancesPrepared;
+}
+
+void RenderDaemon::respond (const juce::var& response)
+{
+    const std::lock_guard guard (responseLock);
+    onResponse (juce::JSON::toString (response, true));
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <PluginProcessor.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Headless render server for render farms
+//
+// Keeps a pool of constructed and prepared PluginProcessor instances and
+// renders jobs on them, so construction, prepareToPlay and preset setup are
+// paid once per instance instead of once per job. Between jobs an instance is
+// reset() rather than rebuilt; it is only re-prepared when a job asks for a
+// different sample rate or block size, and its state is only restored when the
+// job's state differs from the last one it rendered. Jobs go to the free
+// instance that already holds their state where there is one.
+//
+// Requests and responses are one JSON object per line:
+//
+//   {"id": "a", "midi": "in.mid", "output": "out.wav"}      render a job
+//     optional: "state" (a saved plugin state file), "preset" (factory
+//     preset index), "sampleRate", "blockSize", "tail" (seconds rendered
+//     after the last MIDI event), "bitDepth" (16, 24 or 32 = float)
+//   {"command": "stats"}                                      pool counters
+//   {"command": "quit"}                                       finish and exit
+//
+// Every job answers with {"id", "status": "ok" | "error", ...} as soon as it
+// is done, so responses can arrive out of order. The audio is streamed to the
+// output file block by block while it renders.
+class RenderDaemon
+{
+public:
+    struct Options
+    {
+        int numInstances = 2;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+    };
+
+    // Called from the worker threads, one complete response line at a time
+    using ResponseCallback = std::function<void (const juce::String& line)>;
+
+    RenderDaemon (const Options& options, ResponseCallback onResponse);
+    ~RenderDaemon();
+
+    // Parses one request and queues it. Returns false once asked to quit
+    bool handleLine (const juce::String& line);
+
+    // Blocks until every queued job has answered
+    void waitForJobs();
+
+    struct Stats
+    {
+        int jobsRendered = 0;
+        int jobsFailed = 0;
+        int statesRestored = 0;  // jobs that had to load a different state
+        int instancesPrepared = 0;  // prepareToPlay calls, the initial ones included
+    };
+    Stats getStats() const;
+
+private:
+    struct Job
+    {
+        juce::String id;
+        juce::File midiFile;
+        juce::File stateFile;
+        int presetIndex = -1;
+        juce::File outputFile;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        double tailSeconds = 2.0;
+        int bitDepth = 24;
+    };
+
+    struct Instance
+    {
+        std::unique_ptr<PluginProcessor> processor;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+
+        // What the parameters were last set from: a state blob or a factory preset
+        juce::MemoryBlock state;
+        int presetIndex = -1;
+
+        bool busy = false;
+
+        bool holds (const juce::MemoryBlock& otherState, int otherPresetIndex) const
+        {
+            return presetIndex == otherPresetIndex && state == otherState;
+        }
+    };
+
+    bool parseJob (const juce::var& request, Job& job, juce::String& error) const;
+    Instance& acquireInstance (const juce::MemoryBlock& state, int presetIndex);
+    void releaseInstance (Instance& instance);
+    void runJob (const Job& job);
+    juce::var render (Instance& instance, const Job& job, const juce::MemoryBlock& state);
+    void prepare (Instance& instance, double sampleRate, int blockSize);
+    void respond (const juce::var& response);
+
+    const Options options;
+    const ResponseCallback onResponse;
+
+    // The state of a freshly constructed instance, restored for jobs without
+    // a state or preset of their own
+    juce::MemoryBlock defaultState;
+
+    mutable std::mutex lock;
+    std::condition_variable instanceFreed;
+    std::condition_variable jobsFinished;
+    std::vector<std::unique_ptr<Instance>> instances;
+    int jobsPending = 0;
+    Stats stats;
+
+    std::mutex responseLock;
+
+    // One worker per instance, so a queued job always finds one free
+    juce::ThreadPool workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderDaemon)
+};
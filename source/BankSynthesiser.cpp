@@ -0,0 +1,42 @@
+#include "BankSynthesiser.h"
+#include "SynthVoice.h"
+
+void BankSynthesiser::renderVoices (juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    renderBankedVoices (output, startSample, numSamples);
+}
+
+void BankSynthesiser::renderVoices (juce::AudioBuffer<double>& output, int startSample, int numSamples)
+{
+    renderBankedVoices (output, startSample, numSamples);
+}
+
+template <typename SampleType>
+void BankSynthesiser::renderBankedVoices (juce::AudioBuffer<SampleType>& output, int startSample, int numSamples)
+{
+    // Not prepared yet: every voice steps its own phases
+    if (bank.getTileSize() <= 0)
+    {
+        juce::Synthesiser::renderVoices (output, startSample, numSamples);
+        return;
+    }
+
+    while (numSamples > 0)
+    {
+        const int pieceLength = juce::jmin (numSamples, bank.getTileSize());
+
+        // The voices that write increments mark themselves; only they step
+        bank.beginTile();
+        for (auto* voice : voices)
+        {
+            if (auto* synthVoice = dynamic_cast<SynthVoice*> (voice))
+                synthVoice->prepareBankedChunk (startSample, pieceLength);
+        }
+
+        bank.stepActive (pieceLength);
+
+        juce::Synthesiser::renderVoices (output, startSample, pieceLength);
+        startSample += pieceLength;
+        numSamples -= pieceLength;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "VoiceBank.h"
+
+// juce::Synthesiser whose voices step their oscillators together
+//
+// Each render segment is cut into pieces of one bank tile, so the step rows
+// stay in L1 between writing and reading them. For every piece the live
+// voices first run their modulation and write their oscillator increments
+// into the VoiceBank, the bank steps the phases of the voices that wrote
+// them in one pass across voices, and then the voices render from those
+// phases. Voices that are idle or playing cached audio take no part and
+// render on their own as before.
+class BankSynthesiser : public juce::Synthesiser
+{
+public:
+    explicit BankSynthesiser (VoiceBank& voiceBank) : bank (voiceBank) {}
+
+protected:
+    void renderVoices (juce::AudioBuffer<float>& output, int startSample, int numSamples) override;
+    void renderVoices (juce::AudioBuffer<double>& output, int startSample, int numSamples) override;
+
+private:
+    template <typename SampleType>
+    void renderBankedVoices (juce::AudioBuffer<SampleType>& output, int startSample, int numSamples);
+
+    VoiceBank& bank;
+};
@@ -0,0 +1,12 @@
+#include "DspTables.h"
+#include <cmath>
+
+DspTables::DspTables()
+{
+    for (size_t i = 0; i < sineTable.size(); ++i)
+        sineTable[i] = static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * static_cast<double> (i) / sineSize));
+
+    // Same expression the voices used per note, so the pitches don't move
+    for (size_t note = 0; note < noteFrequencies.size(); ++note)
+        noteFrequencies[note] = 440.0 * std::pow (2.0, (static_cast<int> (note) - 69) / 12.0);
+}
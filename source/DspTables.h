@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+
+// Read-only lookup tables for the DSP, one set per process
+//
+// Hold it through juce::SharedResourcePointer<DspTables>: the first holder
+// builds the tables (under JUCE's lock, so concurrent first uses are safe),
+// every later one shares them, and the last one to go frees them. Holders
+// are plugin objects created on the message thread, so the tables are never
+// built on the audio thread. Nothing changes after construction - any number
+// of voices and instances read them at once without locking.
+class DspTables
+{
+public:
+    DspTables();
+
+    // === Audio thread ===
+    // One sine cycle for the LFOs, phase 0-1, linearly interpolated. Audio-rate
+    // oscillators and the drive compute theirs, in the render's own precision
+    float sine (double phase) const
+    {
+        const auto position = static_cast<float> (phase * sineSize);
+        const auto index = juce::jlimit (0, sineSize - 1, static_cast<int> (position));
+        const auto fraction = position - static_cast<float> (index);
+        return sineTable[static_cast<size_t> (index)] + fraction * (sineTable[static_cast<size_t> (index) + 1] - sineTable[static_cast<size_t> (index)]);
+    }
+
+    // Equal tempered, A4 = 440 Hz
+    double noteFrequency (int midiNote) const { return noteFrequencies[static_cast<size_t> (juce::jlimit (0, 127, midiNote))]; }
+
+    static constexpr int sineSize = 2048;
+
+private:
+    // One guard point, so the interpolation never wraps
+    std::array<float, sineSize + 1> sineTable;
+    std::array<double, 128> noteFrequencies;
+
+    JUCE_DECLARE_NON_COPYABLE (DspTables)
+};
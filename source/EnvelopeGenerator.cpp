@@ -0,0 +1,143 @@
+#include "EnvelopeGenerator.h"
+
+void EnvelopeGenerator::setSampleRate (double newSampleRate)
+{
+    jassert (newSampleRate > 0.0);
+    sampleRate = newSampleRate;
+    updateCoefficients();
+}
+
+void EnvelopeGenerator::setParameters (const Parameters& newParameters)
+{
+    parameters = newParameters;
+    parameters.sustain = juce::jlimit (0.0f, 1.0f, parameters.sustain);
+    updateCoefficients();
+}
+
+void EnvelopeGenerator::noteOn()
+{
+    stage = Stage::attack;
+    clearFastRelease();
+}
+
+void EnvelopeGenerator::noteOff()
+{
+    if (stage != Stage::idle)
+        stage = Stage::release;
+}
+
+void EnvelopeGenerator::reset()
+{
+    stage = Stage::idle;
+    level = 0.0f;
+    clearFastRelease();
+}
+
+void EnvelopeGenerator::fastRelease (float seconds)
+{
+    if (stage == Stage::idle)
+        return;
+
+    stage = Stage::release;
+    fastReleaseSeconds = juce::jmax (1.0e-4f, seconds);
+    releaseCoefficient = getCoefficient (fastReleaseSeconds, decayReleaseTargetRatio);
+}
+
+void EnvelopeGenerator::clearFastRelease()
+{
+    if (fastReleaseSeconds <= 0.0f)
+        return;
+
+    fastReleaseSeconds = 0.0f;
+    releaseCoefficient = getCoefficient (parameters.release, decayReleaseTargetRatio);
+}
+
+float EnvelopeGenerator::getCoefficient (float seconds, float targetRatio) const
+{
+    const auto numSamples = juce::jmax (1.0, static_cast<double> (seconds) * sampleRate);
+    return static_cast<float> (std::exp (-std::log ((1.0 + targetRatio) / targetRatio) / numSamples));
+}
+
+void EnvelopeGenerator::updateCoefficients()
+{
+    attackCoefficient = getCoefficient (parameters.attack, attackTargetRatio);
+    decayCoefficient = getCoefficient (parameters.decay, decayReleaseTargetRatio);
+    releaseCoefficient = getCoefficient (fastReleaseSeconds > 0.0f ? fastReleaseSeconds : parameters.release, decayReleaseTargetRatio);
+
+    decayTarget = parameters.sustain - decayReleaseTargetRatio * (1.0f - parameters.sustain);
+}
+
+int EnvelopeGenerator::process (float* output, int numSamples)
+{
+    int sample = 0;
+
+    while (sample < numSamples)
+    {
+        switch (stage)
+        {
+            case Stage::attack:
+                for (; sample < numSamples; ++sample)
+                {
+                    level = attackTarget + (level - attackTarget) * attackCoefficient;
+                    if (level >= 1.0f)
+                    {
+                        level = 1.0f;
+                        output[sample++] = level;
+                        stage = Stage::decay;
+                        break;
+                    }
+                    output[sample] = level;
+                }
+                break;
+
+            case Stage::decay:
+                for (; sample < numSamples; ++sample)
+                {
+                    level = decayTarget + (level - decayTarget) * decayCoefficient;
+                    if (level <= parameters.sustain)
+                    {
+                        // Nothing left to hear until the next note-on
+                        if (parameters.sustain < silenceThreshold)
+                        {
+                            reset();
+                            break;
+                        }
+
+                        level = parameters.sustain;
+                        output[sample++] = level;
+                        stage = Stage::sustain;
+                        break;
+                    }
+                    output[sample] = level;
+                }
+                break;
+
+            case Stage::sustain:
+                // Follows sustain changes straight away, like juce::ADSR
+                level = parameters.sustain;
+                juce::FloatVectorOperations::fill (output + sample, level, numSamples - sample);
+                sample = numSamples;
+                break;
+
+            case Stage::release:
+                for (; sample < numSamples; ++sample)
+                {
+                    level = releaseTarget + (level - releaseTarget) * releaseCoefficient;
+                    if (level < silenceThreshold)
+                    {
+                        reset();
+                        break;
+                    }
+                    output[sample] = level;
+                }
+                break;
+
+            case Stage::idle:
+            default:
+                juce::FloatVectorOperations::clear (output + sample, numSamples - sample);
+                return sample;
+        }
+    }
+
+    return numSamples;
+}
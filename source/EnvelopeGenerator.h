@@ -0,0 +1,76 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// ADSR envelope with exponential (one-pole) segments
+//
+// Every segment moves towards a target a little past its end point, the way
+// an analog RC envelope does: attack aims above 1 so it still arrives in the
+// set time, decay and release aim slightly below their end. Times are the time
+// to cover the full segment (0 -> 1, 1 -> sustain, 1 -> 0).
+//
+// process() renders whole blocks and reports the sample at which the release
+// (or a decay to zero sustain) fell below silenceThreshold, so a voice can be
+// retired mid-block instead of rendering an inaudible tail until the next
+// block starts.
+class EnvelopeGenerator
+{
+public:
+    struct Parameters
+    {
+        float attack = 0.01f;   // seconds
+        float decay = 0.1f;     // seconds
+        float sustain = 0.8f;   // 0-1
+        float release = 0.1f;   // seconds
+    };
+
+    static constexpr float silenceThreshold = 1.5849e-5f;  // -96 dB
+
+    void setSampleRate (double newSampleRate);
+    void setParameters (const Parameters& newParameters);
+    const Parameters& getParameters() const { return parameters; }
+
+    // Starts the attack from the current level, so retriggers don't click
+    void noteOn();
+    void noteOff();
+    void reset();
+
+    // Releases over the given time instead of the release parameter until the
+    // next note-on, for retiring a voice early without a click
+    void fastRelease (float seconds);
+
+    bool isActive() const { return stage != Stage::idle; }
+    bool isReleasing() const { return stage == Stage::release; }
+    float getLevel() const { return level; }
+
+    // Writes the next numSamples of the envelope. Returns how many samples were
+    // rendered before the envelope went idle - numSamples while it's still
+    // active. Samples after that point are zero
+    int process (float* output, int numSamples);
+
+private:
+    enum class Stage { idle, attack, decay, sustain, release };
+
+    // One-pole coefficient that covers a segment in the given time when
+    // aiming targetRatio (of the segment size) past its end
+    float getCoefficient (float seconds, float targetRatio) const;
+    void updateCoefficients();
+    void clearFastRelease();
+
+    static constexpr float attackTargetRatio = 0.3f;
+    static constexpr float decayReleaseTargetRatio = 0.0001f;
+
+    Parameters parameters;
+    double sampleRate = 44100.0;
+
+    Stage stage = Stage::idle;
+    float level = 0.0f;
+
+    float attackCoefficient = 0.0f;
+    float attackTarget = 1.0f + attackTargetRatio;
+    float decayCoefficient = 0.0f;
+    float decayTarget = 0.0f;
+    float releaseCoefficient = 0.0f;
+    float releaseTarget = -decayReleaseTargetRatio;
+    float fastReleaseSeconds = 0.0f;  // 0 while the release parameter applies
+};
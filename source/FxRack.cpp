@@ -0,0 +1,173 @@
+#include "FxRack.h"
+
+template <typename SampleType>
+void FxRack<SampleType>::prepare (double newSampleRate, int maximumBlockSize, int numChannels)
+{
+    sampleRate = newSampleRate;
+    preparedChannels = numChannels;
+
+    const juce::dsp::ProcessSpec spec { sampleRate, static_cast<juce::uint32> (maximumBlockSize), static_cast<juce::uint32> (numChannels) };
+
+    lowShelf.prepare (spec);
+    tiltShelf.prepare (spec);
+    updateEqCoefficients();
+
+    compressor.prepare (spec);
+    compressor.setAttack (compressorAttackMs);
+    compressor.setRelease (compressorReleaseMs);
+
+    chorusDelay.setMaximumDelayInSamples (static_cast<int> (std::ceil ((chorusCentreDelayMs + chorusDepthMs) * sampleRate / 1000.0)) + 2);
+    chorusDelay.prepare (spec);
+    chorusMix.reset (sampleRate, 0.05);
+
+    crossover.prepare (spec);
+    crossover.setType (juce::dsp::LinkwitzRileyFilterType::lowpass);
+
+    setSettings (settings);
+    reset();
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::reset()
+{
+    lowShelf.reset();
+    tiltShelf.reset();
+    compressor.reset();
+    chorusDelay.reset();
+    chorusMix.setCurrentAndTargetValue (static_cast<SampleType> (juce::jlimit (0.0f, 1.0f, settings.chorusMix)));
+    chorusPhase = 0.0;
+    crossover.reset();
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::setSettings (const Settings& newSettings)
+{
+    // Modules coming back on start clean
+    if (newSettings.eqEnabled && ! settings.eqEnabled)
+    {
+        lowShelf.reset();
+        tiltShelf.reset();
+    }
+    if (newSettings.compressorEnabled && ! settings.compressorEnabled)
+        compressor.reset();
+    if (newSettings.chorusEnabled && ! settings.chorusEnabled)
+    {
+        chorusDelay.reset();
+        chorusMix.setCurrentAndTargetValue (static_cast<SampleType> (juce::jlimit (0.0f, 1.0f, newSettings.chorusMix)));
+        chorusPhase = 0.0;
+    }
+    if (newSettings.monoEnabled && ! settings.monoEnabled)
+        crossover.reset();
+
+    settings = newSettings;
+
+    if (settings.eqEnabled && (! juce::exactlyEqual (settings.lowShelfGain, appliedLowShelfGain)
+                               || ! juce::exactlyEqual (settings.tilt, appliedTilt)))
+        updateEqCoefficients();
+
+    compressor.setThreshold (static_cast<SampleType> (settings.compressorThreshold));
+    compressor.setRatio (static_cast<SampleType> (juce::jmax (1.0f, settings.compressorRatio)));
+    chorusMix.setTargetValue (static_cast<SampleType> (juce::jlimit (0.0f, 1.0f, settings.chorusMix)));
+    crossover.setCutoffFrequency (static_cast<SampleType> (settings.monoFrequency));
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::updateEqCoefficients()
+{
+    // Assigning array coefficients reuses the existing storage - no allocation
+    using Coefficients = juce::dsp::IIR::ArrayCoefficients<SampleType>;
+    const auto q = static_cast<SampleType> (juce::MathConstants<double>::sqrt2 / 2.0);
+
+    *lowShelf.state = Coefficients::makeLowShelf (sampleRate, static_cast<SampleType> (lowShelfFrequency), q,
+                                                  juce::Decibels::decibelsToGain (static_cast<SampleType> (settings.lowShelfGain)));
+    // Tilt: a high shelf of the full tilt with half of it taken off overall,
+    // so the lows drop by as much as the highs rise
+    auto tiltCoefficients = Coefficients::makeHighShelf (sampleRate, static_cast<SampleType> (tiltFrequency), q,
+                                                         juce::Decibels::decibelsToGain (static_cast<SampleType> (settings.tilt)));
+    const auto tiltTrim = juce::Decibels::decibelsToGain (static_cast<SampleType> (-0.5f * settings.tilt));
+    for (size_t i = 0; i < 3; ++i)
+        tiltCoefficients[i] *= tiltTrim;
+    *tiltShelf.state = tiltCoefficients;
+
+    appliedLowShelfGain = settings.lowShelfGain;
+    appliedTilt = settings.tilt;
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::process (juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    juce::dsp::ProcessContextReplacing<SampleType> context (block);
+
+    if (settings.eqEnabled)
+    {
+        lowShelf.process (context);
+        tiltShelf.process (context);
+    }
+
+    if (settings.compressorEnabled)
+        compressor.process (context);
+
+    if (settings.chorusEnabled)
+        processChorus (buffer);
+
+    if (settings.monoEnabled && buffer.getNumChannels() > 1)
+        processMonoMaker (buffer);
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::processChorus (juce::AudioBuffer<SampleType>& buffer)
+{
+    const int numChannels = juce::jmin (buffer.getNumChannels(), preparedChannels);
+    const auto phaseDelta = static_cast<double> (juce::jmax (0.0f, settings.chorusRate)) / sampleRate;
+    const auto samplesPerMs = sampleRate / 1000.0;
+    auto* const* channels = buffer.getArrayOfWritePointers();
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        const auto mix = chorusMix.getNextValue();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto lfo = std::sin (juce::MathConstants<double>::twoPi * (chorusPhase + channel * chorusChannelOffset));
+            const auto delay = static_cast<SampleType> ((chorusCentreDelayMs + chorusDepthMs * lfo) * samplesPerMs);
+
+            const auto dry = channels[channel][sample];
+            chorusDelay.pushSample (channel, dry);
+            const auto wet = chorusDelay.popSample (channel, delay);
+            channels[channel][sample] = dry + mix * (wet - dry);
+        }
+
+        chorusPhase += phaseDelta;
+        if (chorusPhase >= 1.0)
+            chorusPhase -= 1.0;
+    }
+}
+
+template <typename SampleType>
+void FxRack<SampleType>::processMonoMaker (juce::AudioBuffer<SampleType>& buffer)
+{
+    const int numChannels = buffer.getNumChannels();
+    const auto channelScale = static_cast<SampleType> (1.0 / numChannels);
+    auto* const* channels = buffer.getArrayOfWritePointers();
+
+    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    {
+        // Split every channel, keep its highs and replace its lows with the mono sum
+        SampleType lowSum = 0;
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            SampleType low, high;
+            crossover.processSample (channel, channels[channel][sample], low, high);
+            channels[channel][sample] = high;
+            lowSum += low;
+        }
+
+        const auto lowMono = lowSum * channelScale;
+        for (int channel = 0; channel < numChannels; ++channel)
+            channels[channel][sample] += lowMono;
+    }
+}
+
+template class FxRack<float>;
+template class FxRack<double>;
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Settings of the FX rack, shared by both sample types
+struct FxSettings
+{
+    bool eqEnabled = false;
+    float lowShelfGain = 0.0f;           // dB below ~100 Hz
+    float tilt = 0.0f;                   // dB, pivoting around ~1.5 kHz (+ brighter, - darker)
+
+    bool compressorEnabled = false;
+    float compressorThreshold = -18.0f;  // dB
+    float compressorRatio = 4.0f;
+
+    bool chorusEnabled = false;
+    float chorusRate = 0.8f;             // Hz
+    float chorusMix = 0.3f;              // 0-1
+
+    bool monoEnabled = false;
+    float monoFrequency = 120.0f;        // Hz, everything below is summed to mono
+};
+
+// Post-synth effects for a finished bass: low-shelf/tilt EQ, compressor,
+// chorus and a mono-maker below a crossover, in that order (the mono-maker
+// comes last so the chorus never widens the low end)
+//
+// The voices are mono, so the chorus is where the width comes from: one LFO
+// modulates a delay per channel, each channel reading it a quarter cycle
+// further on, so left and right sweep apart
+//
+// Every module is prepared up front, so processing never allocates. A
+// bypassed module is skipped for the whole block rather than checked per
+// sample, and is reset when it comes back on so it never replays stale state.
+template <typename SampleType>
+class FxRack
+{
+public:
+    using Settings = FxSettings;
+
+    void prepare (double sampleRate, int maximumBlockSize, int numChannels);
+    void reset();
+
+    // Per block, before process() (audio thread)
+    void setSettings (const Settings& newSettings);
+
+    void process (juce::AudioBuffer<SampleType>& buffer);
+
+private:
+    using Filter = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<SampleType>, juce::dsp::IIR::Coefficients<SampleType>>;
+
+    static constexpr double lowShelfFrequency = 100.0;
+    static constexpr double tiltFrequency = 1500.0;
+    static constexpr float compressorAttackMs = 10.0f;
+    static constexpr float compressorReleaseMs = 120.0f;
+    static constexpr double chorusCentreDelayMs = 7.0;
+    static constexpr double chorusDepthMs = 3.0;
+    static constexpr double chorusChannelOffset = 0.25;  // LFO cycles between neighbouring channels
+
+    void updateEqCoefficients();
+    void processChorus (juce::AudioBuffer<SampleType>& buffer);
+    void processMonoMaker (juce::AudioBuffer<SampleType>& buffer);
+
+    double sampleRate = 44100.0;
+    int preparedChannels = 0;
+    Settings settings;
+
+    Filter lowShelf { new juce::dsp::IIR::Coefficients<SampleType> (1, 0, 0, 1, 0, 0) };
+    Filter tiltShelf { new juce::dsp::IIR::Coefficients<SampleType> (1, 0, 0, 1, 0, 0) };
+    float appliedLowShelfGain = 0.0f;
+    float appliedTilt = 0.0f;
+
+    juce::dsp::Compressor<SampleType> compressor;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Linear> chorusDelay;
+    juce::SmoothedValue<SampleType> chorusMix;
+    double chorusPhase = 0.0;
+    juce::dsp::LinkwitzRileyFilter<SampleType> crossover;
+};
@@ -0,0 +1,78 @@
+#include "GlobalModulation.h"
+
+juce::StringArray GlobalModulation::getSyncNames()
+{
+    return { "Off", "4 Bars", "2 Bars", "1 Bar", "1/2", "1/4", "1/8", "1/16", "1/4 T", "1/8 T", "1/16 T" };
+}
+
+double GlobalModulation::getBeatsPerCycle (int syncIndex)
+{
+    static constexpr double beatsPerCycle[] = { 0.0, 16.0, 8.0, 4.0, 2.0, 1.0, 0.5, 0.25, 2.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0 };
+    return juce::isPositiveAndBelow (syncIndex, static_cast<int> (std::size (beatsPerCycle))) ? beatsPerCycle[syncIndex] : 0.0;
+}
+
+void GlobalModulation::prepare (double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    rows.setSize (2, maximumBlockSize);
+    reset();
+}
+
+void GlobalModulation::reset()
+{
+    rows.clear();
+    lfoPhase = 0.0;
+    lfo2Phase = 0.0;
+}
+
+double GlobalModulation::updateLfoPhaseDelta (float lfoRate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position)
+{
+    const auto beatsPerCycle = getBeatsPerCycle (syncIndex);
+    if (beatsPerCycle <= 0.0)
+        return lfoRate / sampleRate;
+
+    if (position != nullptr)
+        bpm = position->getBpm().orFallback (bpm);
+
+    // Locked to the song position while playing, free-running at the synced rate otherwise
+    if (position != nullptr && position->getIsPlaying())
+        if (const auto ppq = position->getPpqPosition())
+            lfoPhase = std::fmod (*ppq / beatsPerCycle, 1.0) + (*ppq < 0.0 ? 1.0 : 0.0);
+
+    return bpm / (60.0 * beatsPerCycle * sampleRate);
+}
+
+bool GlobalModulation::process (int numSamples, float lfoRate, float lfo2Rate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position)
+{
+    if (numSamples > rows.getNumSamples())
+        return false;
+
+    const double lfoPhaseDelta = updateLfoPhaseDelta (lfoRate, syncIndex, position);
+    const double lfo2PhaseDelta = lfo2Rate / sampleRate;
+
+    auto* lfo1 = rows.getWritePointer (0);
+    auto* lfo2 = rows.getWritePointer (1);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        lfo1[sample] = tables->sine (lfoPhase);
+        lfoPhase += lfoPhaseDelta;
+        if (lfoPhase >= 1.0)
+            lfoPhase -= 1.0;
+
+        lfo2[sample] = lfo_shapes::triangle (lfo2Phase);
+        lfo2Phase += lfo2PhaseDelta;
+        if (lfo2Phase >= 1.0)
+            lfo2Phase -= 1.0;
+    }
+
+    return true;
+}
+
+void GlobalModulation::advance (int numSamples, float lfoRate, float lfo2Rate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position)
+{
+    const double lfoPhaseDelta = updateLfoPhaseDelta (lfoRate, syncIndex, position);
+
+    lfoPhase = std::fmod (lfoPhase + lfoPhaseDelta * numSamples, 1.0);
+    lfo2Phase = std::fmod (lfo2Phase + lfo2Rate / sampleRate * numSamples, 1.0);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "DspTables.h"
+
+// LFO shapes, shared by the per-voice and the global LFOs so both modes sound
+// the same. The sine comes from the shared DspTables
+namespace lfo_shapes
+{
+    inline float triangle (double phase)
+    {
+        return static_cast<float> (1.0 - 4.0 * std::abs (phase - 0.5));
+    }
+}
+
+// Modulation sources shared by every voice
+//
+// In global mode the two LFOs run here once per block instead of once per
+// voice. Voices read the rows as read-only buffers, so every note sees the
+// same phase and the per-sample sin() is paid once rather than per voice.
+// LFO 1 can follow the host tempo, locked to the song position while the
+// transport is running.
+class GlobalModulation
+{
+public:
+    static juce::StringArray getSyncNames();
+
+    void prepare (double newSampleRate, int maximumBlockSize);
+    void reset();
+
+    // Renders both LFOs for the next block (audio thread). Returns false when
+    // the block is larger than prepared - the voices use their own LFOs then
+    bool process (int numSamples, float lfoRate, float lfo2Rate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position);
+
+    // Moves both phases on by a block without rendering, for blocks where no
+    // voice is sounding - the next note picks the LFOs up where they'd be
+    void advance (int numSamples, float lfoRate, float lfo2Rate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position);
+
+    const float* getLfo1() const { return rows.getReadPointer (0); }
+    const float* getLfo2() const { return rows.getReadPointer (1); }
+
+private:
+    // Length of one LFO 1 cycle in quarter notes, 0 when free-running
+    static double getBeatsPerCycle (int syncIndex);
+
+    // LFO 1 phase increment per sample; re-locks the phase to the song position when synced
+    double updateLfoPhaseDelta (float lfoRate, int syncIndex, const juce::AudioPlayHead::PositionInfo* position);
+
+    juce::SharedResourcePointer<DspTables> tables;
+    juce::AudioBuffer<float> rows;  // LFO 1, LFO 2
+    double sampleRate = 44100.0;
+    double lfoPhase = 0.0;
+    double lfo2Phase = 0.0;
+    double bpm = 120.0;  // last known host tempo
+};
@@ -0,0 +1,173 @@
+#include "MidiControllerMap.h"
+
+MidiControllerMap::MidiControllerMap()
+{
+    for (auto& source : ccSources)
+        source.store (ControllerSource::none);
+
+    // Mod wheel and "brightness" (the MPE timbre controller)
+    ccSources[1].store (ControllerSource::modWheel);
+    ccSources[timbreController].store (ControllerSource::timbre);
+}
+
+void MidiControllerMap::setSource (int controllerNumber, ControllerSource source)
+{
+    if (juce::isPositiveAndBelow (controllerNumber, numControllers) && source != ControllerSource::numSources)
+        ccSources[static_cast<size_t> (controllerNumber)].store (source, std::memory_order_relaxed);
+}
+
+ControllerSource MidiControllerMap::getSource (int controllerNumber) const
+{
+    if (! juce::isPositiveAndBelow (controllerNumber, numControllers))
+        return ControllerSource::none;
+
+    return ccSources[static_cast<size_t> (controllerNumber)].load (std::memory_order_relaxed);
+}
+
+void MidiControllerMap::setPitchBendRange (float semitones)
+{
+    pitchBendRange.store (juce::jlimit (0.0f, 24.0f, semitones), std::memory_order_relaxed);
+}
+
+void MidiControllerMap::setMpePitchBendRange (float semitones)
+{
+    mpePitchBendRange.store (juce::jlimit (0.0f, 96.0f, semitones), std::memory_order_relaxed);
+}
+
+juce::String MidiControllerMap::getSourceName (ControllerSource source)
+{
+    switch (source)
+    {
+        case ControllerSource::modWheel:   return "Mod Wheel";
+        case ControllerSource::aftertouch: return "Aftertouch";
+        case ControllerSource::timbre:     return "Timbre";
+        case ControllerSource::none:
+        case ControllerSource::numSources:
+        default:                           return "None";
+    }
+}
+
+bool MidiControllerMap::isHandledBySynthesiser (const juce::MidiMessage& message)
+{
+    if (message.isNoteOnOrOff())
+        return true;
+
+    if (message.isController())
+    {
+        // Pedals drive voice allocation inside juce::Synthesiser
+        if (message.isSustainPedalOn() || message.isSustainPedalOff()
+            || message.isSostenutoPedalOn() || message.isSostenutoPedalOff()
+            || message.isSoftPedalOn() || message.isSoftPedalOff())
+            return true;
+
+        return message.isAllNotesOff() || message.isAllSoundOff();
+    }
+
+    return false;
+}
+
+bool MidiControllerMap::toEvent (const juce::MidiMessage& message, int samplePosition, ControllerEvent& event) const
+{
+    // On an MPE member channel everything is per-note
+    const bool isMemberChannel = isMpeEnabled() && message.getChannel() > 1;
+
+    event.samplePosition = samplePosition;
+    event.channel = isMemberChannel ? static_cast<juce::int8> (message.getChannel()) : juce::int8 (0);
+    event.key = -1;
+
+    if (message.isPitchWheel())
+    {
+        // The only pow() of a bend - voices apply the ratio to their phase increment
+        const auto bend = (message.getPitchWheelValue() - 8192) / 8192.0;
+        const auto range = isMemberChannel ? getMpePitchBendRange() : getPitchBendRange();
+        event.type = isMemberChannel ? ControllerEvent::Type::notePitch : ControllerEvent::Type::pitchBend;
+        event.source = ControllerSource::none;
+        event.value = static_cast<float> (std::pow (2.0, bend * range / 12.0));
+        return true;
+    }
+
+    if (message.isResetAllControllers())
+    {
+        event.type = ControllerEvent::Type::resetAll;
+        event.source = ControllerSource::none;
+        event.value = 0.0f;
+        return true;
+    }
+
+    auto source = ControllerSource::none;
+    float value = 0.0f;
+
+    if (message.isController())
+    {
+        source = getSource (message.getControllerNumber());
+        value = static_cast<float> (message.getControllerValue()) / 127.0f;
+    }
+    else if (message.isChannelPressure())
+    {
+        source = ControllerSource::aftertouch;
+        value = static_cast<float> (message.getChannelPressureValue()) / 127.0f;
+    }
+
+    if (source == ControllerSource::none)
+        return false;
+
+    event.type = ControllerEvent::Type::source;
+    event.source = source;
+    event.value = value;
+    return true;
+}
+
+ControllerEvent MidiControllerMap::makeNoteExpressionEvent (NoteExpression expression, double value, int channel, int key, int samplePosition)
+{
+    ControllerEvent event;
+    event.samplePosition = samplePosition;
+    event.channel = static_cast<juce::int8> (juce::jlimit (0, 16, channel));
+    event.key = static_cast<juce::int8> (juce::jlimit (-1, 127, key));
+
+    switch (expression)
+    {
+        case NoteExpression::tuning:
+            event.type = ControllerEvent::Type::notePitch;
+            event.value = static_cast<float> (std::pow (2.0, value / 12.0));
+            return event;
+
+        case NoteExpression::pressure:
+            event.source = ControllerSource::aftertouch;
+            break;
+
+        case NoteExpression::brightness:
+        default:
+            event.source = ControllerSource::timbre;
+            break;
+    }
+
+    event.type = ControllerEvent::Type::source;
+    event.value = static_cast<float> (juce::jlimit (0.0, 1.0, value));
+    return event;
+}
+
+void MidiControllerMap::splitMidi (const juce::MidiBuffer& midi, juce::MidiBuffer& synthMidi, std::vector<ControllerEvent>& events) const
+{
+    synthMidi.clear();
+    events.clear();
+
+    for (const auto metadata : midi)
+    {
+        const auto message = metadata.getMessage();
+
+        if (isHandledBySynthesiser (message))
+        {
+            synthMidi.addEvent (metadata.data, metadata.numBytes, metadata.samplePosition);
+            continue;
+        }
+
+        ControllerEvent event;
+        if (! toEvent (message, metadata.samplePosition, event))
+            continue;
+
+        if (events.size() < events.capacity())
+            events.push_back (event);
+        else if (! events.empty())
+            events.back() = event;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Performance controls a MIDI controller can drive. Each one is a per-voice
+// modulation source - where it goes is up to the modulation matrix
+enum class ControllerSource : juce::uint8
+{
+    none,
+    modWheel,
+    aftertouch,  // channel pressure, MPE / CLAP per-note pressure
+    timbre,      // MPE CC74, CLAP brightness
+    numSources
+};
+
+// Timestamped controller change for the voices. Sample positions are relative
+// to the start of the current processBlock buffer.
+// Channel and key narrow an event down to single notes (MPE member channels,
+// CLAP note expressions) - those only reach the voices playing that note
+struct ControllerEvent
+{
+    enum class Type : juce::uint8
+    {
+        source,       // value is 0-1 for the controller source
+        pitchBend,    // value is the frequency ratio
+        notePitch,    // per-note pitch, value is the frequency ratio
+        resetAll,     // all controllers back to rest
+        noteModulation,  // CLAP per-note parameter modulation, value is an offset
+                         // in the destination's units
+        choke            // CLAP note choke: the note stops at once, pedal or not
+    };
+
+    int samplePosition = 0;
+    Type type = Type::source;
+    ControllerSource source = ControllerSource::none;
+    juce::uint8 destination = 0;  // ModDestination, for noteModulation
+    juce::int8 channel = 0;  // 1-16, 0 = every voice
+    juce::int8 key = -1;     // note number, -1 = any note on the channel
+    float value = 0.0f;
+};
+
+// Per-note expressions from CLAP hosts
+enum class NoteExpression
+{
+    tuning,     // semitones
+    pressure,   // 0-1, aftertouch source
+    brightness  // 0-1, timbre source
+};
+
+// MIDI controller routing
+//
+// Maps CC numbers to controller sources, and holds the pitch bend range. The map is edited on the message thread and read on the
+// audio thread (every entry is atomic).
+//
+// splitMidi() pulls controller data out of the incoming MIDI before it reaches
+// juce::Synthesiser, which splits its render at every event it is given - a
+// dense CC stream would otherwise shatter each block into tiny sub-blocks.
+// The voices apply the extracted events themselves, at their timestamps.
+class MidiControllerMap
+{
+public:
+    MidiControllerMap();
+
+    // === Message thread ===
+    void setSource (int controllerNumber, ControllerSource source);
+    ControllerSource getSource (int controllerNumber) const;
+
+    void setPitchBendRange (float semitones);
+    float getPitchBendRange() const { return pitchBendRange.load (std::memory_order_relaxed); }
+
+    // MPE lower zone: channel 1 is the master channel, pitch bend, pressure and
+    // CC74 (timbre) on channels 2-16 only affect the note on that channel
+    void setMpeEnabled (bool shouldBeEnabled) { mpeEnabled.store (shouldBeEnabled, std::memory_order_relaxed); }
+    bool isMpeEnabled() const { return mpeEnabled.load (std::memory_order_relaxed); }
+
+    void setMpePitchBendRange (float semitones);
+    float getMpePitchBendRange() const { return mpePitchBendRange.load (std::memory_order_relaxed); }
+
+    static juce::String getSourceName (ControllerSource source);
+
+    // === Audio thread ===
+    // Messages the synthesiser must see itself: notes, pedals and channel mode messages
+    static bool isHandledBySynthesiser (const juce::MidiMessage& message);
+
+    // Converts a controller message into a voice event, false if nothing is routed
+    bool toEvent (const juce::MidiMessage& message, int samplePosition, ControllerEvent& event) const;
+
+    // Per-note event for a CLAP note expression. Channel is 1-16 and key a note
+    // number, 0 / -1 address every channel / key
+    static ControllerEvent makeNoteExpressionEvent (NoteExpression expression, double value, int channel, int key, int samplePosition);
+
+    // Copies note data to synthMidi and converts controller data to events.
+    // Never allocates - once events is at capacity, later events replace the last one
+    void splitMidi (const juce::MidiBuffer& midi, juce::MidiBuffer& synthMidi, std::vector<ControllerEvent>& events) const;
+
+    static constexpr int numControllers = 128;
+    static constexpr int timbreController = 74;
+
+private:
+    std::array<std::atomic<ControllerSource>, numControllers> ccSources;
+    std::atomic<float> pitchBendRange { 2.0f };
+    std::atomic<bool> mpeEnabled { false };
+    std::atomic<float> mpePitchBendRange { 48.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiControllerMap)
+};
@@ -0,0 +1,75 @@
+#include "ModulationMatrix.h"
+
+juce::StringArray ModulationMatrix::getSourceNames()
+{
+    return { "None", "LFO 1", "LFO 2", "Filter Env", "Amp Env", "Velocity", "Key", "Mod Wheel", "Aftertouch", "Timbre", "Random" };
+}
+
+juce::StringArray ModulationMatrix::getDestinationNames()
+{
+    return { "None", "Cutoff", "Resonance", "Drive", "Detune", "Sub Mix", "Pitch", "Amp", "LFO Depth" };
+}
+
+float ModulationMatrix::getDestinationRange (ModDestination destination)
+{
+    switch (destination)
+    {
+        case ModDestination::cutoff: return 10000.0f;
+        case ModDestination::pitch:  return 12.0f;
+        case ModDestination::none:
+        case ModDestination::numDestinations: return 0.0f;
+        case ModDestination::resonance:
+        case ModDestination::drive:
+        case ModDestination::detune:
+        case ModDestination::subMix:
+        case ModDestination::amp:
+        case ModDestination::lfoDepth:
+        default: return 1.0f;
+    }
+}
+
+void ModulationMatrix::clearRoutes()
+{
+    numRoutes = 0;
+    routedDestinations = 0;
+    usedSources = 0;
+}
+
+void ModulationMatrix::addRoute (ModSource source, ModDestination destination, float gain)
+{
+    if (source == ModSource::none || source >= ModSource::numSources
+        || destination == ModDestination::none || destination >= ModDestination::numDestinations
+        || juce::exactlyEqual (gain, 0.0f) || numRoutes == maxRoutes)
+        return;
+
+    routes[static_cast<size_t> (numRoutes++)] = { source, destination, gain };
+    routedDestinations |= bit (destination);
+    usedSources |= bit (source);
+}
+
+void ModulationMatrix::setConstantSource (ModSource source, float value)
+{
+    jassert (isConstantSource (source));
+    constantSources[static_cast<size_t> (source)] = value;
+}
+
+void ModulationMatrix::process (const juce::AudioBuffer<float>& sources, juce::AudioBuffer<float>& destinations, int numSamples) const
+{
+    jassert (sources.getNumChannels() >= numSources && destinations.getNumChannels() >= numDestinations);
+    jassert (numSamples <= sources.getNumSamples() && numSamples <= destinations.getNumSamples());
+
+    for (int d = 1; d < numDestinations; ++d)
+        if (isRouted (static_cast<ModDestination> (d)))
+            juce::FloatVectorOperations::clear (destinations.getWritePointer (d), numSamples);
+
+    for (int r = 0; r < numRoutes; ++r)
+    {
+        const auto& route = routes[static_cast<size_t> (r)];
+        auto* destination = destinations.getWritePointer (static_cast<int> (route.destination));
+
+        if (isConstantSource (route.source))
+            juce::FloatVectorOperations::add (destination, constantSources[static_cast<size_t> (route.source)] * route.gain, numSamples);
+        else
+            juce::FloatVectorOperations::addWithMultiply (destination, sources.getReadPointer (static_cast<int> (route.source)), route.gain, numSamples);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <array>
+
+// Modulation sources. LFOs, envelopes and controllers are per-sample signals;
+// velocity, key and random are constant for the length of a note
+enum class ModSource
+{
+    none,
+    lfo1,            // -1 to 1, the main LFO
+    lfo2,            // -1 to 1, triangle
+    filterEnvelope,  // 0 to 1
+    ampEnvelope,     // 0 to 1
+    velocity,        // -1 to 1 around velocity 64
+    key,             // -1 to 1 around C4, +/- 64 semitones
+    modWheel,        // 0 to 1
+    aftertouch,      // 0 to 1, channel or per-note pressure
+    timbre,          // 0 to 1, CC74 / per-note brightness
+    random,          // -1 to 1, new value per note
+    numSources
+};
+
+enum class ModDestination
+{
+    none,
+    cutoff,     // +/- 10kHz
+    resonance,  // +/- 1
+    drive,      // +/- 1
+    detune,     // +/- 1 of the THICC range
+    subMix,     // +/- 1
+    pitch,      // +/- 12 semitones
+    amp,        // gain x (1 + mod)
+    lfoDepth,   // +/- 1 added to the LFO amount (LFO 1 -> cutoff)
+    numDestinations
+};
+
+struct ModulationRoute
+{
+    int source = 0;       // ModSource
+    int destination = 0;  // ModDestination
+    float amount = 0.0f;  // -1 to 1 of the destination range
+};
+
+// Per-voice modulation matrix
+//
+// Sources and destinations are dense buffers, one row each. Every route is a
+// single vector multiply-accumulate over the whole chunk, so adding routes
+// adds one SIMD pass instead of per-sample scalar work, and the render loop
+// reads exactly one value per destination however many routes feed it.
+class ModulationMatrix
+{
+public:
+    static constexpr int numUserRoutes = 4;
+    static constexpr int maxRoutes = numUserRoutes + 8;  // user routes + the voice's fixed routes
+
+    static constexpr int numSources = static_cast<int> (ModSource::numSources);
+    static constexpr int numDestinations = static_cast<int> (ModDestination::numDestinations);
+
+    static juce::StringArray getSourceNames();
+    static juce::StringArray getDestinationNames();
+
+    // Full-scale size of a destination, in its own units (Hz, semitones...)
+    static float getDestinationRange (ModDestination destination);
+
+    // Mod wheel -> LFO depth, aftertouch and timbre -> cutoff
+    static constexpr std::array<ModulationRoute, numUserRoutes> getDefaultRoutes()
+    {
+        return { { { static_cast<int> (ModSource::modWheel), static_cast<int> (ModDestination::lfoDepth), 1.0f },
+            { static_cast<int> (ModSource::aftertouch), static_cast<int> (ModDestination::cutoff), 0.5f },
+            { static_cast<int> (ModSource::timbre), static_cast<int> (ModDestination::cutoff), 0.5f },
+            {} } };
+    }
+
+    static bool isConstantSource (ModSource source)
+    {
+        return source == ModSource::velocity || source == ModSource::key || source == ModSource::random;
+    }
+
+    // === Route list (rebuilt by the voice when its settings change) ===
+    void clearRoutes();
+
+    // Gain is in destination units per unit of source. Routes with no source,
+    // no destination or zero gain are dropped
+    void addRoute (ModSource source, ModDestination destination, float gain);
+
+    bool isRouted (ModDestination destination) const { return (routedDestinations & bit (destination)) != 0; }
+    bool isUsed (ModSource source) const { return (usedSources & bit (source)) != 0; }
+
+    // Per-note values of the constant sources
+    void setConstantSource (ModSource source, float value);
+
+    // Clears the routed destination rows, then accumulates every route into
+    // them. Rows of unrouted destinations are left untouched
+    void process (const juce::AudioBuffer<float>& sources, juce::AudioBuffer<float>& destinations, int numSamples) const;
+
+private:
+    template <typename Enum>
+    static constexpr juce::uint32 bit (Enum value) { return 1u << static_cast<juce::uint32> (value); }
+
+    struct Route
+    {
+        ModSource source;
+        ModDestination destination;
+        float gain;
+    };
+
+    std::array<Route, maxRoutes> routes {};
+    int numRoutes = 0;
+
+    juce::uint32 routedDestinations = 0;
+    juce::uint32 usedSources = 0;
+
+    std::array<float, numSources> constantSources {};
+};
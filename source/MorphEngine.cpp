@@ -0,0 +1,276 @@
+#include "MorphEngine.h"
+
+MorphEngine::MorphEngine()
+{
+    tables.fill (staging);
+}
+
+void MorphEngine::setSlot (int slot, const VoiceParameters& params)
+{
+    jassert (slot >= 0 && slot < maxSlots);
+    const auto s = static_cast<size_t> (slot);
+
+    stageSlot (s, params);
+    staging.slotUsed[s] = true;
+    slotParameters[s] = params;
+    publish();
+    stateChanged();
+}
+
+void MorphEngine::stageSlot (size_t s, const VoiceParameters& params)
+{
+    for (size_t f = 0; f < staging.values.size(); ++f)
+    {
+        const auto value = params.*(floatFields[f].member);
+        staging.values[f][s] = floatFields[f].logDomain ? std::log (juce::jmax (0.0f, value) + logOffset) : value;
+    }
+
+    for (size_t f = 0; f < staging.steppedValues.size(); ++f)
+        staging.steppedValues[f][s] = params.*(steppedFields[f]);
+
+    for (size_t r = 0; r < params.modRoutes.size(); ++r)
+    {
+        staging.routeAmounts[r][s] = params.modRoutes[r].amount;
+        staging.routes[r][s] = params.modRoutes[r];
+    }
+}
+
+void MorphEngine::clearSlot (int slot)
+{
+    jassert (slot >= 0 && slot < maxSlots);
+    staging.slotUsed[static_cast<size_t> (slot)] = false;
+    slotParameters[static_cast<size_t> (slot)] = {};
+    publish();
+    stateChanged();
+}
+
+bool MorphEngine::isSlotUsed (int slot) const
+{
+    return slot >= 0 && slot < maxSlots && staging.slotUsed[static_cast<size_t> (slot)];
+}
+
+const VoiceParameters& MorphEngine::getSlot (int slot) const
+{
+    jassert (slot >= 0 && slot < maxSlots);
+    return slotParameters[static_cast<size_t> (slot)];
+}
+
+void MorphEngine::setEnabled (bool shouldBeEnabled)
+{
+    enabled.store (shouldBeEnabled);
+    stateChanged();
+}
+
+void MorphEngine::setPadY (float y)
+{
+    padY.store (juce::jlimit (0.0f, 1.0f, y));
+    stateChanged();
+}
+
+void MorphEngine::stateChanged()
+{
+    if (onStateChange != nullptr)
+        onStateChange();
+}
+
+void MorphEngine::writeState (juce::OutputStream& stream) const
+{
+    stream.writeInt (stateVersion);
+    stream.writeBool (enabled.load());
+    stream.writeFloat (padY.load());
+    stream.writeInt (maxSlots);
+
+    for (size_t s = 0; s < slotParameters.size(); ++s)
+    {
+        stream.writeBool (staging.slotUsed[s]);
+        if (! staging.slotUsed[s])
+            continue;
+
+        const auto& params = slotParameters[s];
+
+        stream.writeInt (numFloatFields);
+        for (const auto& field : floatFields)
+            stream.writeFloat (params.*(field.member));
+
+        stream.writeInt (numSteppedFields);
+        for (const auto field : steppedFields)
+            stream.writeInt (params.*field);
+
+        stream.writeInt (static_cast<int> (params.modRoutes.size()));
+        for (const auto& route : params.modRoutes)
+        {
+            stream.writeInt (route.source);
+            stream.writeInt (route.destination);
+            stream.writeFloat (route.amount);
+        }
+    }
+}
+
+bool MorphEngine::readState (juce::InputStream& stream)
+{
+    // version, enabled, pad Y, slot count
+    if (stream.getNumBytesRemaining() < 13 || stream.readInt() != stateVersion)
+        return false;
+
+    const bool shouldBeEnabled = stream.readBool();
+    const auto y = stream.readFloat();
+    const auto numSlots = stream.readInt();
+
+    if (numSlots < 0 || numSlots > maxSlots)
+        return false;
+
+    std::array<bool, maxSlots> used {};
+    std::array<VoiceParameters, maxSlots> params;
+
+    // A count followed by that many items, all of which must be there.
+    // Items past the ones this build knows are read and dropped, missing ones
+    // keep their defaults
+    const auto readCount = [&stream] (int bytesPerItem) {
+        if (stream.getNumBytesRemaining() < 4)
+            return -1;
+
+        const auto count = stream.readInt();
+        return count >= 0 && count * static_cast<juce::int64> (bytesPerItem) <= stream.getNumBytesRemaining() ? count : -1;
+    };
+
+    for (size_t s = 0; s < static_cast<size_t> (numSlots); ++s)
+    {
+        if (stream.getNumBytesRemaining() < 1)
+            return false;
+
+        used[s] = stream.readBool();
+        if (! used[s])
+            continue;
+
+        const auto numFloats = readCount (4);
+        if (numFloats < 0)
+            return false;
+
+        for (int f = 0; f < numFloats; ++f)
+        {
+            const auto value = stream.readFloat();
+            if (f < numFloatFields)
+                params[s].*(floatFields[static_cast<size_t> (f)].member) = value;
+        }
+
+        const auto numStepped = readCount (4);
+        if (numStepped < 0)
+            return false;
+
+        for (int f = 0; f < numStepped; ++f)
+        {
+            const auto value = stream.readInt();
+            if (f < numSteppedFields)
+                params[s].*(steppedFields[static_cast<size_t> (f)]) = value;
+        }
+
+        const auto numRoutes = readCount (12);
+        if (numRoutes < 0)
+            return false;
+
+        for (int r = 0; r < numRoutes; ++r)
+        {
+            ModulationRoute route;
+            route.source = juce::jlimit (0, static_cast<int> (ModSource::numSources) - 1, stream.readInt());
+            route.destination = juce::jlimit (0, static_cast<int> (ModDestination::numDestinations) - 1, stream.readInt());
+            route.amount = juce::jlimit (-1.0f, 1.0f, stream.readFloat());
+
+            if (r < ModulationMatrix::numUserRoutes)
+                params[s].modRoutes[static_cast<size_t> (r)] = route;
+        }
+    }
+
+    // Only a complete block replaces the slots, with one publish for all of them
+    for (size_t s = 0; s < slotParameters.size(); ++s)
+    {
+        staging.slotUsed[s] = used[s];
+        slotParameters[s] = used[s] ? params[s] : VoiceParameters {};
+
+        if (used[s])
+            stageSlot (s, params[s]);
+    }
+
+    publish();
+    enabled.store (shouldBeEnabled);
+    padY.store (juce::jlimit (0.0f, 1.0f, y));
+    stateChanged();
+    return true;
+}
+
+void MorphEngine::publish()
+{
+    staging.numSlotsUsed = static_cast<int> (std::count (staging.slotUsed.begin(), staging.slotUsed.end(), true));
+
+    tables[static_cast<size_t> (writeIndex)] = staging;
+    writeIndex = middleIndex.exchange (writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+}
+
+bool MorphEngine::isActive()
+{
+    if ((middleIndex.load (std::memory_order_acquire) & newDataFlag) != 0)
+        readIndex = middleIndex.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+
+    return enabled.load (std::memory_order_relaxed) && tables[static_cast<size_t> (readIndex)].numSlotsUsed >= 2;
+}
+
+VoiceParameters MorphEngine::process (float position)
+{
+    const auto& table = tables[static_cast<size_t> (readIndex)];
+    const auto x = juce::jlimit (0.0f, 1.0f, position);
+
+    // Bilinear over the loaded slots: each row (A-B on top, C-D at the bottom)
+    // blends along x over the slots it has loaded, then the loaded rows blend
+    // along y. A row with one slot loaded holds it across x, and a pad with
+    // one row loaded ignores y, so the weights never all vanish and the blend
+    // stays continuous wherever the slots sit (e.g. only A and C loaded)
+    const auto y = juce::jlimit (0.0f, 1.0f, padY.load (std::memory_order_relaxed));
+    std::array<float, maxSlots> weights {};
+    std::array<float, 2> rowWeights {};
+
+    for (size_t row = 0; row < rowWeights.size(); ++row)
+    {
+        const auto left = row * 2;
+        const auto right = left + 1;
+        const bool hasLeft = table.slotUsed[left];
+        const bool hasRight = table.slotUsed[right];
+
+        weights[left] = hasLeft ? (hasRight ? 1.0f - x : 1.0f) : 0.0f;
+        weights[right] = hasRight ? (hasLeft ? x : 1.0f) : 0.0f;
+        rowWeights[row] = (hasLeft || hasRight) ? 1.0f : 0.0f;
+    }
+
+    if (rowWeights[0] > 0.0f && rowWeights[1] > 0.0f)
+        rowWeights = { 1.0f - y, y };
+
+    size_t dominantSlot = 0;
+
+    for (size_t s = 0; s < weights.size(); ++s)
+    {
+        weights[s] *= rowWeights[s / 2];
+
+        if (weights[s] > weights[dominantSlot])
+            dominantSlot = s;
+    }
+
+    VoiceParameters result;
+
+    // Dense weighted sum over each SoA row
+    for (size_t f = 0; f < table.values.size(); ++f)
+    {
+        const auto& row = table.values[f];
+        const auto blended = row[0] * weights[0] + row[1] * weights[1] + row[2] * weights[2] + row[3] * weights[3];
+        result.*(floatFields[f].member) = floatFields[f].logDomain ? std::exp (blended) - logOffset : blended;
+    }
+
+    for (size_t f = 0; f < table.steppedValues.size(); ++f)
+        result.*(steppedFields[f]) = table.steppedValues[f][dominantSlot];
+
+    for (size_t r = 0; r < table.routes.size(); ++r)
+    {
+        const auto& row = table.routeAmounts[r];
+        result.modRoutes[r] = table.routes[r][dominantSlot];
+        result.modRoutes[r].amount = row[0] * weights[0] + row[1] * weights[1] + row[2] * weights[2] + row[3] * weights[3];
+    }
+
+    return result;
+}
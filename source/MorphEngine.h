@@ -0,0 +1,138 @@
+#pragma once
+
+#include "VoiceParameters.h"
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <functional>
+
+// Realtime preset morphing
+//
+// Up to four presets are stored as dense structure-of-arrays parameter vectors
+// (one row per parameter, one column per slot). The audio thread blends them
+// once per block from a single host-automatable morph position (A <-> B) and an
+// editor-only Y position (top A/B <-> bottom C/D) for XY performance:
+//  - times, rates and cutoff blend in the log domain
+//  - unison voices, sub octave and the matrix route sources and destinations
+//    are stepped (the dominant slot wins)
+//  - everything else blends linearly
+//
+// Slots are edited on the message thread and handed over through a lock-free
+// triple buffer, so the audio thread never waits and never sees a partial table.
+// The slots, the pad Y and the enabled flag go into the plugin state as one
+// versioned block (writeState / readState)
+class MorphEngine
+{
+public:
+    static constexpr int maxSlots = 4;
+
+    MorphEngine();
+
+    // === Message thread ===
+    void setSlot (int slot, const VoiceParameters& params);
+    void clearSlot (int slot);
+    bool isSlotUsed (int slot) const;
+    const VoiceParameters& getSlot (int slot) const;
+
+    void setEnabled (bool shouldBeEnabled);
+    bool isEnabled() const { return enabled.load(); }
+
+    void setPadY (float y);
+    float getPadY() const { return padY.load(); }
+
+    // Called after every change above, so the owner can mark its state dirty
+    std::function<void()> onStateChange;
+
+    // Plugin state. Fields are written with their counts, so a block from a
+    // build with more (or fewer) parameters still reads. readState returns
+    // false and leaves the engine untouched if the block isn't one it can read
+    static constexpr int stateVersion = 1;
+    void writeState (juce::OutputStream& stream) const;
+    bool readState (juce::InputStream& stream);
+
+    // === Audio thread ===
+    // True when enabled with at least two slots to morph between
+    bool isActive();
+
+    // Blends the slots for the given morph position (0 = A, 1 = B)
+    VoiceParameters process (float position);
+
+private:
+    struct FloatField
+    {
+        float VoiceParameters::* member;
+        bool logDomain;
+    };
+
+    static constexpr FloatField floatFields[] = {
+        { &VoiceParameters::subMix, false },
+        { &VoiceParameters::filterCutoff, true },
+        { &VoiceParameters::filterResonance, false },
+        { &VoiceParameters::filterKeyTrack, false },
+        { &VoiceParameters::filterEnvAttack, true },
+        { &VoiceParameters::filterEnvDecay, true },
+        { &VoiceParameters::filterEnvSustain, false },
+        { &VoiceParameters::filterEnvRelease, true },
+        { &VoiceParameters::filterEnvAmount, false },
+        { &VoiceParameters::ampAttack, true },
+        { &VoiceParameters::ampDecay, true },
+        { &VoiceParameters::ampSustain, false },
+        { &VoiceParameters::ampRelease, true },
+        { &VoiceParameters::lfoRate, true },
+        { &VoiceParameters::lfoAmount, false },
+        { &VoiceParameters::lfo2Rate, true },
+        { &VoiceParameters::velocityToFilter, false },
+        { &VoiceParameters::velocityToAmp, false },
+        { &VoiceParameters::unisonDetune, false },
+        { &VoiceParameters::driveAmount, false },
+        { &VoiceParameters::glideTime, true },
+    };
+
+    static constexpr int numFloatFields = static_cast<int> (std::size (floatFields));
+
+    static constexpr int VoiceParameters::* steppedFields[] = {
+        &VoiceParameters::unisonVoices,
+        &VoiceParameters::subOctave,
+    };
+
+    static constexpr int numSteppedFields = static_cast<int> (std::size (steppedFields));
+
+    // Keeps log() finite for parameters that can be zero (glide, LFO rate)
+    static constexpr float logOffset = 0.001f;
+
+    struct Table
+    {
+        std::array<bool, maxSlots> slotUsed {};
+        int numSlotsUsed = 0;
+
+        // SoA: values[field][slot], log-domain fields stored pre-transformed
+        std::array<std::array<float, maxSlots>, numFloatFields> values {};
+        std::array<std::array<int, maxSlots>, numSteppedFields> steppedValues {};
+
+        // Matrix routes: amounts blend linearly, the routing itself is stepped
+        std::array<std::array<float, maxSlots>, ModulationMatrix::numUserRoutes> routeAmounts {};
+        std::array<std::array<ModulationRoute, maxSlots>, ModulationMatrix::numUserRoutes> routes {};
+    };
+
+    void stageSlot (size_t slot, const VoiceParameters& params);
+    void publish();
+    void stateChanged();
+
+    // Message-thread copy that slots are edited in, and the slots as they were
+    // set (the table holds the log-domain fields transformed)
+    Table staging;
+    std::array<VoiceParameters, maxSlots> slotParameters;
+
+    // Triple buffer: writer and reader each own one table, the third is in flight
+    std::array<Table, 3> tables;
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middleIndex { 2 };
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    std::atomic<bool> enabled { false };
+    std::atomic<float> padY { 0.0f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MorphEngine)
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+// XY pad for preset morphing - corners are slots A (top-left), B (top-right),
+// C (bottom-left) and D (bottom-right). Dragging reports the position, clicking
+// a corner label lets the owner assign a preset to that slot
+class MorphPadComponent : public juce::Component,
+                          public juce::SettableTooltipClient
+{
+public:
+    MorphPadComponent()
+    {
+        setSize (170, 170);
+    }
+
+    std::function<void()> onDragStart;
+    std::function<void (float x, float y)> onPositionChanged;
+    std::function<void()> onDragEnd;
+    std::function<void (int corner)> onCornerClicked;
+
+    void setPosition (float x, float y)
+    {
+        if (dragging || (juce::approximatelyEqual (x, posX) && juce::approximatelyEqual (y, posY)))
+            return;
+
+        posX = juce::jlimit (0.0f, 1.0f, x);
+        posY = juce::jlimit (0.0f, 1.0f, y);
+        repaint();
+    }
+
+    void setCornerName (int corner, const juce::String& name)
+    {
+        if (corner >= 0 && corner < 4 && cornerNames[(size_t) corner] != name)
+        {
+            cornerNames[(size_t) corner] = name;
+            repaint();
+        }
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        auto pad = getPadBounds();
+
+        // Drop shadow + white pad, matching the street art look
+        g.setColour (juce::Colours::black.withAlpha (0.3f));
+        g.fillRoundedRectangle (pad.translated (3.0f, 3.0f), 8.0f);
+        g.setColour (juce::Colour (0xffffffff));
+        g.fillRoundedRectangle (pad, 8.0f);
+        g.setColour (juce::Colour (0xff000000));
+        g.drawRoundedRectangle (pad, 8.0f, 3.0f);
+
+        // Corner labels
+        g.setFont (juce::Font (10.0f, juce::Font::bold));
+        static constexpr const char* slotLetters[] = { "A", "B", "C", "D" };
+
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            auto area = getCornerBounds (corner);
+            const auto& name = cornerNames[(size_t) corner];
+            g.setColour (name.isEmpty() ? juce::Colour (0xff888888) : juce::Colour (0xffFF3333));
+            g.drawFittedText (juce::String (slotLetters[corner]) + (name.isEmpty() ? " +" : ": " + name),
+                area.toNearestInt(), corner % 2 == 0 ? juce::Justification::centredLeft : juce::Justification::centredRight, 1);
+        }
+
+        // Puck
+        auto puck = juce::Point<float> (pad.getX() + posX * pad.getWidth(), pad.getY() + posY * pad.getHeight());
+        g.setColour (juce::Colour (0xffFF6600));
+        g.fillEllipse (puck.x - 8.0f, puck.y - 8.0f, 16.0f, 16.0f);
+        g.setColour (juce::Colour (0xff000000));
+        g.drawEllipse (puck.x - 8.0f, puck.y - 8.0f, 16.0f, 16.0f, 2.0f);
+    }
+
+    void mouseDown (const juce::MouseEvent& e) override
+    {
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            if (getCornerBounds (corner).contains (e.position))
+            {
+                if (onCornerClicked)
+                    onCornerClicked (corner);
+                return;
+            }
+        }
+
+        dragging = true;
+        if (onDragStart)
+            onDragStart();
+        mouseDrag (e);
+    }
+
+    void mouseDrag (const juce::MouseEvent& e) override
+    {
+        if (! dragging)
+            return;
+
+        auto pad = getPadBounds();
+        posX = juce::jlimit (0.0f, 1.0f, (e.position.x - pad.getX()) / pad.getWidth());
+        posY = juce::jlimit (0.0f, 1.0f, (e.position.y - pad.getY()) / pad.getHeight());
+        repaint();
+
+        if (onPositionChanged)
+            onPositionChanged (posX, posY);
+    }
+
+    void mouseUp (const juce::MouseEvent&) override
+    {
+        if (! dragging)
+            return;
+
+        dragging = false;
+        if (onDragEnd)
+            onDragEnd();
+    }
+
+private:
+    juce::Rectangle<float> getPadBounds() const
+    {
+        return getLocalBounds().toFloat().reduced (4.0f);
+    }
+
+    juce::Rectangle<float> getCornerBounds (int corner) const
+    {
+        auto pad = getPadBounds().reduced (6.0f);
+        auto row = corner < 2 ? pad.removeFromTop (16.0f) : pad.removeFromBottom (16.0f);
+        return corner % 2 == 0 ? row.removeFromLeft (row.getWidth() * 0.5f) : row.removeFromRight (row.getWidth() * 0.5f);
+    }
+
+    float posX = 0.0f;
+    float posY = 0.0f;
+    bool dragging = false;
+    std::array<juce::String, 4> cornerNames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MorphPadComponent)
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <clap-juce-extensions/clap-juce-extensions.h>
+#include "ModulationMatrix.h"
+
+// Float parameter a CLAP host may modulate per note
+//
+// The CLAP wrapper advertises it as modulatable per note ID, key and channel,
+// and hands every polyphonic CLAP_EVENT_PARAM_MOD for it to
+// applyPolyphonicModulation on the audio thread. The parameter value itself
+// never moves: the amount goes to the target as an offset in the matching
+// modulation matrix destination's units, for the voices playing that note.
+class NoteModulatedParameter : public juce::AudioParameterFloat,
+                               public clap_juce_extensions::clap_juce_parameter_capabilities
+{
+public:
+    // === Audio thread ===
+    struct Target
+    {
+        virtual ~Target() = default;
+
+        // CLAP addressing: -1 is a wildcard for the note ID, channel (0-15) and key
+        virtual void applyNoteModulation (ModDestination destination, float offset, int32_t noteId, int channel, int key) = 0;
+    };
+
+    NoteModulatedParameter (const juce::ParameterID& parameterId, const juce::String& parameterName,
+                            juce::NormalisableRange<float> normalisableRange, float defaultValue,
+                            const juce::String& label, ModDestination modDestination)
+        : juce::AudioParameterFloat (parameterId, parameterName, normalisableRange, defaultValue,
+                                     juce::AudioParameterFloatAttributes().withLabel (label)),
+          destination (modDestination)
+    {
+    }
+
+    // Message thread, before processing starts
+    void setTarget (Target* newTarget) { target = newTarget; }
+    ModDestination getDestination() const { return destination; }
+
+    bool supportsPolyphonicModulation() override { return true; }
+
+    void applyPolyphonicModulation (int32_t noteId, int16_t portIndex, int16_t channel, int16_t key, double value) override
+    {
+        juce::ignoreUnused (portIndex);
+
+        if (target != nullptr)
+            target->applyNoteModulation (destination, toOffset (value), noteId, channel, key);
+    }
+
+    // The host modulates the normalised value; the offset is what that amount
+    // means in the parameter's units around its current value (cutoff is skewed)
+    float toOffset (double amount) const
+    {
+        const auto& range = getNormalisableRange();
+        const auto base = get();
+        const auto modulated = juce::jlimit (0.0, 1.0, static_cast<double> (range.convertTo0to1 (base)) + amount);
+        return range.convertFrom0to1 (static_cast<float> (modulated)) - base;
+    }
+
+private:
+    const ModDestination destination;
+    Target* target = nullptr;
+};
@@ -0,0 +1,438 @@
+#include "PartitionedConvolution.h"
+
+//==============================================================================
+void PartitionedConvolution::Stage::build (const juce::AudioBuffer<float>& impulse, int startTap, int endTap, int newPartitionSize, int numChannels)
+{
+    partitionSize = newPartitionSize;
+    numPartitions = juce::jmax (0, (endTap - startTap + partitionSize - 1) / partitionSize);
+    spectrumSize = 2 * (partitionSize + 1);
+
+    if (numPartitions == 0)
+        return;
+
+    const auto fftSize = 2 * partitionSize;
+    fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (fftSize)));
+    transform.assign (static_cast<size_t> (2 * fftSize), 0.0f);
+    accumulator.assign (static_cast<size_t> (2 * fftSize), 0.0f);
+
+    // Each partition is zero padded to the FFT size, so overlap-save keeps the
+    // second half of every transform free of wrap-around
+    spectra.resize (static_cast<size_t> (impulse.getNumChannels()));
+    for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+    {
+        auto& channelSpectra = spectra[static_cast<size_t> (channel)];
+        channelSpectra.assign (static_cast<size_t> (numPartitions * spectrumSize), 0.0f);
+
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            const auto first = startTap + partition * partitionSize;
+            const auto numTaps = juce::jmin (partitionSize, endTap - first);
+
+            std::fill (transform.begin(), transform.end(), 0.0f);
+            std::copy_n (impulse.getReadPointer (channel, first), numTaps, transform.begin());
+            fft->performRealOnlyForwardTransform (transform.data(), true);
+            std::copy_n (transform.begin(), spectrumSize, channelSpectra.begin() + partition * spectrumSize);
+        }
+    }
+
+    channels.resize (static_cast<size_t> (numChannels));
+    for (auto& state : channels)
+    {
+        state.previousInput.assign (static_cast<size_t> (partitionSize), 0.0f);
+        state.delayLine.assign (static_cast<size_t> (numPartitions * spectrumSize), 0.0f);
+        state.position = 0;
+    }
+}
+
+void PartitionedConvolution::Stage::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill (state.previousInput.begin(), state.previousInput.end(), 0.0f);
+        std::fill (state.delayLine.begin(), state.delayLine.end(), 0.0f);
+        state.position = 0;
+    }
+}
+
+void PartitionedConvolution::Stage::processBlock (int channel, const float* input, float* output)
+{
+    auto& state = channels[static_cast<size_t> (channel)];
+    const auto& channelSpectra = spectra[static_cast<size_t> (juce::jmin (channel, static_cast<int> (spectra.size()) - 1))];
+
+    // Overlap-save: transform the previous block followed by this one
+    std::fill (transform.begin(), transform.end(), 0.0f);
+    std::copy (state.previousInput.begin(), state.previousInput.end(), transform.begin());
+    std::copy_n (input, partitionSize, transform.begin() + partitionSize);
+    std::copy_n (input, partitionSize, state.previousInput.begin());
+    fft->performRealOnlyForwardTransform (transform.data(), true);
+
+    // The newest spectrum goes in front of the older ones
+    state.position = (state.position + numPartitions - 1) % numPartitions;
+    std::copy_n (transform.begin(), spectrumSize, state.delayLine.begin() + state.position * spectrumSize);
+
+    // Sum of (input spectrum p blocks ago) x (IR partition p)
+    std::fill (accumulator.begin(), accumulator.end(), 0.0f);
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto* x = state.delayLine.data() + ((state.position + partition) % numPartitions) * spectrumSize;
+        const auto* h = channelSpectra.data() + partition * spectrumSize;
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            accumulator[static_cast<size_t> (i)] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            accumulator[static_cast<size_t> (i + 1)] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+
+    // Not every FFT engine fills in the negative frequencies for the inverse
+    const auto fftSize = 2 * partitionSize;
+    for (int bin = partitionSize + 1; bin < fftSize; ++bin)
+    {
+        accumulator[static_cast<size_t> (2 * bin)] = accumulator[static_cast<size_t> (2 * (fftSize - bin))];
+        accumulator[static_cast<size_t> (2 * bin + 1)] = -accumulator[static_cast<size_t> (2 * (fftSize - bin) + 1)];
+    }
+
+    fft->performRealOnlyInverseTransform (accumulator.data());
+    std::copy_n (accumulator.begin() + partitionSize, partitionSize, output);
+}
+
+//==============================================================================
+PartitionedConvolution::PartitionedConvolution()
+    : juce::Thread ("Thicc Bass convolution")
+{
+    activeKernel = createKernel().release();
+}
+
+PartitionedConvolution::~PartitionedConvolution()
+{
+    stopThread (4000);
+
+    delete activeKernel;
+    delete pendingKernel.exchange (nullptr);
+    delete retiredKernel.exchange (nullptr);
+}
+
+void PartitionedConvolution::prepare (double newSampleRate, int newNumChannels)
+{
+    // The audio thread is stopped, so the kernel can be replaced directly
+    waitForTailJob();
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    auto allocate = [this] (std::vector<std::vector<float>>& buffers, int size) {
+        buffers.assign (static_cast<size_t> (numChannels), std::vector<float> (static_cast<size_t> (size), 0.0f));
+    };
+
+    allocate (headHistory, 2 * headSize);
+    allocate (bodyInput, headSize);
+    allocate (bodyOutput, headSize);
+    allocate (tailInput, tailPartitionSize);
+    allocate (tailOutput, tailPartitionSize);
+    allocate (tailJobInput, tailPartitionSize);
+    allocate (tailJobResult, tailPartitionSize);
+
+    mixSmoother.reset (sampleRate, 0.02);
+
+    delete pendingKernel.exchange (nullptr);
+    delete retiredKernel.exchange (nullptr);
+    delete activeKernel;
+    activeKernel = createKernel().release();
+
+    if (! activeKernel->tail.isEmpty())
+        startThread (juce::Thread::Priority::high);
+
+    clearState();
+}
+
+void PartitionedConvolution::loadImpulseResponse (const juce::AudioBuffer<float>& impulse, double impulseSampleRate)
+{
+    sourceImpulse.makeCopyOf (impulse);
+    sourceSampleRate = impulseSampleRate;
+    publish (createKernel());
+}
+
+bool PartitionedConvolution::loadImpulseResponse (const juce::File& file)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    const std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+        return false;
+
+    const auto length = static_cast<int> (juce::jmin (reader->lengthInSamples,
+                                                      static_cast<juce::int64> (maxImpulseSeconds * reader->sampleRate)));
+    juce::AudioBuffer<float> impulse (static_cast<int> (juce::jmin (reader->numChannels, 2u)), length);
+    if (! reader->read (&impulse, 0, length, 0, true, true))
+        return false;
+
+    impulseName = file.getFileNameWithoutExtension();
+    loadImpulseResponse (impulse, reader->sampleRate);
+    return true;
+}
+
+double PartitionedConvolution::getImpulseSeconds() const
+{
+    return juce::jmin (maxImpulseSeconds, sourceImpulse.getNumSamples() / sourceSampleRate);
+}
+
+void PartitionedConvolution::clearImpulseResponse()
+{
+    sourceImpulse.setSize (0, 0);
+    impulseName.clear();
+    publish (createKernel());
+}
+
+std::unique_ptr<PartitionedConvolution::Kernel> PartitionedConvolution::createKernel() const
+{
+    auto kernel = std::make_unique<Kernel>();
+    if (sourceImpulse.getNumSamples() == 0 || sourceImpulse.getNumChannels() == 0)
+        return kernel;
+
+    // Resample to the processing rate
+    const auto ratio = sourceSampleRate / sampleRate;
+    const auto maxLength = static_cast<int> (maxImpulseSeconds * sampleRate);
+    const auto length = juce::jlimit (1, maxLength, static_cast<int> (std::ceil (sourceImpulse.getNumSamples() / ratio)));
+    juce::AudioBuffer<float> impulse (sourceImpulse.getNumChannels(), length);
+
+    if (juce::exactlyEqual (ratio, 1.0))
+    {
+        for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+            impulse.copyFrom (channel, 0, sourceImpulse, channel, 0, length);
+    }
+    else
+    {
+        // The interpolator reads ahead, so give it silence past the end
+        juce::AudioBuffer<float> padded (1, sourceImpulse.getNumSamples() + 64);
+        for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+        {
+            padded.clear();
+            padded.copyFrom (0, 0, sourceImpulse, channel, 0, sourceImpulse.getNumSamples());
+
+            juce::WindowedSincInterpolator interpolator;
+            interpolator.process (ratio, padded.getReadPointer (0), impulse.getWritePointer (channel), length);
+        }
+    }
+
+    // Unit energy on the loudest channel keeps IRs of any length at a similar level
+    float energy = 0.0f;
+    for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+    {
+        const auto* samples = impulse.getReadPointer (channel);
+        float channelEnergy = 0.0f;
+        for (int i = 0; i < length; ++i)
+            channelEnergy += samples[i] * samples[i];
+        energy = juce::jmax (energy, channelEnergy);
+    }
+
+    if (energy > 0.0f)
+        impulse.applyGain (1.0f / std::sqrt (energy));
+
+    kernel->length = length;
+
+    kernel->headTaps.resize (static_cast<size_t> (impulse.getNumChannels()));
+    for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+    {
+        auto& taps = kernel->headTaps[static_cast<size_t> (channel)];
+        taps.assign (static_cast<size_t> (headSize), 0.0f);
+        for (int tap = 0; tap < juce::jmin (headSize, length); ++tap)
+            taps[static_cast<size_t> (headSize - 1 - tap)] = impulse.getSample (channel, tap);
+    }
+
+    kernel->body.build (impulse, headSize, juce::jmin (length, tailStart), headSize, numChannels);
+    kernel->tail.build (impulse, tailStart, length, tailPartitionSize, numChannels);
+    return kernel;
+}
+
+void PartitionedConvolution::publish (std::unique_ptr<Kernel> kernel)
+{
+    if (! kernel->tail.isEmpty() && ! isThreadRunning())
+        startThread (juce::Thread::Priority::high);
+
+    // Free the kernel the audio thread swapped out last time, then queue the
+    // new one (replacing a pending one the audio thread never picked up)
+    delete retiredKernel.exchange (nullptr, std::memory_order_acq_rel);
+    delete pendingKernel.exchange (kernel.release(), std::memory_order_acq_rel);
+}
+
+//==============================================================================
+void PartitionedConvolution::takePendingKernel()
+{
+    // Hold the swap until the message thread has freed the last retired kernel
+    if (retiredKernel.load (std::memory_order_acquire) != nullptr)
+        return;
+
+    if (auto* next = pendingKernel.exchange (nullptr, std::memory_order_acq_rel))
+    {
+        waitForTailJob();
+        retiredKernel.store (activeKernel, std::memory_order_release);
+        activeKernel = next;
+        clearState();
+    }
+}
+
+void PartitionedConvolution::reset()
+{
+    waitForTailJob();
+    clearState();
+}
+
+void PartitionedConvolution::clearState()
+{
+    for (auto* buffers : { &headHistory, &bodyInput, &bodyOutput, &tailInput, &tailOutput, &tailJobResult })
+        for (auto& buffer : *buffers)
+            std::fill (buffer.begin(), buffer.end(), 0.0f);
+
+    headPosition = 0;
+    bodyFill = 0;
+    tailFill = 0;
+    ringingSamples = 0;
+    snapMix = true;
+
+    activeKernel->body.reset();
+    activeKernel->tail.reset();
+}
+
+template <typename SampleType>
+void PartitionedConvolution::process (juce::AudioBuffer<SampleType>& buffer, float mix)
+{
+    takePendingKernel();
+
+    if (activeKernel->length == 0)
+        return;
+
+    // Only ramp mix changes - a fresh start begins at the set mix
+    if (snapMix)
+        mixSmoother.setCurrentAndTargetValue (juce::jlimit (0.0f, 1.0f, mix));
+    else
+        mixSmoother.setTargetValue (juce::jlimit (0.0f, 1.0f, mix));
+    snapMix = false;
+
+    const auto channelsToProcess = juce::jmin (buffer.getNumChannels(), numChannels);
+    const auto numSamples = buffer.getNumSamples();
+
+    // The output keeps ringing for the IR length after the last input
+    if (buffer.getMagnitude (0, numSamples) > SampleType (0))
+        ringingSamples = activeKernel->length;
+    else
+        ringingSamples = juce::jmax (0, ringingSamples - numSamples);
+
+    for (int sample = 0; sample < numSamples;)
+    {
+        // Up to the next body or tail block boundary
+        const auto numToProcess = juce::jmin (numSamples - sample, headSize - bodyFill, tailPartitionSize - tailFill);
+
+        for (int i = 0; i < numToProcess; ++i)
+            mixRamp[static_cast<size_t> (i)] = mixSmoother.getNextValue();
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+        {
+            const auto c = static_cast<size_t> (channel);
+            auto* data = buffer.getWritePointer (channel, sample);
+            auto* bodyIn = bodyInput[c].data() + bodyFill;
+            auto* tailIn = tailInput[c].data() + tailFill;
+
+            const auto* taps = activeKernel->getHeadTaps (channel).data();
+            auto* history = headHistory[c].data();
+            const auto* body = bodyOutput[c].data() + bodyFill;
+            const auto* tail = tailOutput[c].data() + tailFill;
+            auto position = headPosition;
+
+            for (int i = 0; i < numToProcess; ++i)
+            {
+                const auto dry = data[i];
+                const auto input = static_cast<float> (dry);
+                bodyIn[i] = input;
+                tailIn[i] = input;
+
+                // Mirrored history: the last headSize inputs are always contiguous
+                history[position] = input;
+                history[position + headSize] = input;
+                position = (position + 1) % headSize;
+
+                const auto* window = history + position;
+                float wet = body[i] + tail[i];
+                for (int tap = 0; tap < headSize; ++tap)
+                    wet += taps[tap] * window[tap];
+
+                data[i] = dry + static_cast<SampleType> (mixRamp[static_cast<size_t> (i)]) * (static_cast<SampleType> (wet) - dry);
+            }
+        }
+
+        headPosition = (headPosition + numToProcess) % headSize;
+        bodyFill += numToProcess;
+        tailFill += numToProcess;
+        sample += numToProcess;
+
+        if (bodyFill == headSize)
+        {
+            if (! activeKernel->body.isEmpty())
+                for (int channel = 0; channel < channelsToProcess; ++channel)
+                    activeKernel->body.processBlock (channel, bodyInput[static_cast<size_t> (channel)].data(), bodyOutput[static_cast<size_t> (channel)].data());
+
+            bodyFill = 0;
+        }
+
+        if (tailFill == tailPartitionSize)
+        {
+            exchangeTailBlock();
+            tailFill = 0;
+        }
+    }
+}
+
+void PartitionedConvolution::exchangeTailBlock()
+{
+    if (activeKernel->tail.isEmpty())
+        return;
+
+    // The block handed over one partition ago plays next, this one is convolved meanwhile
+    waitForTailJob();
+    std::swap (tailOutput, tailJobResult);
+    std::swap (tailInput, tailJobInput);
+
+    tailJobKernel = activeKernel;
+    tailJobChannels = juce::jmin (numChannels, static_cast<int> (tailJobInput.size()));
+    tailJobInFlight = true;
+
+    if (isThreadRunning())
+    {
+        notify();
+    }
+    else
+    {
+        // No worker (it failed to start) - convolve inline rather than drop the tail
+        for (int channel = 0; channel < tailJobChannels; ++channel)
+            tailJobKernel->tail.processBlock (channel, tailJobInput[static_cast<size_t> (channel)].data(), tailJobResult[static_cast<size_t> (channel)].data());
+
+        tailJobInFlight = false;
+    }
+}
+
+void PartitionedConvolution::waitForTailJob()
+{
+    if (tailJobInFlight)
+    {
+        tailJobDone.wait();
+        tailJobInFlight = false;
+    }
+}
+
+void PartitionedConvolution::run()
+{
+    while (! threadShouldExit())
+    {
+        if (! wait (-1) || threadShouldExit())
+            continue;
+
+        if (tailJobKernel != nullptr)
+            for (int channel = 0; channel < tailJobChannels; ++channel)
+                tailJobKernel->tail.processBlock (channel, tailJobInput[static_cast<size_t> (channel)].data(), tailJobResult[static_cast<size_t> (channel)].data());
+
+        tailJobDone.signal();
+    }
+}
+
+template void PartitionedConvolution::process<float> (juce::AudioBuffer<float>&, float);
+template void PartitionedConvolution::process<double> (juce::AudioBuffer<double>&, float);
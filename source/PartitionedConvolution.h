@@ -0,0 +1,158 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Zero-latency convolution for cabinet / DI body impulse responses
+//
+// The IR is split into three segments, each convolved the cheapest way for
+// where it sits:
+//  - head (the first headSize taps): direct FIR on the audio thread, so the
+//    output has no latency at all
+//  - body (up to tailStart): uniformly partitioned FFT convolution with
+//    headSize partitions on the audio thread. A finished input block only
+//    reaches the body taps headSize samples later - just as the next block starts
+//  - tail (the rest): tailPartitionSize partitions convolved on a background
+//    thread. The tail starts two partitions in, so the worker has a whole
+//    partition (~21 ms at 48 kHz) to deliver a block before it is heard. The
+//    audio thread only ever waits if the worker is later than that
+//
+// Both FFT stages use overlap-save with a frequency-domain delay line, so a
+// block costs one forward and one inverse transform however long the IR is.
+//
+// IRs are read, resampled and transformed on the calling (message) thread and
+// handed to the audio thread lock-free. Processing never allocates.
+class PartitionedConvolution : private juce::Thread
+{
+public:
+    static constexpr int headSize = 64;
+    static constexpr int tailPartitionSize = 1024;
+    static constexpr int tailStart = 2 * tailPartitionSize;
+    static constexpr double maxImpulseSeconds = 4.0;
+
+    PartitionedConvolution();
+    ~PartitionedConvolution() override;
+
+    // === Message thread ===
+    // Rebuilds the loaded IR for the new rate and channel count
+    void prepare (double sampleRate, int numChannels);
+
+    // Resamples the IR to the prepared rate, normalises it to unit energy and
+    // queues it for the audio thread. A mono IR feeds every channel
+    void loadImpulseResponse (const juce::AudioBuffer<float>& impulse, double impulseSampleRate);
+    bool loadImpulseResponse (const juce::File& file);
+    void clearImpulseResponse();
+
+    bool hasImpulseResponse() const { return sourceImpulse.getNumSamples() > 0; }
+    juce::String getImpulseName() const { return impulseName; }
+    double getImpulseSeconds() const;
+
+    // === Audio thread ===
+    void reset();
+
+    // True while the output still carries the response to earlier input
+    bool isRinging() const { return ringingSamples > 0; }
+
+    // Convolves in place and blends the result with the dry signal
+    // (mix 0 = dry, 1 = fully convolved). Does nothing until an IR is loaded.
+    // Double buffers keep their dry signal in double; the wet one is computed
+    // in float, as juce::dsp::FFT only transforms floats
+    template <typename SampleType>
+    void process (juce::AudioBuffer<SampleType>& buffer, float mix);
+
+private:
+    // Uniformly partitioned overlap-save convolution of one IR segment
+    class Stage
+    {
+    public:
+        void build (const juce::AudioBuffer<float>& impulse, int startTap, int endTap, int newPartitionSize, int numChannels);
+        void reset();
+
+        bool isEmpty() const { return numPartitions == 0; }
+
+        // Convolves the next partitionSize input samples of a channel
+        void processBlock (int channel, const float* input, float* output);
+
+    private:
+        struct ChannelState
+        {
+            std::vector<float> previousInput;  // partitionSize
+            std::vector<float> delayLine;      // numPartitions spectra, newest at position
+            int position = 0;
+        };
+
+        int partitionSize = 0;
+        int numPartitions = 0;
+        int spectrumSize = 0;  // interleaved complex, non-negative bins only
+
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<std::vector<float>> spectra;  // per IR channel, numPartitions spectra
+        std::vector<ChannelState> channels;
+        std::vector<float> transform;  // 2 x FFT size, the layout juce::dsp::FFT wants
+        std::vector<float> accumulator;
+    };
+
+    struct Kernel
+    {
+        int length = 0;
+        std::vector<std::vector<float>> headTaps;  // per IR channel, reversed
+        Stage body;
+        Stage tail;
+
+        const std::vector<float>& getHeadTaps (int channel) const
+        {
+            return headTaps[static_cast<size_t> (juce::jmin (channel, static_cast<int> (headTaps.size()) - 1))];
+        }
+    };
+
+    std::unique_ptr<Kernel> createKernel() const;
+    void publish (std::unique_ptr<Kernel> kernel);
+
+    void takePendingKernel();
+    void clearState();
+    void exchangeTailBlock();
+    void waitForTailJob();
+
+    void run() override;
+
+    // Message thread
+    juce::AudioBuffer<float> sourceImpulse;
+    double sourceSampleRate = 44100.0;
+    juce::String impulseName;
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+
+    // Kernel handover: the message thread fills pending and frees retired,
+    // the audio thread swaps pending in once the previous kernel was collected
+    Kernel* activeKernel = nullptr;
+    std::atomic<Kernel*> pendingKernel { nullptr };
+    std::atomic<Kernel*> retiredKernel { nullptr };
+
+    // Audio thread, sized in prepare
+    std::vector<std::vector<float>> headHistory;  // per channel, 2 x headSize (mirrored)
+    int headPosition = 0;
+    std::vector<std::vector<float>> bodyInput;
+    std::vector<std::vector<float>> bodyOutput;
+    int bodyFill = 0;
+    std::vector<std::vector<float>> tailInput;
+    std::vector<std::vector<float>> tailOutput;
+    int tailFill = 0;
+    int ringingSamples = 0;
+    std::array<float, headSize> mixRamp {};
+    juce::SmoothedValue<float> mixSmoother;
+    bool snapMix = true;
+
+    // Tail worker: owns tailJobInput/tailJobResult while a job is in flight
+    std::vector<std::vector<float>> tailJobInput;
+    std::vector<std::vector<float>> tailJobResult;
+    Kernel* tailJobKernel = nullptr;
+    int tailJobChannels = 0;
+    bool tailJobInFlight = false;
+    juce::WaitableEvent tailJobDone;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolution)
+};
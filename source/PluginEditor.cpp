@@ -38,6 +38,12 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     advancedButton.onClick = [this]() { toggleAdvancedPanel(); };
     addAndMakeVisible (advancedButton);
 
+    // Auto quality - the label follows the block load in the timer
+    autoQualityButton.setTooltip ("Auto Quality\nWhen the CPU gets close to the audio deadline, steps down HQ filter, unison, drive oversampling and release tails instead of dropping out. Recovers after a couple of calm seconds");
+    addAndMakeVisible (autoQualityButton);
+    autoQualityAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::AUTO_QUALITY_ID, autoQualityButton);
+
     // Preset browser - street art style with vibrant colors
     prevPresetButton.setColour (juce::TextButton::buttonColourId, juce::Colour (0xffFF3333));  // Red
     prevPresetButton.setColour (juce::TextButton::textColourOffId, juce::Colour (0xffffffff));
@@ -66,6 +72,16 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     presetNameLabel.setFont (juce::Font (16.0f, juce::Font::bold));
     addAndMakeVisible (presetNameLabel);
 
+    // User preset search - queries the background-built library index, so it
+    // never touches the disk on the message thread
+    presetSearchBox.setTextToShowWhenEmpty ("Search presets...", juce::Colour (0xff888888));
+    presetSearchBox.setColour (juce::TextEditor::backgroundColourId, juce::Colour (0xffffffff));
+    presetSearchBox.setColour (juce::TextEditor::textColourId, juce::Colour (0xff000000));
+    presetSearchBox.setColour (juce::TextEditor::outlineColourId, juce::Colour (0xff000000));
+    presetSearchBox.setTooltip ("Search user presets by name\nUse #tag to filter by tag, press Enter to show results");
+    presetSearchBox.onReturnKey = [this]() { showPresetSearchResults(); };
+    addAndMakeVisible (presetSearchBox);
+
     updatePresetDisplay();
 
     // === PRIMARY CONTROLS SETUP ===
@@ -275,6 +291,182 @@ PluginEditor::PluginEditor (PluginProcessor& p)
     subOctaveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         processorRef.getAPVTS(), PluginProcessor::SUB_OCTAVE_ID, subOctaveCombo);
 
+    // MPE toggle - per-note pitch, pressure and timbre on channels 2-16
+    mpeButton.setTooltip ("MPE\nPer-note pitch bend, pressure and timbre from MPE controllers (channel 1 is the master channel)");
+    mpeButton.setVisible (false);
+    addAndMakeVisible (mpeButton);
+    mpeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::MPE_ENABLED_ID, mpeButton);
+
+    // HQ filter toggle - filter and drive share one 2x oversampled pass
+    hqFilterButton.setTooltip ("HQ Filter\nRuns the ladder filter oversampled together with the drive, so hard-driven resonance aliases less (more CPU)");
+    hqFilterButton.setVisible (false);
+    addAndMakeVisible (hqFilterButton);
+    hqFilterAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::FILTER_OVERSAMPLING_ID, hqFilterButton);
+
+    // Note cache toggle - static patches play pre-rendered notes
+    noteCacheButton.setTooltip ("Note Cache\nPlays notes of patches without LFO, glide or random modulation from audio rendered in the background (less CPU, more memory)");
+    noteCacheButton.setVisible (false);
+    addAndMakeVisible (noteCacheButton);
+    noteCacheAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::NOTE_CACHE_ID, noteCacheButton);
+
+    // Modulation matrix strip
+    modMatrixLabel.setText ("MOD MATRIX", juce::dontSendNotification);
+    modMatrixLabel.setJustificationType (juce::Justification::centredLeft);
+    modMatrixLabel.setFont (juce::Font (10.0f, juce::Font::bold));
+    modMatrixLabel.setVisible (false);
+    addAndMakeVisible (modMatrixLabel);
+
+    for (int route = 0; route < ModulationMatrix::numUserRoutes; ++route)
+    {
+        auto& controls = modRouteControls[static_cast<size_t> (route)];
+
+        controls.source.addItemList (ModulationMatrix::getSourceNames(), 1);
+        controls.source.setTooltip ("Modulation source");
+        controls.destination.addItemList (ModulationMatrix::getDestinationNames(), 1);
+        controls.destination.setTooltip ("Modulation destination");
+        controls.amount.setSliderStyle (juce::Slider::LinearHorizontal);
+        controls.amount.setTextBoxStyle (juce::Slider::TextBoxRight, false, 40, 18);
+        controls.amount.setTooltip ("Modulation amount (-1 to 1 of the destination range)");
+
+        for (auto* component : std::initializer_list<juce::Component*> { &controls.source, &controls.destination, &controls.amount })
+        {
+            component->setVisible (false);
+            addAndMakeVisible (component);
+        }
+
+        controls.sourceAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processorRef.getAPVTS(), PluginProcessor::MOD_SOURCE_IDS[route], controls.source);
+        controls.destinationAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+            processorRef.getAPVTS(), PluginProcessor::MOD_DESTINATION_IDS[route], controls.destination);
+        controls.amountAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+            processorRef.getAPVTS(), PluginProcessor::MOD_AMOUNT_IDS[route], controls.amount);
+    }
+
+    // LFO 2 Rate - only used through the matrix
+    setupSecondarySlider (lfo2RateSlider, lfo2RateLabel, "LFO 2");
+    lfo2RateSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    lfo2RateSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 50, 18);
+    lfo2RateSlider.setTooltip ("LFO 2 speed (0.01 - 20 Hz)\nTriangle LFO, route it in the mod matrix");
+    lfo2RateSlider.setVisible (false);
+    lfo2RateLabel.setVisible (false);
+    addAndMakeVisible (lfo2RateSlider);
+    addAndMakeVisible (lfo2RateLabel);
+    lfo2RateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::LFO2_RATE_ID, lfo2RateSlider);
+
+    // LFO Mode and Sync
+    lfoModeCombo.addItemList ({ "Per Voice", "Global" }, 1);
+    lfoModeCombo.setTooltip ("LFO mode\nPer Voice: every note runs its own LFOs\nGlobal: one shared, phase-coherent LFO for all notes");
+    lfoSyncCombo.addItemList (GlobalModulation::getSyncNames(), 1);
+    lfoSyncCombo.setTooltip ("LFO 1 tempo sync (global mode)\nLocks LFO 1 to the host tempo and song position");
+
+    for (auto* combo : { &lfoModeCombo, &lfoSyncCombo })
+    {
+        combo->setVisible (false);
+        addAndMakeVisible (combo);
+    }
+
+    lfoModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::LFO_MODE_ID, lfoModeCombo);
+    lfoSyncAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        processorRef.getAPVTS(), PluginProcessor::LFO_SYNC_ID, lfoSyncCombo);
+
+    // FX rack strip, in processing order
+    fxLabel.setText ("FX", juce::dontSendNotification);
+    fxLabel.setJustificationType (juce::Justification::centredLeft);
+    fxLabel.setFont (juce::Font (10.0f, juce::Font::bold));
+    fxLabel.setVisible (false);
+    addAndMakeVisible (fxLabel);
+
+    struct FxModuleSetup
+    {
+        const char* name;
+        const char* enabledId;
+        std::array<const char*, 2> sliderIds;
+        std::array<const char*, 2> tooltips;
+    };
+
+    const std::array<FxModuleSetup, 5> fxModules { {
+        { "EQ", PluginProcessor::FX_EQ_ENABLED_ID, { PluginProcessor::FX_LOW_SHELF_ID, PluginProcessor::FX_TILT_ID },
+          { "Low shelf below 100 Hz (dB)", "Tilt around 1.5 kHz (dB)\n+ brighter, - darker" } },
+        { "Comp", PluginProcessor::FX_COMP_ENABLED_ID, { PluginProcessor::FX_COMP_THRESHOLD_ID, PluginProcessor::FX_COMP_RATIO_ID },
+          { "Compressor threshold (dB)", "Compressor ratio" } },
+        { "Chorus", PluginProcessor::FX_CHORUS_ENABLED_ID, { PluginProcessor::FX_CHORUS_RATE_ID, PluginProcessor::FX_CHORUS_MIX_ID },
+          { "Chorus rate (Hz)", "Chorus mix" } },
+        { "Mono Bass", PluginProcessor::FX_MONO_ENABLED_ID, { PluginProcessor::FX_MONO_FREQUENCY_ID, nullptr },
+          { "Everything below this frequency is summed to mono (Hz)", nullptr } },
+        { "Cab", PluginProcessor::CAB_ENABLED_ID, { PluginProcessor::CAB_MIX_ID, nullptr },
+          { "Cabinet IR mix", nullptr } },
+    } };
+
+    for (size_t module = 0; module < fxModules.size(); ++module)
+    {
+        const auto& setup = fxModules[module];
+        auto& controls = fxModuleControls[module];
+
+        controls.enabled.setButtonText (setup.name);
+        controls.enabled.setVisible (false);
+        addAndMakeVisible (controls.enabled);
+        controls.enabledAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+            processorRef.getAPVTS(), setup.enabledId, controls.enabled);
+
+        for (size_t i = 0; i < controls.sliders.size(); ++i)
+        {
+            if (setup.sliderIds[i] == nullptr)
+                continue;
+
+            auto& slider = controls.sliders[i];
+            slider.setSliderStyle (juce::Slider::LinearHorizontal);
+            slider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 50, 18);
+            slider.setTooltip (setup.tooltips[i]);
+            slider.setVisible (false);
+            addAndMakeVisible (slider);
+            controls.sliderAttachments[i] = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                processorRef.getAPVTS(), setup.sliderIds[i], slider);
+        }
+    }
+
+    loadImpulseButton.setTooltip ("Load a cabinet / DI impulse response (WAV or AIFF, up to 4 s)");
+    loadImpulseButton.onClick = [this]() {
+        impulseChooser = std::make_unique<juce::FileChooser> ("Load Cabinet IR", juce::File(), "*.wav;*.aif;*.aiff");
+        impulseChooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+            [this] (const juce::FileChooser& chooser) {
+                const auto file = chooser.getResult();
+                if (file.existsAsFile() && processorRef.loadCabinetImpulse (file))
+                    loadImpulseButton.setButtonText (processorRef.getCabinet().getImpulseName());
+            });
+    };
+    if (processorRef.getCabinet().hasImpulseResponse())
+        loadImpulseButton.setButtonText (processorRef.getCabinet().getImpulseName());
+    loadImpulseButton.setVisible (false);
+    addAndMakeVisible (loadImpulseButton);
+
+    // Preset Morph XY pad - X is the automatable morph parameter, Y is a
+    // performance control that only matters once slot C or D is loaded
+    morphLabel.setText ("MORPH", juce::dontSendNotification);
+    morphLabel.setJustificationType (juce::Justification::centred);
+    morphLabel.setFont (juce::Font (10.0f, juce::Font::bold));
+    morphLabel.setVisible (false);
+    addAndMakeVisible (morphLabel);
+
+    morphPad.setTooltip ("Preset morph\nClick a corner to load a preset into that slot, drag to blend between them");
+    morphPad.setVisible (false);
+    morphPad.onDragStart = [this]() {
+        processorRef.getAPVTS().getParameter (PluginProcessor::MORPH_POSITION_ID)->beginChangeGesture();
+    };
+    morphPad.onPositionChanged = [this] (float x, float y) {
+        processorRef.getAPVTS().getParameter (PluginProcessor::MORPH_POSITION_ID)->setValueNotifyingHost (x);
+        processorRef.getMorphEngine().setPadY (y);
+    };
+    morphPad.onDragEnd = [this]() {
+        processorRef.getAPVTS().getParameter (PluginProcessor::MORPH_POSITION_ID)->endChangeGesture();
+    };
+    morphPad.onCornerClicked = [this] (int slot) { showMorphSlotMenu (slot); };
+    addAndMakeVisible (morphPad);
+
     // Inspector button
     addAndMakeVisible (inspectButton);
     inspectButton.setColour (juce::TextButton::buttonColourId, juce::Colour (0xffdddddd));
@@ -314,6 +506,25 @@ void PluginEditor::timerCallback()
     float sampleBuffer[bufferSize];
     processorRef.getWaveformSamples (sampleBuffer, bufferSize);
     waveformVisualizer.pushSamples (sampleBuffer, bufferSize);
+
+    updateQualityDisplay();
+
+    // Follow host automation of the morph position
+    morphPad.setPosition (processorRef.getAPVTS().getRawParameterValue (PluginProcessor::MORPH_POSITION_ID)->load(),
+        processorRef.getMorphEngine().getPadY());
+}
+
+void PluginEditor::updateQualityDisplay()
+{
+    const auto& governor = processorRef.getQualityGovernor();
+    const auto level = governor.getLevel();
+
+    auto text = "CPU " + juce::String (juce::roundToInt (governor.getLoad() * 100.0f)) + "%";
+    if (level != QualityGovernor::Level::full)
+        text << " - " << QualityGovernor::getName (level);
+
+    if (text != autoQualityButton.getButtonText())
+        autoQualityButton.setButtonText (text);
 }
 
 void PluginEditor::updatePresetDisplay()
@@ -321,6 +532,92 @@ void PluginEditor::updatePresetDisplay()
     presetNameLabel.setText (processorRef.getCurrentPresetName(), juce::dontSendNotification);
 }
 
+void PluginEditor::showPresetSearchResults()
+{
+    constexpr int maxResults = 50;
+    auto& library = processorRef.getPresetLibrary();
+    auto results = library.search (presetSearchBox.getText(), maxResults);
+
+    juce::PopupMenu menu;
+
+    if (results.empty())
+        menu.addItem (1, library.isScanning() ? "Scanning presets..." : "No matching presets", false);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto label = results[i].name;
+        if (results[i].author.isNotEmpty())
+            label << "  (" << results[i].author << ")";
+
+        menu.addItem (static_cast<int> (i) + 1, label);
+    }
+
+    juce::Component::SafePointer<PluginEditor> safeThis (this);
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (&presetSearchBox),
+        [safeThis, results = std::move (results)] (int chosen) {
+            if (safeThis == nullptr || chosen <= 0 || chosen > static_cast<int> (results.size()))
+                return;
+
+            if (safeThis->processorRef.loadUserPreset (results[static_cast<size_t> (chosen - 1)].file))
+                safeThis->updatePresetDisplay();
+        });
+}
+
+void PluginEditor::showMorphSlotMenu (int slot)
+{
+    const auto& presets = processorRef.getPresetManager().getPresets();
+
+    juce::PopupMenu menu;
+    menu.addItem (1, "Current Sound");
+    menu.addSeparator();
+
+    for (size_t i = 0; i < presets.size(); ++i)
+        menu.addItem (static_cast<int> (i) + 100, presets[i].name);
+
+    menu.addSeparator();
+    menu.addItem (2, "Clear Slot", processorRef.getMorphEngine().isSlotUsed (slot));
+
+    juce::Component::SafePointer<PluginEditor> safeThis (this);
+    menu.showMenuAsync (juce::PopupMenu::Options().withTargetComponent (&morphPad), [safeThis, slot] (int chosen) {
+        if (safeThis == nullptr || chosen == 0)
+            return;
+
+        auto& processor = safeThis->processorRef;
+        auto& morph = processor.getMorphEngine();
+        const auto& factoryPresets = processor.getPresetManager().getPresets();
+
+        if (chosen == 1)
+        {
+            morph.setSlot (slot, processor.captureVoiceParameters());
+            safeThis->morphPad.setCornerName (slot, processor.getCurrentPresetName());
+        }
+        else if (chosen == 2)
+        {
+            morph.clearSlot (slot);
+            safeThis->morphPad.setCornerName (slot, {});
+        }
+        else if (chosen >= 100 && chosen - 100 < static_cast<int> (factoryPresets.size()))
+        {
+            const auto& preset = factoryPresets[static_cast<size_t> (chosen - 100)];
+            // Factory presets have no matrix routes - keep the current ones
+            auto params = VoiceParameters::fromPreset (preset);
+            const auto current = processor.captureVoiceParameters();
+            params.lfo2Rate = current.lfo2Rate;
+            params.modRoutes = current.modRoutes;
+
+            morph.setSlot (slot, params);
+            safeThis->morphPad.setCornerName (slot, preset.name);
+        }
+
+        // Morphing takes over as soon as there are two slots to blend
+        int slotsUsed = 0;
+        for (int i = 0; i < MorphEngine::maxSlots; ++i)
+            slotsUsed += morph.isSlotUsed (i) ? 1 : 0;
+
+        morph.setEnabled (slotsUsed >= 2);
+    });
+}
+
 void PluginEditor::paint (juce::Graphics& g)
 {
     // Clean white background for logo contrast (street art aesthetic)
@@ -440,6 +737,7 @@ void PluginEditor::resized()
 
     // Advanced button (below output meter/waveform on right)
     advancedButton.setBounds (meterX, 20 + primaryKnobSize + 10, 100, 30);
+    autoQualityButton.setBounds (meterX + 110, 20 + primaryKnobSize + 13, primaryKnobSize + knobSpacing + 10, 24);
 
     // Preset browser (centered, positioned away from bottom edge)
     const int presetBrowserWidth = 300;
@@ -450,6 +748,7 @@ void PluginEditor::resized()
     prevPresetButton.setBounds (presetBrowserX, presetBrowserY, 50, buttonHeight);
     presetNameLabel.setBounds (presetBrowserX + 55, presetBrowserY, presetBrowserWidth - 110, buttonHeight);
     nextPresetButton.setBounds (presetBrowserX + presetBrowserWidth - 50, presetBrowserY, 50, buttonHeight);
+    presetSearchBox.setBounds (presetBrowserX + presetBrowserWidth + 10, presetBrowserY, 160, buttonHeight);
 
     // === ADVANCED PANEL (if showing) ===
     if (showAdvancedPanel)
@@ -556,6 +855,51 @@ void PluginEditor::resized()
         int subOctX = miscX + (secondaryKnobSize + secondarySpacing) * 2;
         subOctaveLabel.setBounds (subOctX, panelY, secondaryKnobSize, secondaryLabelHeight);
         subOctaveCombo.setBounds (subOctX, panelY + secondaryLabelHeight + 5, secondaryKnobSize, 30);
+        mpeButton.setBounds (subOctX, panelY + secondaryLabelHeight + 45, secondaryKnobSize, 24);
+        hqFilterButton.setBounds (subOctX, panelY + secondaryLabelHeight + 69, secondaryKnobSize + 20, 24);
+        noteCacheButton.setBounds (subOctX, panelY + secondaryLabelHeight + 93, secondaryKnobSize + 30, 24);
+
+        // MOD MATRIX strip - third row, four routes side by side plus LFO 2
+        panelY += secondaryKnobSize + secondaryTextBoxHeight + secondaryLabelHeight + 20;
+        // (starts right of the inspector button, which sits in the bottom-left corner)
+        const int routeWidth = 215;
+        int routeX = 110;
+        modMatrixLabel.setBounds (routeX, panelY, 100, secondaryLabelHeight);
+
+        for (auto& controls : modRouteControls)
+        {
+            controls.source.setBounds (routeX, panelY + secondaryLabelHeight, 100, 24);
+            controls.destination.setBounds (routeX + 105, panelY + secondaryLabelHeight, 100, 24);
+            controls.amount.setBounds (routeX, panelY + secondaryLabelHeight + 28, 205, 22);
+            routeX += routeWidth;
+        }
+
+        lfo2RateLabel.setBounds (routeX, panelY, 150, secondaryLabelHeight);
+        lfo2RateSlider.setBounds (routeX, panelY + secondaryLabelHeight, 150, 24);
+        lfoModeCombo.setBounds (routeX, panelY + secondaryLabelHeight + 28, 80, 22);
+        lfoSyncCombo.setBounds (routeX + 85, panelY + secondaryLabelHeight + 28, 65, 22);
+
+        // FX strip - fourth row, one column per module under the routes
+        panelY += secondaryLabelHeight + 60;
+        int fxX = 110;
+        fxLabel.setBounds (fxX, panelY, 100, secondaryLabelHeight);
+
+        for (auto& controls : fxModuleControls)
+        {
+            controls.enabled.setBounds (fxX, panelY + secondaryLabelHeight, 100, 22);
+            controls.sliders[0].setBounds (fxX + 100, panelY + secondaryLabelHeight, 105, 22);
+            controls.sliders[1].setBounds (fxX + 100, panelY + secondaryLabelHeight + 26, 105, 22);
+            fxX += routeWidth;
+        }
+
+        // Cab column: the file button sits where a second slider would
+        loadImpulseButton.setBounds (fxModuleControls.back().sliders[1].getBounds());
+
+        // Morph pad - right edge of the advanced panel, spanning both rows
+        const int morphPadSize = 170;
+        const int morphX = getWidth() - morphPadSize - 20;
+        morphLabel.setBounds (morphX, 220 + 5, morphPadSize, secondaryLabelHeight);
+        morphPad.setBounds (morphX, 220 + 25, morphPadSize, morphPadSize);
 
         // Inspector button - bottom-left corner of advanced panel
         inspectButton.setBounds (20, getHeight() - 35, 80, 25);
@@ -613,10 +957,37 @@ void PluginEditor::toggleAdvancedPanel()
 
     subOctaveCombo.setVisible (showAdvancedPanel);
     subOctaveLabel.setVisible (showAdvancedPanel);
+    mpeButton.setVisible (showAdvancedPanel);
+    hqFilterButton.setVisible (showAdvancedPanel);
+    noteCacheButton.setVisible (showAdvancedPanel);
+
+    modMatrixLabel.setVisible (showAdvancedPanel);
+    lfo2RateSlider.setVisible (showAdvancedPanel);
+    lfo2RateLabel.setVisible (showAdvancedPanel);
+    lfoModeCombo.setVisible (showAdvancedPanel);
+    lfoSyncCombo.setVisible (showAdvancedPanel);
+    for (auto& controls : modRouteControls)
+    {
+        controls.source.setVisible (showAdvancedPanel);
+        controls.destination.setVisible (showAdvancedPanel);
+        controls.amount.setVisible (showAdvancedPanel);
+    }
+
+    fxLabel.setVisible (showAdvancedPanel);
+    loadImpulseButton.setVisible (showAdvancedPanel);
+    for (auto& controls : fxModuleControls)
+    {
+        controls.enabled.setVisible (showAdvancedPanel);
+        for (size_t i = 0; i < controls.sliders.size(); ++i)
+            controls.sliders[i].setVisible (showAdvancedPanel && controls.sliderAttachments[i] != nullptr);
+    }
+
+    morphPad.setVisible (showAdvancedPanel);
+    morphLabel.setVisible (showAdvancedPanel);
 
     // Resize window
     if (showAdvancedPanel)
-        setSize (1200, 500);  // Main (220) + Advanced panel (280) - more space for knobs
+        setSize (1200, 680);  // Main (220) + Advanced panel (460) - two knob rows, the mod matrix and the FX strip
     else
         setSize (1200, 220);  // Main controls with visualizer
 
@@ -5,6 +5,7 @@
 #include "ThiccLogoComponent.h"
 #include "OutputMeterComponent.h"
 #include "WaveformVisualizerComponent.h"
+#include "MorphPadComponent.h"
 #include "BinaryData.h"
 #include "melatonin_inspector/melatonin_inspector.h"
 
@@ -23,6 +24,8 @@ private:
     void toggleAdvancedPanel();
     void timerCallback() override;
     void updatePresetDisplay();
+    void showPresetSearchResults();
+    void showMorphSlotMenu (int slot);
 
     PluginProcessor& processorRef;
     bool showAdvancedPanel = false;
@@ -36,11 +39,19 @@ private:
     WaveformVisualizerComponent waveformVisualizer;
     juce::TextButton advancedButton { "ADVANCED" };
 
+    // Auto quality toggle, labelled with the block load and the governor's level
+    juce::ToggleButton autoQualityButton { "CPU" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> autoQualityAttachment;
+    void updateQualityDisplay();
+
     // Preset browser
     juce::TextButton prevPresetButton { "<" };
     juce::TextButton nextPresetButton { ">" };
     juce::Label presetNameLabel;
 
+    // User preset library search ("name prefix #tag")
+    juce::TextEditor presetSearchBox;
+
     // === PRIMARY CONTROLS (Always Visible) ===
     // Filter Cutoff - Most important for bass shaping
     juce::Slider filterCutoffSlider;
@@ -144,6 +155,56 @@ private:
     juce::Label subOctaveLabel;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> subOctaveAttachment;
 
+    // MPE input toggle
+    juce::ToggleButton mpeButton { "MPE" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> mpeAttachment;
+    juce::ToggleButton hqFilterButton { "HQ Filter" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> hqFilterAttachment;
+    juce::ToggleButton noteCacheButton { "Note Cache" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> noteCacheAttachment;
+
+    // Modulation matrix strip - one row of source / destination / amount per route
+    struct ModRouteControls
+    {
+        juce::ComboBox source;
+        juce::ComboBox destination;
+        juce::Slider amount;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> sourceAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> destinationAttachment;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> amountAttachment;
+    };
+    std::array<ModRouteControls, ModulationMatrix::numUserRoutes> modRouteControls;
+    juce::Label modMatrixLabel;
+
+    juce::Slider lfo2RateSlider;
+    juce::Label lfo2RateLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> lfo2RateAttachment;
+
+    // LFO mode (per voice / global) and LFO 1 tempo sync
+    juce::ComboBox lfoModeCombo;
+    juce::ComboBox lfoSyncCombo;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lfoModeAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> lfoSyncAttachment;
+
+    // FX rack strip - on/off plus up to two horizontal sliders per module
+    struct FxModuleControls
+    {
+        juce::ToggleButton enabled;
+        std::array<juce::Slider, 2> sliders;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> enabledAttachment;
+        std::array<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>, 2> sliderAttachments;
+    };
+    std::array<FxModuleControls, 5> fxModuleControls;
+    juce::Label fxLabel;
+
+    // Cabinet IR file, read and transformed on the message thread
+    juce::TextButton loadImpulseButton { "Load IR..." };
+    std::unique_ptr<juce::FileChooser> impulseChooser;
+
+    // Preset morph XY pad (advanced panel)
+    MorphPadComponent morphPad;
+    juce::Label morphLabel;
+
     // Inspector for debugging
     std::unique_ptr<melatonin::Inspector> inspector;
     juce::TextButton inspectButton { "Inspect" };
@@ -12,21 +12,46 @@ PluginProcessor::PluginProcessor()
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ),
-       apvts (*this, nullptr, "Parameters", createParameterLayout())
+       apvts (*this, nullptr, "Parameters", createParameterLayout()),
+       stateSerializer (apvts)
 {
     // Add voices to the synthesizer
     for (int i = 0; i < NUM_VOICES; ++i)
-        synth.addVoice (new SynthVoice());
+    {
+        auto* voice = new SynthVoice (voiceBank, i);
+        voice->setControllerMap (&controllerMap);
+        voice->setPrerenderCache (&prerenderCache);
+        synth.addVoice (voice);
+    }
 
     // Add sound - SynthSound allows all notes
     synth.addSound (new SynthSound());
 
+    // Handle MIDI events at their exact sample position. The default lets events
+    // near a sub-block start jump early, which makes note timing depend on the
+    // host's block size
+    synth.setMinimumRenderingSubdivisionSize (1, true);
+
     // Load first preset by default on fresh install
     loadPreset(presetManager.getCurrentPreset());
+
+    // Any parameter change invalidates the cached state blob
+    for (auto* parameter : getParameters())
+        parameter->addListener (this);
+
+    // So do the morph slots and pad, which aren't parameters
+    morphEngine.onStateChange = [this] { markStateDirty(); };
+
+    // CLAP per-note modulation of these skips the parameter values entirely
+    for (auto* parameter : getParameters())
+        if (auto* modulated = dynamic_cast<NoteModulatedParameter*> (parameter))
+            modulated->setTarget (this);
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    for (auto* parameter : getParameters())
+        parameter->removeListener (this);
 }
 
 //==============================================================================
@@ -35,20 +60,22 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParam
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
     // Filter Cutoff (20 Hz - 20 kHz, logarithmic scale)
-    layout.add (std::make_unique<juce::AudioParameterFloat> (
+    layout.add (std::make_unique<NoteModulatedParameter> (
         juce::ParameterID (FILTER_CUTOFF_ID, 1),
         "Filter Cutoff",
         juce::NormalisableRange<float> (20.0f, 20000.0f, 0.1f, 0.3f),  // skew for logarithmic feel
         1000.0f,  // default value
-        "Hz"));
+        "Hz",
+        ModDestination::cutoff));
 
     // Filter Resonance (0.0 - 1.0)
-    layout.add (std::make_unique<juce::AudioParameterFloat> (
+    layout.add (std::make_unique<NoteModulatedParameter> (
         juce::ParameterID (FILTER_RESONANCE_ID, 1),
         "Filter Resonance",
         juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
         0.5f,  // default value
-        ""));
+        "",
+        ModDestination::resonance));
 
     // Amp Envelope Attack (1ms - 5s, logarithmic)
     layout.add (std::make_unique<juce::AudioParameterFloat> (
@@ -147,12 +174,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParam
         ""));
 
     // Drive Amount (0.0 - 1.0)
-    layout.add (std::make_unique<juce::AudioParameterFloat> (
+    layout.add (std::make_unique<NoteModulatedParameter> (
         juce::ParameterID (DRIVE_AMOUNT_ID, 1),
         "Drive",
         juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
         0.0f,  // default 0 (clean)
-        ""));
+        "",
+        ModDestination::drive));
 
     // === PHASE 3 PARAMETERS ===
 
@@ -196,12 +224,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParam
         1));  // default 1 voice (no unison)
 
     // Unison Detune Amount (0.0 - 1.0) - "THICC" control
-    layout.add (std::make_unique<juce::AudioParameterFloat> (
+    layout.add (std::make_unique<NoteModulatedParameter> (
         juce::ParameterID (UNISON_DETUNE_ID, 1),
         "THICC",
         juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
         0.0f,  // default 0 (no detune)
-        ""));
+        "",
+        ModDestination::detune));
 
     // Sub Octave Selector (-1 or -2 octaves)
     layout.add (std::make_unique<juce::AudioParameterChoice> (
@@ -210,61 +239,237 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParam
         juce::StringArray { "-1 Oct", "-2 Oct" },
         0));  // default -1 octave
 
+    // Morph Position (0 = slot A, 1 = slot B) - one automatable control for the whole morph
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (MORPH_POSITION_ID, 1),
+        "Morph",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.001f),
+        0.0f,
+        ""));
+
+    // MPE input - per-note pitch, pressure and timbre on member channels 2-16
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID (MPE_ENABLED_ID, 1),
+        "MPE",
+        false));
+
+    // HQ filter - runs the ladder filter at 2x together with the drive
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID (FILTER_OVERSAMPLING_ID, 1),
+        "HQ Filter",
+        false));
+
+    // Note cache - static patches play pre-rendered notes instead of running the voice DSP
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID (NOTE_CACHE_ID, 1),
+        "Note Cache",
+        false));
+
+    // Auto quality - steps voice quality down under CPU pressure (realtime only)
+    layout.add (std::make_unique<juce::AudioParameterBool> (
+        juce::ParameterID (AUTO_QUALITY_ID, 1),
+        "Auto Quality",
+        false));
+
+    // LFO 2 Rate (0.01 Hz - 20 Hz) - modulation matrix source
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (LFO2_RATE_ID, 1),
+        "LFO 2 Rate",
+        juce::NormalisableRange<float> (0.01f, 20.0f, 0.01f, 0.3f),  // logarithmic
+        0.5f,  // default 0.5 Hz
+        "Hz"));
+
+    // LFO Mode - one LFO per voice, or one shared by every voice
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID (LFO_MODE_ID, 1),
+        "LFO Mode",
+        juce::StringArray { "Per Voice", "Global" },
+        0));  // default per voice
+
+    // LFO 1 Tempo Sync - global mode only, overrides the LFO rate
+    layout.add (std::make_unique<juce::AudioParameterChoice> (
+        juce::ParameterID (LFO_SYNC_ID, 1),
+        "LFO Sync",
+        GlobalModulation::getSyncNames(),
+        0));  // default off
+
+    // Modulation matrix routes
+    const auto defaultRoutes = ModulationMatrix::getDefaultRoutes();
+    for (int route = 0; route < ModulationMatrix::numUserRoutes; ++route)
+    {
+        const auto name = "Mod " + juce::String (route + 1);
+        const auto& defaults = defaultRoutes[static_cast<size_t> (route)];
+
+        layout.add (std::make_unique<juce::AudioParameterChoice> (
+            juce::ParameterID (MOD_SOURCE_IDS[route], 1),
+            name + " Source",
+            ModulationMatrix::getSourceNames(),
+            defaults.source));
+
+        layout.add (std::make_unique<juce::AudioParameterChoice> (
+            juce::ParameterID (MOD_DESTINATION_IDS[route], 1),
+            name + " Destination",
+            ModulationMatrix::getDestinationNames(),
+            defaults.destination));
+
+        layout.add (std::make_unique<juce::AudioParameterFloat> (
+            juce::ParameterID (MOD_AMOUNT_IDS[route], 1),
+            name + " Amount",
+            juce::NormalisableRange<float> (-1.0f, 1.0f, 0.01f),
+            defaults.amount,
+            ""));
+    }
+
+    // FX rack - each module has its own on/off, all off by default
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID (FX_EQ_ENABLED_ID, 1), "EQ", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_LOW_SHELF_ID, 1),
+        "EQ Low Shelf",
+        juce::NormalisableRange<float> (-12.0f, 12.0f, 0.1f),
+        0.0f,
+        "dB"));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_TILT_ID, 1),
+        "EQ Tilt",
+        juce::NormalisableRange<float> (-12.0f, 12.0f, 0.1f),
+        0.0f,
+        "dB"));
+
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID (FX_COMP_ENABLED_ID, 1), "Compressor", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_COMP_THRESHOLD_ID, 1),
+        "Comp Threshold",
+        juce::NormalisableRange<float> (-40.0f, 0.0f, 0.1f),
+        -18.0f,
+        "dB"));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_COMP_RATIO_ID, 1),
+        "Comp Ratio",
+        juce::NormalisableRange<float> (1.0f, 20.0f, 0.1f, 0.5f),
+        4.0f,
+        ":1"));
+
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID (FX_CHORUS_ENABLED_ID, 1), "Chorus", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_CHORUS_RATE_ID, 1),
+        "Chorus Rate",
+        juce::NormalisableRange<float> (0.05f, 5.0f, 0.01f, 0.5f),
+        0.8f,
+        "Hz"));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_CHORUS_MIX_ID, 1),
+        "Chorus Mix",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        0.3f,
+        ""));
+
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID (FX_MONO_ENABLED_ID, 1), "Mono Bass", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (FX_MONO_FREQUENCY_ID, 1),
+        "Mono Below",
+        juce::NormalisableRange<float> (40.0f, 400.0f, 1.0f, 0.5f),
+        120.0f,
+        "Hz"));
+
+    // Cabinet IR - off until an impulse is loaded and switched on
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID (CAB_ENABLED_ID, 1), "Cabinet", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (
+        juce::ParameterID (CAB_MIX_ID, 1),
+        "Cabinet Mix",
+        juce::NormalisableRange<float> (0.0f, 1.0f, 0.01f),
+        1.0f,
+        ""));
+
     return layout;
 }
 
+namespace
+{
+    // Builds a voice parameter snapshot from any source of denormalised values
+    template <typename GetValue>
+    VoiceParameters makeVoiceParameters (GetValue&& getValue)
+    {
+        VoiceParameters p;
+        p.filterCutoff = getValue (PluginProcessor::FILTER_CUTOFF_ID);
+        p.filterResonance = getValue (PluginProcessor::FILTER_RESONANCE_ID);
+        p.ampAttack = getValue (PluginProcessor::AMP_ATTACK_ID);
+        p.ampDecay = getValue (PluginProcessor::AMP_DECAY_ID);
+        p.ampSustain = getValue (PluginProcessor::AMP_SUSTAIN_ID);
+        p.ampRelease = getValue (PluginProcessor::AMP_RELEASE_ID);
+        p.subMix = getValue (PluginProcessor::SUB_MIX_ID);
+        p.filterEnvAttack = getValue (PluginProcessor::FILTER_ENV_ATTACK_ID);
+        p.filterEnvDecay = getValue (PluginProcessor::FILTER_ENV_DECAY_ID);
+        p.filterEnvSustain = getValue (PluginProcessor::FILTER_ENV_SUSTAIN_ID);
+        p.filterEnvRelease = getValue (PluginProcessor::FILTER_ENV_RELEASE_ID);
+        p.filterEnvAmount = getValue (PluginProcessor::FILTER_ENV_AMOUNT_ID);
+        p.lfoRate = getValue (PluginProcessor::LFO_RATE_ID);
+        p.lfoAmount = getValue (PluginProcessor::LFO_AMOUNT_ID);
+        p.driveAmount = getValue (PluginProcessor::DRIVE_AMOUNT_ID);
+
+        // Phase 3 parameters
+        p.glideTime = getValue (PluginProcessor::GLIDE_TIME_ID);
+        p.velocityToFilter = getValue (PluginProcessor::VELOCITY_TO_FILTER_ID);
+        p.velocityToAmp = getValue (PluginProcessor::VELOCITY_TO_AMP_ID);
+        p.filterKeyTrack = getValue (PluginProcessor::FILTER_KEY_TRACK_ID);
+        p.unisonVoices = static_cast<int> (getValue (PluginProcessor::UNISON_VOICES_ID));
+        p.unisonDetune = getValue (PluginProcessor::UNISON_DETUNE_ID);
+        p.subOctave = static_cast<int> (getValue (PluginProcessor::SUB_OCTAVE_ID)) + 1;  // Convert 0,1 to 1,2
+
+        // Modulation matrix
+        p.lfo2Rate = getValue (PluginProcessor::LFO2_RATE_ID);
+        for (size_t route = 0; route < p.modRoutes.size(); ++route)
+        {
+            p.modRoutes[route].source = static_cast<int> (getValue (PluginProcessor::MOD_SOURCE_IDS[route]));
+            p.modRoutes[route].destination = static_cast<int> (getValue (PluginProcessor::MOD_DESTINATION_IDS[route]));
+            p.modRoutes[route].amount = getValue (PluginProcessor::MOD_AMOUNT_IDS[route]);
+        }
+        return p;
+    }
+}
+
 void PluginProcessor::updateVoiceParameters()
 {
-    // Get current parameter values
-    float cutoff = apvts.getRawParameterValue (FILTER_CUTOFF_ID)->load();
-    float resonance = apvts.getRawParameterValue (FILTER_RESONANCE_ID)->load();
-    float attack = apvts.getRawParameterValue (AMP_ATTACK_ID)->load();
-    float decay = apvts.getRawParameterValue (AMP_DECAY_ID)->load();
-    float sustain = apvts.getRawParameterValue (AMP_SUSTAIN_ID)->load();
-    float release = apvts.getRawParameterValue (AMP_RELEASE_ID)->load();
-    float subMix = apvts.getRawParameterValue (SUB_MIX_ID)->load();
-    float filterEnvAttack = apvts.getRawParameterValue (FILTER_ENV_ATTACK_ID)->load();
-    float filterEnvDecay = apvts.getRawParameterValue (FILTER_ENV_DECAY_ID)->load();
-    float filterEnvSustain = apvts.getRawParameterValue (FILTER_ENV_SUSTAIN_ID)->load();
-    float filterEnvRelease = apvts.getRawParameterValue (FILTER_ENV_RELEASE_ID)->load();
-    float filterEnvAmount = apvts.getRawParameterValue (FILTER_ENV_AMOUNT_ID)->load();
-    float lfoRate = apvts.getRawParameterValue (LFO_RATE_ID)->load();
-    float lfoAmount = apvts.getRawParameterValue (LFO_AMOUNT_ID)->load();
-    float driveAmount = apvts.getRawParameterValue (DRIVE_AMOUNT_ID)->load();
-
-    // Phase 3 parameters
-    float glideTime = apvts.getRawParameterValue (GLIDE_TIME_ID)->load();
-    float velocityToFilter = apvts.getRawParameterValue (VELOCITY_TO_FILTER_ID)->load();
-    float velocityToAmp = apvts.getRawParameterValue (VELOCITY_TO_AMP_ID)->load();
-    float filterKeyTrack = apvts.getRawParameterValue (FILTER_KEY_TRACK_ID)->load();
-    int unisonVoices = static_cast<int> (apvts.getRawParameterValue (UNISON_VOICES_ID)->load());
-    float unisonDetune = apvts.getRawParameterValue (UNISON_DETUNE_ID)->load();
-    int subOctave = static_cast<int> (apvts.getRawParameterValue (SUB_OCTAVE_ID)->load());
+    // The message thread is in the middle of writing a preset - keep the
+    // current voice settings rather than reading a half-written set
+    const auto sequence = parameterWriteSequence.load (std::memory_order_acquire);
+    if ((sequence & 1u) != 0)
+        return;
+
+    // Get current parameter values (thread-safe via atomic loads)
+    const auto params = makeVoiceParameters ([this] (const char* id) {
+        return apvts.getRawParameterValue (id)->load (std::memory_order_relaxed);
+    });
+
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (parameterWriteSequence.load (std::memory_order_relaxed) != sequence)
+        return;
+
+    applyVoiceParameters (params);
+}
+
+VoiceParameters PluginProcessor::captureVoiceParameters() const
+{
+    return makeVoiceParameters ([this] (const char* id) {
+        return apvts.getRawParameterValue (id)->load();
+    });
+}
+
+void PluginProcessor::applyVoiceParameters (const VoiceParameters& requested)
+{
+    // Under CPU pressure the governor caps the unison voices
+    auto params = requested;
+    params.unisonVoices = juce::jmin (params.unisonVoices, QualityGovernor::getMaxUnisonVoices (qualityLevel));
+
+    globalLfoRate = params.lfoRate;
+    globalLfo2Rate = params.lfo2Rate;
+    appliedAmpRelease.store (params.ampRelease, std::memory_order_relaxed);
+    appliedParameters = params;
 
     // Update all voices
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
-        {
-            voice->setFilterCutoff (cutoff);
-            voice->setFilterResonance (resonance);
-            voice->setAmpEnvelope (attack, decay, sustain, release);
-            voice->setFilterEnvelope (filterEnvAttack, filterEnvDecay, filterEnvSustain, filterEnvRelease);
-            voice->setFilterEnvAmount (filterEnvAmount);
-            voice->setSubMix (subMix);
-            voice->setLFORate (lfoRate);
-            voice->setLFOAmount (lfoAmount);
-            voice->setDriveAmount (driveAmount);
-
-            // Phase 3 parameters
-            voice->setGlideTime (glideTime);
-            voice->setVelocityToFilter (velocityToFilter);
-            voice->setVelocityToAmp (velocityToAmp);
-            voice->setFilterKeyTracking (filterKeyTrack);
-            voice->setUnisonVoices (unisonVoices);
-            voice->setUnisonDetune (unisonDetune);
-            voice->setSubOctave (subOctave + 1);  // Convert 0,1 to 1,2
-        }
+            voice->setParameters (params);
     }
 }
 
@@ -303,7 +508,17 @@ bool PluginProcessor::isMidiEffect() const
 
 double PluginProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // The amp release is the only thing that rings on after a note-off: it
+    // reaches the -96 dB cut-off within its set time. A morph can apply a
+    // release that isn't in the APVTS, so the longer of the two is reported
+    const auto release = apvts.getRawParameterValue (AMP_RELEASE_ID)->load();
+    const auto tail = static_cast<double> (juce::jmax (release, appliedAmpRelease.load (std::memory_order_relaxed)));
+
+    // A cabinet IR rings on for its own length after that
+    if (apvts.getRawParameterValue (CAB_ENABLED_ID)->load() > 0.5f)
+        return tail + cabinet.getImpulseSeconds();
+
+    return tail;
 }
 
 int PluginProcessor::getNumPrograms()
@@ -339,7 +554,8 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     // Prepare the synthesizer
     synth.setCurrentPlaybackSampleRate (sampleRate);
 
-    // Prepare all voices
+    // Prepare all voices, and the bank their oscillators are stepped in
+    voiceBank.prepare (samplesPerBlock);
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
@@ -348,10 +564,41 @@ void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
         }
     }
 
+    globalModulation.prepare (sampleRate, samplesPerBlock);
+
+    // The voices let go of their cached notes when they were prepared
+    prerenderCache.prepare (sampleRate);
+
+    qualityGovernor.prepare (sampleRate);
+    qualityLevel = QualityGovernor::Level::full;
+
+    fxRackFloat.prepare (sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+    fxRackDouble.prepare (sampleRate, samplesPerBlock, getTotalNumOutputChannels());
+
+    cabinet.prepare (sampleRate, getTotalNumOutputChannels());
+    cabinetEnabled = false;
+
+    doublePrecisionBuffer.setSize (juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()), samplesPerBlock);
+
+    // Preallocate the controller split so processBlock never allocates
+    controllerEvents.reserve (maxControllerEventsPerBlock);
+    noteExpressionEvents.reserve (maxControllerEventsPerBlock / 4);
+    synthMidi.ensureSize (static_cast<size_t> (midiBufferBytesPerEvent * maxControllerEventsPerBlock));
+    clapNoteMidi.ensureSize (static_cast<size_t> (midiBufferBytesPerEvent * maxControllerEventsPerBlock / 4));
+
     // Initialize waveform buffer for visualizer
     waveformBuffer.setSize (1, waveformBufferSize);
     waveformBuffer.clear();
     waveformBufferPos.store (0);
+    outputSilent = false;
+
+    // Nothing is sounding yet: queued preset switches can be dropped, the
+    // APVTS already holds their values
+    presetFade = {};
+    presetFade.fadeLength = juce::jmax (1, juce::roundToInt (sampleRate * presetFadeSeconds));
+    VoiceParameters queuedPreset;
+    while (popPresetSwitch (queuedPreset))
+        ;
 
     // Initialize all voices with current parameter values
     updateVoiceParameters();
@@ -363,6 +610,37 @@ void PluginProcessor::releaseResources()
     // spare memory, etc.
 }
 
+void PluginProcessor::reset()
+{
+    // Called by hosts on transport jumps (and by the render daemon between
+    // jobs): everything that rings or runs on is dropped, so the next block
+    // renders exactly like a freshly prepared instance would
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+            voice->reset();
+    }
+
+    globalModulation.reset();
+    fxRackFloat.reset();
+    fxRackDouble.reset();
+    cabinet.reset();
+
+    waveformBuffer.clear();
+    waveformBufferPos.store (0);
+    currentOutputLevel.store (0.0f);
+    outputSilent = false;
+
+    // Queued preset switches are dropped, the APVTS already holds their values
+    presetFade.stage = PresetFade::Stage::idle;
+    presetFade.samplesRemaining = 0;
+    VoiceParameters queuedPreset;
+    while (popPresetSwitch (queuedPreset))
+        ;
+
+    updateVoiceParameters();
+}
+
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
   #if JucePlugin_IsMidiEffect
@@ -385,8 +663,61 @@ bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
   #endif
 }
 
+template <>
+FxRack<float>& PluginProcessor::getFxRack<float>()
+{
+    return fxRackFloat;
+}
+
+template <>
+FxRack<double>& PluginProcessor::getFxRack<double>()
+{
+    return fxRackDouble;
+}
+
 void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    qualityProfile = QualityProfile::forRenderMode (isNonRealtime());
+
+    // Offline, float hosts get the double filter and oversampler state too.
+    // The buffer was sized in prepareToPlay; larger blocks stay in float
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (qualityProfile.doublePrecision && numChannels <= doublePrecisionBuffer.getNumChannels()
+        && numSamples <= doublePrecisionBuffer.getNumSamples())
+    {
+        juce::AudioBuffer<double> block (doublePrecisionBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        processSamples (block, midiMessages);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* destination = buffer.getWritePointer (channel);
+            const auto* source = block.getReadPointer (channel);
+            for (int sample = 0; sample < numSamples; ++sample)
+                destination[sample] = static_cast<float> (source[sample]);
+        }
+    }
+    else
+    {
+        processSamples (buffer, midiMessages);
+    }
+
+    updateQualityGovernor (startTicks, numSamples);
+}
+
+void PluginProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    qualityProfile = QualityProfile::forRenderMode (isNonRealtime());
+    processSamples (buffer, midiMessages);
+    updateQualityGovernor (startTicks, buffer.getNumSamples());
+}
+
+template <typename SampleType>
+void PluginProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
 {
     // Critical: Prevent denormal CPU spikes
     juce::ScopedNoDenormals noDenormals;
@@ -401,11 +732,89 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     // Clear the buffer for synthesizer output (synth is additive)
     buffer.clear();
 
-    // Update voice parameters (thread-safe via atomic loads)
-    updateVoiceParameters();
+    // Notes the CLAP glue handed over as direct events
+    if (! clapNoteMidi.isEmpty())
+    {
+        midiMessages.addEvents (clapNoteMidi, 0, -1, 0);
+        clapNoteMidi.clear();
+    }
+    lastDirectEventOffset = 0;
+
+    // Pick up a preset switch published by the message thread
+    VoiceParameters switchedPreset;
+    bool hasPresetSwitch = false;
+    while (popPresetSwitch (switchedPreset))
+        hasPresetSwitch = true;
 
-    // Render synthesizer audio
-    synth.renderNextBlock (buffer, midiMessages, 0, buffer.getNumSamples());
+    if (hasPresetSwitch)
+    {
+        presetFade.pending = switchedPreset;
+
+        if (! isAnyVoiceActive())
+        {
+            // Nothing to click - switch straight away
+            applyVoiceParameters (presetFade.pending);
+            presetFade.stage = PresetFade::Stage::idle;
+        }
+        else if (presetFade.stage == PresetFade::Stage::idle)
+        {
+            presetFade.stage = PresetFade::Stage::fadingOut;
+            presetFade.samplesRemaining = presetFade.fadeLength;
+        }
+        else if (presetFade.stage == PresetFade::Stage::fadingIn)
+        {
+            // Reverse from the current gain instead of jumping back to full level
+            presetFade.stage = PresetFade::Stage::fadingOut;
+            presetFade.samplesRemaining = presetFade.fadeLength - presetFade.samplesRemaining;
+        }
+    }
+
+    // Nothing sounding and nothing arriving to start a note: the buffer is
+    // already clear, so skip the voices, the clipper and the meters
+    if (isSilentBlock (midiMessages))
+    {
+        processSilentBlock (buffer.getNumSamples());
+        forgetEndedClapNotes();
+        return;
+    }
+    outputSilent = false;
+
+    // Update voice parameters (thread-safe via atomic loads). While fading out
+    // the old sound is kept frozen - the APVTS already holds the new preset.
+    // An active morph blends its slots once per block instead
+    if (presetFade.stage != PresetFade::Stage::fadingOut)
+    {
+        if (morphEngine.isActive())
+            applyVoiceParameters (morphEngine.process (apvts.getRawParameterValue (MORPH_POSITION_ID)->load()));
+        else
+            updateVoiceParameters();
+    }
+
+    // Controller data goes to the voices as timestamped events; only notes and
+    // pedals are left for the synthesiser to split the block at
+    prepareControllerEvents (midiMessages, buffer.getNumSamples());
+
+    prepareGlobalModulation (buffer.getNumSamples());
+    updatePrerenderCache (updateFilterOversampling());
+
+    // The cheapest quality level frees voices whose tails are barely audible
+    if (QualityGovernor::cutsQuietTails (qualityLevel))
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+        {
+            if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+                voice->cutQuietTail (QualityGovernor::quietTailLevel);
+        }
+    }
+
+    // Render synthesizer audio, split where a preset fade-out ends
+    renderSynth (buffer, synthMidi);
+    forgetEndedClapNotes();
+
+    // Post-synth FX - bypassed modules are skipped for the whole block
+    auto& fxRack = getFxRack<SampleType>();
+    fxRack.setSettings (getFxSettings());
+    fxRack.process (buffer);
 
     // === Phase 3: Soft clipper/limiter on output (always on) ===
     // Apply gentle tanh soft clipping to prevent harsh clipping
@@ -415,16 +824,18 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
         for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
         {
             // Soft clip with tanh (smooth saturation)
-            channelData[sample] = std::tanh (channelData[sample] * 0.8f) * 1.2f;
+            channelData[sample] = std::tanh (channelData[sample] * SampleType (0.8)) * SampleType (1.2);
         }
     }
 
+    processCabinet (buffer);
+
     // === Output Level Metering ===
     // Calculate RMS level for output meter (thread-safe)
     float rmsLevel = 0.0f;
     for (int channel = 0; channel < totalNumOutputChannels; ++channel)
     {
-        rmsLevel += buffer.getRMSLevel (channel, 0, buffer.getNumSamples());
+        rmsLevel += static_cast<float> (buffer.getRMSLevel (channel, 0, buffer.getNumSamples()));
     }
     if (totalNumOutputChannels > 0)
         rmsLevel /= static_cast<float> (totalNumOutputChannels);
@@ -444,7 +855,7 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
             float sample = 0.0f;
             for (int ch = 0; ch < totalNumOutputChannels; ++ch)
             {
-                sample += buffer.getSample (ch, i);
+                sample += static_cast<float> (buffer.getSample (ch, i));
             }
             sample /= static_cast<float> (totalNumOutputChannels);
 
@@ -457,6 +868,428 @@ void PluginProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     }
 }
 
+template <typename SampleType>
+void PluginProcessor::renderSynth (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples();
+    int position = 0;
+
+    while (position < numSamples)
+    {
+        int segmentLength = numSamples - position;
+        if (presetFade.stage == PresetFade::Stage::fadingOut)
+            segmentLength = juce::jmin (segmentLength, presetFade.samplesRemaining);
+
+        synth.renderNextBlock (buffer, midiMessages, position, segmentLength);
+        applyPresetFade (buffer, position, segmentLength);
+        position += segmentLength;
+    }
+}
+
+void PluginProcessor::prepareControllerEvents (const juce::MidiBuffer& midiMessages, int numSamples)
+{
+    controllerMap.setMpeEnabled (apvts.getRawParameterValue (MPE_ENABLED_ID)->load() > 0.5f);
+    controllerMap.splitMidi (midiMessages, synthMidi, controllerEvents);
+
+    // Merge the CLAP note expressions in time order (both lists are short and
+    // the insert stays within the reserved capacity)
+    for (auto event : noteExpressionEvents)
+    {
+        if (controllerEvents.size() == controllerEvents.capacity())
+            break;
+
+        event.samplePosition = juce::jlimit (0, juce::jmax (0, numSamples - 1), event.samplePosition);
+        const auto insertAt = std::upper_bound (controllerEvents.begin(), controllerEvents.end(), event.samplePosition,
+            [] (int samplePosition, const ControllerEvent& e) { return samplePosition < e.samplePosition; });
+        controllerEvents.insert (insertAt, event);
+    }
+    noteExpressionEvents.clear();
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+            voice->setControllerEvents (controllerEvents.data(), static_cast<int> (controllerEvents.size()));
+    }
+}
+
+bool PluginProcessor::isSilentBlock (const juce::MidiBuffer& midiMessages) const
+{
+    // Any MIDI at all goes through the full path, so controller state and
+    // note-ons are handled exactly as in a sounding block
+    return presetFade.stage == PresetFade::Stage::idle
+        && midiMessages.isEmpty()
+        && noteExpressionEvents.empty()
+        && ! isAnyVoiceActive()
+        && ! (cabinetEnabled && cabinet.isRinging());
+}
+
+void PluginProcessor::processSilentBlock (int numSamples)
+{
+    // Keep the global LFOs moving, so the next note starts at the right phase
+    if (apvts.getRawParameterValue (LFO_MODE_ID)->load() > 0.5f)
+    {
+        const auto position = getHostPosition();
+        const auto syncIndex = static_cast<int> (apvts.getRawParameterValue (LFO_SYNC_ID)->load());
+        globalModulation.advance (numSamples, globalLfoRate, globalLfo2Rate, syncIndex, position ? &*position : nullptr);
+    }
+
+    // Drop the meter and the visualiser to zero once, rather than every block
+    if (! outputSilent)
+    {
+        currentOutputLevel.store (0.0f);
+        waveformBuffer.clear();
+
+        // The chorus delay line would otherwise replay the last note's tail
+        fxRackFloat.reset();
+        fxRackDouble.reset();
+        outputSilent = true;
+    }
+}
+
+juce::Optional<juce::AudioPlayHead::PositionInfo> PluginProcessor::getHostPosition() const
+{
+    if (auto* playHead = getPlayHead())
+        return playHead->getPosition();
+
+    return {};
+}
+
+void PluginProcessor::prepareGlobalModulation (int numSamples)
+{
+    const float* lfo1 = nullptr;
+    const float* lfo2 = nullptr;
+
+    if (apvts.getRawParameterValue (LFO_MODE_ID)->load() > 0.5f)
+    {
+        const auto position = getHostPosition();
+        const auto syncIndex = static_cast<int> (apvts.getRawParameterValue (LFO_SYNC_ID)->load());
+
+        if (globalModulation.process (numSamples, globalLfoRate, globalLfo2Rate, syncIndex, position ? &*position : nullptr))
+        {
+            lfo1 = globalModulation.getLfo1();
+            lfo2 = globalModulation.getLfo2();
+        }
+    }
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+            voice->setGlobalModulation (lfo1, lfo2);
+    }
+}
+
+template <typename SampleType>
+void PluginProcessor::processCabinet (juce::AudioBuffer<SampleType>& buffer)
+{
+    const bool enabled = apvts.getRawParameterValue (CAB_ENABLED_ID)->load() > 0.5f;
+
+    // Coming back on starts from silence rather than the old tail
+    if (enabled && ! cabinetEnabled)
+        cabinet.reset();
+
+    cabinetEnabled = enabled;
+    if (! enabled)
+        return;
+
+    cabinet.process (buffer, apvts.getRawParameterValue (CAB_MIX_ID)->load());
+}
+
+FxSettings PluginProcessor::getFxSettings() const
+{
+    auto get = [this] (const char* id) { return apvts.getRawParameterValue (id)->load(); };
+
+    FxSettings settings;
+    settings.eqEnabled = get (FX_EQ_ENABLED_ID) > 0.5f;
+    settings.lowShelfGain = get (FX_LOW_SHELF_ID);
+    settings.tilt = get (FX_TILT_ID);
+    settings.compressorEnabled = get (FX_COMP_ENABLED_ID) > 0.5f;
+    settings.compressorThreshold = get (FX_COMP_THRESHOLD_ID);
+    settings.compressorRatio = get (FX_COMP_RATIO_ID);
+    settings.chorusEnabled = get (FX_CHORUS_ENABLED_ID) > 0.5f;
+    settings.chorusRate = get (FX_CHORUS_RATE_ID);
+    settings.chorusMix = get (FX_CHORUS_MIX_ID);
+    settings.monoEnabled = get (FX_MONO_ENABLED_ID) > 0.5f;
+    settings.monoFrequency = get (FX_MONO_FREQUENCY_ID);
+    return settings;
+}
+
+bool PluginProcessor::updateFilterOversampling()
+{
+    // Offline renders always take the HQ filter at 4x. The governor turns the
+    // HQ filter off first, then the drive's 2x pass
+    const bool filterOversampled = (apvts.getRawParameterValue (FILTER_OVERSAMPLING_ID)->load() > 0.5f || qualityProfile.hqFilter)
+                                && QualityGovernor::allowsHqFilter (qualityLevel);
+    const bool driveOversampled = QualityGovernor::allowsDriveOversampling (qualityLevel);
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+        {
+            voice->setFilterOversampling (filterOversampled);
+            voice->setDriveOversampling (driveOversampled);
+            voice->setFourTimesOversampling (qualityProfile.fourTimesOversampling);
+        }
+    }
+
+    return filterOversampled;
+}
+
+void PluginProcessor::updateQualityGovernor (juce::int64 startTicks, int numSamples)
+{
+    // Offline renders have no deadline to meet
+    const bool enabled = apvts.getRawParameterValue (AUTO_QUALITY_ID)->load() > 0.5f && ! isNonRealtime();
+    const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+    qualityLevel = qualityGovernor.update (seconds, numSamples, enabled);
+}
+
+void PluginProcessor::updatePrerenderCache (bool filterOversampled)
+{
+    // Offline there's time to render every note live, at the offline quality
+    const bool enabled = apvts.getRawParameterValue (NOTE_CACHE_ID)->load() > 0.5f && qualityProfile.noteCache;
+
+    // Notes playing from stale entries cross over to the live render
+    if (! prerenderCache.update (enabled, appliedParameters, filterOversampled))
+        return;
+
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+    {
+        if (auto* voice = dynamic_cast<SynthVoice*> (synth.getVoice (i)))
+            voice->stopCachedPlayback();
+    }
+}
+
+bool PluginProcessor::supportsDirectEvent (uint16_t spaceId, uint16_t type)
+{
+    return spaceId == CLAP_CORE_EVENT_SPACE_ID
+        && (type == CLAP_EVENT_NOTE_EXPRESSION || type == CLAP_EVENT_NOTE_ON || type == CLAP_EVENT_NOTE_OFF
+            || type == CLAP_EVENT_NOTE_CHOKE);
+}
+
+void PluginProcessor::handleDirectEvent (const clap_event_header_t* event, int sampleOffset)
+{
+    if (! supportsDirectEvent (event->space_id, event->type))
+        return;
+
+    // Events arrive in time order, a parameter modulation after them lands here too
+    lastDirectEventOffset = sampleOffset;
+
+    if (event->type != CLAP_EVENT_NOTE_EXPRESSION)
+    {
+        handleClapNote (*reinterpret_cast<const clap_event_note_t*> (event), event->type, sampleOffset);
+        return;
+    }
+
+    const auto* noteExpression = reinterpret_cast<const clap_event_note_expression_t*> (event);
+
+    NoteExpression expression;
+    switch (noteExpression->expression_id)
+    {
+        case CLAP_NOTE_EXPRESSION_TUNING:     expression = NoteExpression::tuning; break;
+        case CLAP_NOTE_EXPRESSION_PRESSURE:   expression = NoteExpression::pressure; break;
+        case CLAP_NOTE_EXPRESSION_BRIGHTNESS: expression = NoteExpression::brightness; break;
+        default: return;
+    }
+
+    // CLAP channels are 0-15 with -1 for "any", keys are -1 for "any"
+    if (noteExpressionEvents.size() < noteExpressionEvents.capacity())
+        noteExpressionEvents.push_back (MidiControllerMap::makeNoteExpressionEvent (expression, noteExpression->value,
+            noteExpression->channel + 1, noteExpression->key, sampleOffset));
+}
+
+void PluginProcessor::handleClapNote (const clap_event_note_t& note, uint16_t type, int sampleOffset)
+{
+    int channel = note.channel + 1;
+    int key = note.key;
+
+    // The note ID alone may address a note-off or choke. An ID we don't know
+    // (its note already ended) addresses nothing - the wildcards it comes
+    // with would otherwise end every note
+    if (note.note_id >= 0 && (key < 0 || channel <= 0))
+    {
+        const auto* known = findClapNote (note.note_id);
+        if (known == nullptr)
+            return;
+
+        channel = known->channel;
+        key = known->key;
+    }
+
+    const auto velocity = static_cast<float> (note.velocity);
+
+    if (type == CLAP_EVENT_NOTE_ON)
+    {
+        if (channel <= 0 || key < 0)
+            return;
+
+        clapNoteMidi.addEvent (juce::MidiMessage::noteOn (channel, key, velocity), sampleOffset);
+        if (note.note_id >= 0)
+        {
+            // A retriggered key takes over its previous ID's slot (the
+            // synthesiser tails that note off anyway), else a free slot, else
+            // the oldest entry goes
+            auto slot = clapNotes.size();
+            auto freeSlot = clapNotes.size();
+            for (size_t i = 0; i < clapNotes.size() && slot == clapNotes.size(); ++i)
+            {
+                const auto candidate = (nextClapNote + i) % clapNotes.size();
+                if (clapNotes[candidate].noteId >= 0 && clapNotes[candidate].channel == channel && clapNotes[candidate].key == key)
+                    slot = candidate;
+                else if (clapNotes[candidate].noteId < 0 && freeSlot == clapNotes.size())
+                    freeSlot = candidate;
+            }
+
+            if (slot == clapNotes.size())
+                slot = freeSlot < clapNotes.size() ? freeSlot : nextClapNote;
+
+            clapNotes[slot] = { note.note_id, channel, key };
+            nextClapNote = (slot + 1) % clapNotes.size();
+        }
+        return;
+    }
+
+    // A choke stops the voices straight away - as a voice event, MIDI has
+    // nothing for it. The note-off that goes with it keeps the synthesiser's
+    // idea of held keys right
+    const bool isChoke = type == CLAP_EVENT_NOTE_CHOKE;
+    if (isChoke && noteExpressionEvents.size() < noteExpressionEvents.capacity())
+    {
+        ControllerEvent event;
+        event.samplePosition = sampleOffset;
+        event.type = ControllerEvent::Type::choke;
+        event.channel = static_cast<juce::int8> (juce::jlimit (0, 16, channel));
+        event.key = static_cast<juce::int8> (juce::jlimit (-1, 127, key));
+        noteExpressionEvents.push_back (event);
+    }
+
+    // Wildcards release every note they match. Choked notes are gone, so
+    // their IDs are too
+    for (auto& known : clapNotes)
+    {
+        if (known.key >= 0 && (channel <= 0 || known.channel == channel) && (key < 0 || known.key == key))
+        {
+            if (channel <= 0 || key < 0)
+                clapNoteMidi.addEvent (juce::MidiMessage::noteOff (known.channel, known.key, velocity), sampleOffset);
+            if (isChoke)
+                known = {};
+        }
+    }
+
+    if (channel > 0 && key >= 0)
+        clapNoteMidi.addEvent (juce::MidiMessage::noteOff (channel, key, velocity), sampleOffset);
+}
+
+const PluginProcessor::ClapNote* PluginProcessor::findClapNote (int32_t noteId) const
+{
+    if (noteId < 0)
+        return nullptr;
+
+    for (const auto& known : clapNotes)
+        if (known.noteId == noteId)
+            return &known;
+
+    return nullptr;
+}
+
+void PluginProcessor::forgetEndedClapNotes()
+{
+    // Called after the voices rendered: an ID lives as long as a voice still
+    // plays its note, release included
+    for (auto& known : clapNotes)
+    {
+        if (known.noteId < 0)
+            continue;
+
+        bool sounding = false;
+        for (int i = 0; i < synth.getNumVoices() && ! sounding; ++i)
+        {
+            const auto* voice = synth.getVoice (i);
+            sounding = voice->getCurrentlyPlayingNote() == known.key && voice->isPlayingChannel (known.channel);
+        }
+
+        if (! sounding)
+            known = {};
+    }
+}
+
+void PluginProcessor::applyNoteModulation (ModDestination destination, float offset, int32_t noteId, int channel, int key)
+{
+    // Resolve the note ID to the note it was started as; CLAP channels are
+    // 0-15, -1 matches any channel or key
+    ControllerEvent event;
+    event.samplePosition = lastDirectEventOffset;
+    event.type = ControllerEvent::Type::noteModulation;
+    event.destination = static_cast<juce::uint8> (destination);
+    event.channel = static_cast<juce::int8> (juce::jlimit (0, 16, channel + 1));
+    event.key = static_cast<juce::int8> (juce::jlimit (-1, 127, key));
+    event.value = offset;
+
+    if (const auto* known = findClapNote (noteId))
+    {
+        event.channel = static_cast<juce::int8> (known->channel);
+        event.key = static_cast<juce::int8> (known->key);
+    }
+
+    // Without any note to go to it would reach every voice - that's the
+    // monophonic modulation's job, not this one's
+    if (event.channel == 0 && event.key < 0)
+        return;
+
+    if (noteExpressionEvents.size() < noteExpressionEvents.capacity())
+        noteExpressionEvents.push_back (event);
+}
+
+template <typename SampleType>
+void PluginProcessor::applyPresetFade (juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    const auto fadeLength = static_cast<float> (presetFade.fadeLength);
+
+    if (presetFade.stage == PresetFade::Stage::fadingOut)
+    {
+        const auto startGain = static_cast<float> (presetFade.samplesRemaining) / fadeLength;
+        presetFade.samplesRemaining -= numSamples;
+        const auto endGain = static_cast<float> (presetFade.samplesRemaining) / fadeLength;
+        buffer.applyGainRamp (startSample, numSamples, startGain, endGain);
+
+        // Silent now: swap in the new preset and fade back in
+        if (presetFade.samplesRemaining <= 0)
+        {
+            applyVoiceParameters (presetFade.pending);
+            presetFade.stage = PresetFade::Stage::fadingIn;
+            presetFade.samplesRemaining = presetFade.fadeLength;
+        }
+    }
+    else if (presetFade.stage == PresetFade::Stage::fadingIn)
+    {
+        const int rampLength = juce::jmin (numSamples, presetFade.samplesRemaining);
+        const auto startGain = 1.0f - static_cast<float> (presetFade.samplesRemaining) / fadeLength;
+        presetFade.samplesRemaining -= rampLength;
+        const auto endGain = 1.0f - static_cast<float> (presetFade.samplesRemaining) / fadeLength;
+        buffer.applyGainRamp (startSample, rampLength, startGain, endGain);
+
+        if (presetFade.samplesRemaining <= 0)
+            presetFade.stage = PresetFade::Stage::idle;
+    }
+}
+
+bool PluginProcessor::isAnyVoiceActive() const
+{
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (synth.getVoice (i)->isVoiceActive())
+            return true;
+
+    return false;
+}
+
+void PluginProcessor::pushPresetSwitch (const VoiceParameters& params)
+{
+    presetSwitchMailbox.push (params);
+}
+
+bool PluginProcessor::popPresetSwitch (VoiceParameters& params)
+{
+    return presetSwitchMailbox.pop (params);
+}
+
 //==============================================================================
 bool PluginProcessor::hasEditor() const
 {
@@ -471,89 +1304,305 @@ juce::AudioProcessorEditor* PluginProcessor::createEditor()
 //==============================================================================
 void PluginProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // Use APVTS to save state as XML
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    // Read the generation first: a change landing mid-serialisation bumps it
+    // again, so the next request re-serialises instead of keeping stale bytes
+    const auto generation = stateGeneration.load (std::memory_order_acquire);
+
+    const juce::ScopedLock lock (cachedStateLock);
+
+    if (generation != cachedStateGeneration)
+    {
+        // Compact binary state: parameter values + current preset index, and
+        // whatever isn't a parameter in chunks after them
+        stateSerializer.write (cachedState, presetManager.getCurrentPresetIndex(), makeStateChunks());
+        cachedStateGeneration = generation;
+        ++numStateWrites;
+    }
+
+    destData = cachedState;
 }
 
 void PluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // Restore APVTS state from XML
+    if (StateSerializer::isBinaryState (data, sizeInBytes))
+    {
+        int presetIndex = 0;
+        std::vector<StateSerializer::Chunk> chunks;
+        const ScopedParameterWrite scopedWrite (parameterWriteSequence);
+
+        if (stateSerializer.read (data, sizeInBytes, presetIndex, &chunks))
+        {
+            presetManager.setCurrentPresetIndex (presetIndex);
+            currentPresetName = presetManager.getCurrentPresetName();
+            currentUserPresetFile = juce::File();
+            restoreStateChunks (chunks);
+            markStateDirty();
+        }
+
+        return;
+    }
+
+    // Legacy state: APVTS serialised as XML
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState != nullptr)
     {
         if (xmlState->hasTagName (apvts.state.getType()))
         {
+            // Voices pick the restored values up on the next audio block
+            const ScopedParameterWrite scopedWrite (parameterWriteSequence);
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
-            updateVoiceParameters();  // Update voices with restored parameters
         }
     }
 }
 
+std::vector<StateSerializer::Chunk> PluginProcessor::makeStateChunks() const
+{
+    std::vector<StateSerializer::Chunk> chunks;
+
+    // User preset: its file and name. The parameters already hold its values,
+    // the file is only there to show (and find) the preset again
+    if (currentUserPresetFile != juce::File())
+    {
+        StateSerializer::Chunk chunk { userPresetChunkTag, {} };
+        juce::MemoryOutputStream stream (chunk.data, false);
+        stream.writeString (currentUserPresetFile.getFullPathName());
+        stream.writeString (currentPresetName);
+        stream.flush();
+        chunks.push_back (std::move (chunk));
+    }
+
+    // Morph slots, pad Y and whether morphing is on (the X is a parameter)
+    {
+        StateSerializer::Chunk chunk { morphChunkTag, {} };
+        juce::MemoryOutputStream stream (chunk.data, false);
+        morphEngine.writeState (stream);
+        stream.flush();
+        chunks.push_back (std::move (chunk));
+    }
+
+    // Cabinet IR: its file and name. The IR is read from the file again on load
+    if (cabinetImpulseFile != juce::File())
+    {
+        StateSerializer::Chunk chunk { cabinetChunkTag, {} };
+        juce::MemoryOutputStream stream (chunk.data, false);
+        stream.writeString (cabinetImpulseFile.getFullPathName());
+        stream.writeString (cabinetImpulseName);
+        stream.flush();
+        chunks.push_back (std::move (chunk));
+    }
+
+    return chunks;
+}
+
+void PluginProcessor::restoreStateChunks (const std::vector<StateSerializer::Chunk>& chunks)
+{
+    bool morphRestored = false;
+    juce::File impulseFile;
+    juce::String impulseName;
+
+    for (const auto& chunk : chunks)
+    {
+        juce::MemoryInputStream stream (chunk.data, false);
+
+        if (chunk.tag == userPresetChunkTag)
+        {
+            const auto path = stream.readString();
+            const auto name = stream.readString();
+
+            // The file may be gone on this machine - the name still tells what was loaded
+            if (juce::File::isAbsolutePath (path))
+                currentUserPresetFile = juce::File (path);
+            if (name.isNotEmpty())
+                currentPresetName = name;
+        }
+        else if (chunk.tag == morphChunkTag)
+        {
+            morphRestored = morphEngine.readState (stream);
+        }
+        else if (chunk.tag == cabinetChunkTag)
+        {
+            const auto path = stream.readString();
+            impulseName = stream.readString();
+
+            if (juce::File::isAbsolutePath (path))
+                impulseFile = juce::File (path);
+        }
+    }
+
+    // Reading and transforming the IR belongs on the message thread - hosts
+    // that restore state elsewhere get it loaded there a moment later. Offline
+    // renderers (the render daemon) own the instance on their own thread and
+    // may not run a message loop, so they load it right away
+    if (isNonRealtime() || juce::MessageManager::existsAndIsCurrentThread())
+    {
+        restoreCabinetImpulse (impulseFile, impulseName);
+    }
+    else
+    {
+        juce::MessageManager::callAsync ([weakThis = juce::WeakReference<PluginProcessor> (this), impulseFile, impulseName] {
+            if (weakThis != nullptr)
+                weakThis->restoreCabinetImpulse (impulseFile, impulseName);
+        });
+    }
+
+    // A state saved without morph slots (or with a block this build can't
+    // read) leaves morphing off rather than keeping the previous session's
+    if (! morphRestored)
+    {
+        for (int slot = 0; slot < MorphEngine::maxSlots; ++slot)
+            morphEngine.clearSlot (slot);
+
+        morphEngine.setEnabled (false);
+        morphEngine.setPadY (0.0f);
+    }
+}
+
 //==============================================================================
 // Preset Management
 
 void PluginProcessor::loadPreset(const Preset& preset)
 {
-    // Load all parameters from preset
-    apvts.getParameter(SUB_MIX_ID)->setValueNotifyingHost(preset.subMix);
-    apvts.getParameter(SUB_OCTAVE_ID)->setValueNotifyingHost(preset.subOctave);
-
-    apvts.getParameter(FILTER_CUTOFF_ID)->setValueNotifyingHost(
-        apvts.getParameter(FILTER_CUTOFF_ID)->convertTo0to1(preset.filterCutoff));
-    apvts.getParameter(FILTER_RESONANCE_ID)->setValueNotifyingHost(preset.filterResonance);
-    apvts.getParameter(FILTER_KEY_TRACK_ID)->setValueNotifyingHost(preset.filterKeyTrack);
-
-    apvts.getParameter(FILTER_ENV_ATTACK_ID)->setValueNotifyingHost(
-        apvts.getParameter(FILTER_ENV_ATTACK_ID)->convertTo0to1(preset.filterEnvAttack));
-    apvts.getParameter(FILTER_ENV_DECAY_ID)->setValueNotifyingHost(
-        apvts.getParameter(FILTER_ENV_DECAY_ID)->convertTo0to1(preset.filterEnvDecay));
-    apvts.getParameter(FILTER_ENV_SUSTAIN_ID)->setValueNotifyingHost(preset.filterEnvSustain);
-    apvts.getParameter(FILTER_ENV_RELEASE_ID)->setValueNotifyingHost(
-        apvts.getParameter(FILTER_ENV_RELEASE_ID)->convertTo0to1(preset.filterEnvRelease));
-    apvts.getParameter(FILTER_ENV_AMOUNT_ID)->setValueNotifyingHost(preset.filterEnvAmount);
-
-    apvts.getParameter(AMP_ATTACK_ID)->setValueNotifyingHost(
-        apvts.getParameter(AMP_ATTACK_ID)->convertTo0to1(preset.ampAttack));
-    apvts.getParameter(AMP_DECAY_ID)->setValueNotifyingHost(
-        apvts.getParameter(AMP_DECAY_ID)->convertTo0to1(preset.ampDecay));
-    apvts.getParameter(AMP_SUSTAIN_ID)->setValueNotifyingHost(preset.ampSustain);
-    apvts.getParameter(AMP_RELEASE_ID)->setValueNotifyingHost(
-        apvts.getParameter(AMP_RELEASE_ID)->convertTo0to1(preset.ampRelease));
-
-    apvts.getParameter(LFO_RATE_ID)->setValueNotifyingHost(
-        apvts.getParameter(LFO_RATE_ID)->convertTo0to1(preset.lfoRate));
-    apvts.getParameter(LFO_AMOUNT_ID)->setValueNotifyingHost(preset.lfoAmount);
-
-    apvts.getParameter(VELOCITY_TO_FILTER_ID)->setValueNotifyingHost(preset.velocityToFilter);
-    apvts.getParameter(VELOCITY_TO_AMP_ID)->setValueNotifyingHost(preset.velocityToAmp);
-
-    apvts.getParameter(UNISON_VOICES_ID)->setValueNotifyingHost(
-        apvts.getParameter(UNISON_VOICES_ID)->convertTo0to1(preset.unisonVoices));
-    apvts.getParameter(UNISON_DETUNE_ID)->setValueNotifyingHost(preset.unisonDetune);
-
-    apvts.getParameter(DRIVE_AMOUNT_ID)->setValueNotifyingHost(preset.driveAmount);
-    apvts.getParameter(GLIDE_TIME_ID)->setValueNotifyingHost(
-        apvts.getParameter(GLIDE_TIME_ID)->convertTo0to1(preset.glideTime));
-
-    // Update voices with new parameters
-    updateVoiceParameters();
+    // Message thread only - this is the single producer of preset switches.
+    // Factory presets clear the user preset, loadUserPreset sets it afterwards
+    currentPresetName = preset.name;
+    currentUserPresetFile = juce::File();
+
+    // Target values for every parameter, in plain units
+    const std::pair<const char*, float> presetValues[] = {
+        { SUB_MIX_ID, preset.subMix },
+        { SUB_OCTAVE_ID, static_cast<float> (preset.subOctave) },
+        { FILTER_CUTOFF_ID, preset.filterCutoff },
+        { FILTER_RESONANCE_ID, preset.filterResonance },
+        { FILTER_KEY_TRACK_ID, preset.filterKeyTrack },
+        { FILTER_ENV_ATTACK_ID, preset.filterEnvAttack },
+        { FILTER_ENV_DECAY_ID, preset.filterEnvDecay },
+        { FILTER_ENV_SUSTAIN_ID, preset.filterEnvSustain },
+        { FILTER_ENV_RELEASE_ID, preset.filterEnvRelease },
+        { FILTER_ENV_AMOUNT_ID, preset.filterEnvAmount },
+        { AMP_ATTACK_ID, preset.ampAttack },
+        { AMP_DECAY_ID, preset.ampDecay },
+        { AMP_SUSTAIN_ID, preset.ampSustain },
+        { AMP_RELEASE_ID, preset.ampRelease },
+        { LFO_RATE_ID, preset.lfoRate },
+        { LFO_AMOUNT_ID, preset.lfoAmount },
+        { VELOCITY_TO_FILTER_ID, preset.velocityToFilter },
+        { VELOCITY_TO_AMP_ID, preset.velocityToAmp },
+        { UNISON_VOICES_ID, static_cast<float> (preset.unisonVoices) },
+        { UNISON_DETUNE_ID, preset.unisonDetune },
+        { DRIVE_AMOUNT_ID, preset.driveAmount },
+        { GLIDE_TIME_ID, preset.glideTime },
+    };
+
+    // Normalise once, so the snapshot holds exactly the (range-snapped) values
+    // the APVTS will report afterwards
+    std::array<std::pair<juce::RangedAudioParameter*, float>, std::size (presetValues)> targets;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        auto* parameter = apvts.getParameter (presetValues[i].first);
+        targets[i] = { parameter, parameter->convertTo0to1 (presetValues[i].second) };
+    }
+
+    // Parameters presets don't store (LFO 2, the matrix routes) keep their current values
+    const auto snapshot = makeVoiceParameters ([&] (const char* id) {
+        for (const auto& [parameter, normalised] : targets)
+            if (parameter->getParameterID() == id)
+                return parameter->convertFrom0to1 (normalised);
+
+        return apvts.getRawParameterValue (id)->load();
+    });
+
+    // Odd sequence = write in progress; the audio thread ignores the APVTS
+    // until it is even again, and uses the published snapshot instead
+    const ScopedParameterWrite scopedWrite (parameterWriteSequence);
+    pushPresetSwitch (snapshot);
+
+    // Notify the host as one gesture covering every parameter
+    for (auto& [parameter, normalised] : targets)
+        parameter->beginChangeGesture();
+
+    for (auto& [parameter, normalised] : targets)
+        if (! juce::approximatelyEqual (parameter->getValue(), normalised))
+            parameter->setValueNotifyingHost (normalised);
+
+    for (auto& [parameter, normalised] : targets)
+        parameter->endChangeGesture();
 }
 
 void PluginProcessor::nextPreset()
 {
     presetManager.nextPreset();
+    markStateDirty();
     loadPreset(presetManager.getCurrentPreset());
 }
 
 void PluginProcessor::previousPreset()
 {
     presetManager.previousPreset();
+    markStateDirty();
     loadPreset(presetManager.getCurrentPreset());
 }
 
+bool PluginProcessor::loadUserPreset (const juce::File& presetFile)
+{
+    // Full preset data is only parsed now - the library index holds metadata
+    if (auto preset = PresetLibrary::loadPreset (presetFile))
+    {
+        loadPreset (*preset);
+        currentUserPresetFile = presetFile;
+        markStateDirty();
+        return true;
+    }
+
+    return false;
+}
+
+bool PluginProcessor::loadCabinetImpulse (const juce::File& impulseFile)
+{
+    if (! cabinet.loadImpulseResponse (impulseFile))
+        return false;
+
+    cabinetImpulseFile = impulseFile;
+    cabinetImpulseName = cabinet.getImpulseName();
+    markStateDirty();
+    return true;
+}
+
+void PluginProcessor::restoreCabinetImpulse (const juce::File& impulseFile, const juce::String& impulseName)
+{
+    // A state without an IR clears the previous session's
+    if (impulseFile == juce::File())
+    {
+        cabinetImpulseFile = juce::File();
+        cabinetImpulseName.clear();
+        cabinet.clearImpulseResponse();
+        return;
+    }
+
+    // The file may be gone on this machine: keep the reference so saving the
+    // session again doesn't lose it, but leave the cabinet without an IR
+    cabinetImpulseFile = impulseFile;
+    cabinetImpulseName = impulseName;
+
+    if (! cabinet.loadImpulseResponse (impulseFile))
+        cabinet.clearImpulseResponse();
+}
+
+//==============================================================================
+// State Change Tracking
+
+void PluginProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+    // Can be called on the audio thread (host automation) - just bump the counter
+    juce::ignoreUnused (parameterIndex, newValue);
+    markStateDirty();
+}
+
+void PluginProcessor::parameterGestureChanged (int parameterIndex, bool gestureIsStarting)
+{
+    juce::ignoreUnused (parameterIndex, gestureIsStarting);
+}
+
 //==============================================================================
 // Waveform Visualizer Support
 
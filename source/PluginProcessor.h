@@ -1,7 +1,23 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <clap-juce-extensions/clap-juce-extensions.h>
+#include "BankSynthesiser.h"
+#include "FxRack.h"
+#include "GlobalModulation.h"
+#include "MidiControllerMap.h"
+#include "MorphEngine.h"
+#include "NoteModulatedParameter.h"
+#include "PartitionedConvolution.h"
+#include "PresetLibrary.h"
 #include "PresetManager.h"
+#include "PrerenderCache.h"
+#include "QualityGovernor.h"
+#include "QualityProfile.h"
+#include "SnapshotMailbox.h"
+#include "StateSerializer.h"
+#include "VoiceBank.h"
+#include "VoiceParameters.h"
 
 #if (MSVC)
 #include "ipps.h"
@@ -10,7 +26,10 @@
 // Forward declaration
 class SynthVoice;
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        public clap_juce_extensions::clap_juce_audio_processor_capabilities,
+                        private juce::AudioProcessorParameter::Listener,
+                        private NoteModulatedParameter::Target
 {
 public:
     PluginProcessor();
@@ -18,10 +37,16 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // The voices render natively in either precision, so 64-bit hosts skip
+    // the float conversion and offline renders keep double filter state
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -42,6 +67,14 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // CLAP note expressions (tuning, pressure, brightness) go straight to the
+    // voices playing the addressed note - called on the audio thread just
+    // before processBlock, with sample offsets into that block.
+    // CLAP notes arrive here too, so per-note modulation can find them by note ID
+    bool supportsNoteDialectClap (bool isInput) override { return isInput; }
+    bool supportsDirectEvent (uint16_t spaceId, uint16_t type) override;
+    void handleDirectEvent (const clap_event_header_t* event, int sampleOffset) override;
+
     // Public access to APVTS for GUI
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
@@ -57,7 +90,40 @@ public:
     void loadPreset(const Preset& preset);
     void nextPreset();
     void previousPreset();
-    juce::String getCurrentPresetName() const { return presetManager.getCurrentPresetName(); }
+    juce::String getCurrentPresetName() const { return currentPresetName; }
+
+    // Preset morphing (slots are set from the message thread)
+    MorphEngine& getMorphEngine() { return morphEngine; }
+    VoiceParameters captureVoiceParameters() const;
+
+    // MIDI CC / aftertouch routing and pitch bend range
+    MidiControllerMap& getControllerMap() { return controllerMap; }
+
+    // User preset library (shared by all instances, scanned in the background)
+    PresetLibrary& getPresetLibrary() { return *presetLibrary; }
+    bool loadUserPreset (const juce::File& presetFile);
+
+    // The user preset last loaded, none after a factory preset. Saved with the
+    // state, so a session reopens showing the preset it was left on
+    juce::File getCurrentUserPresetFile() const { return currentUserPresetFile; }
+
+    // Cabinet / DI body IR after the output stage (message thread). The file is
+    // saved with the state and loaded again when the session reopens
+    bool loadCabinetImpulse (const juce::File& impulseFile);
+    juce::File getCabinetImpulseFile() const { return cabinetImpulseFile; }
+    PartitionedConvolution& getCabinet() { return cabinet; }
+
+    // How often getStateInformation actually serialised, for tests
+    int getNumStateWrites() const { return numStateWrites; }
+
+    // What the voices were last given (after the governor's unison cap), for tests
+    const VoiceParameters& getAppliedVoiceParameters() const { return appliedParameters; }
+
+    // Pre-rendered notes, for tests and telemetry
+    const PrerenderCache& getPrerenderCache() const { return prerenderCache; }
+
+    // Block load and the quality level it led to, for the editor and telemetry
+    const QualityGovernor& getQualityGovernor() const { return qualityGovernor; }
 
     // Parameter IDs
     static constexpr const char* FILTER_CUTOFF_ID = "filterCutoff";
@@ -85,19 +151,178 @@ public:
     static constexpr const char* UNISON_DETUNE_ID = "unisonDetune";
     static constexpr const char* SUB_OCTAVE_ID = "subOctave";
 
+    // Morph position between preset slots A and B
+    static constexpr const char* MORPH_POSITION_ID = "morphPosition";
+
+    // MPE (lower zone) input
+    static constexpr const char* MPE_ENABLED_ID = "mpeEnabled";
+
+    // Filter and drive share one 2x oversampled pass (quality setting, not part of presets)
+    static constexpr const char* FILTER_OVERSAMPLING_ID = "filterOversampling";
+
+    // Static patches play notes from pre-rendered audio (quality setting, not part of presets)
+    static constexpr const char* NOTE_CACHE_ID = "noteCache";
+
+    // Lowers voice quality when blocks come close to their deadline (not part of presets)
+    static constexpr const char* AUTO_QUALITY_ID = "autoQuality";
+
+    // Modulation matrix: second LFO plus source / destination / amount per route
+    static constexpr const char* LFO2_RATE_ID = "lfo2Rate";
+
+    // LFOs per voice or shared by all voices, and LFO 1 tempo sync (global mode)
+    static constexpr const char* LFO_MODE_ID = "lfoMode";
+    static constexpr const char* LFO_SYNC_ID = "lfoSync";
+    static constexpr const char* MOD_SOURCE_IDS[] = { "mod1Source", "mod2Source", "mod3Source", "mod4Source" };
+    static constexpr const char* MOD_DESTINATION_IDS[] = { "mod1Destination", "mod2Destination", "mod3Destination", "mod4Destination" };
+    static constexpr const char* MOD_AMOUNT_IDS[] = { "mod1Amount", "mod2Amount", "mod3Amount", "mod4Amount" };
+    static_assert (std::size (MOD_SOURCE_IDS) == ModulationMatrix::numUserRoutes);
+
+    // Post-synth FX rack (not part of presets)
+    static constexpr const char* FX_EQ_ENABLED_ID = "fxEqEnabled";
+    static constexpr const char* FX_LOW_SHELF_ID = "fxLowShelf";
+    static constexpr const char* FX_TILT_ID = "fxTilt";
+    static constexpr const char* FX_COMP_ENABLED_ID = "fxCompEnabled";
+    static constexpr const char* FX_COMP_THRESHOLD_ID = "fxCompThreshold";
+    static constexpr const char* FX_COMP_RATIO_ID = "fxCompRatio";
+    static constexpr const char* FX_CHORUS_ENABLED_ID = "fxChorusEnabled";
+    static constexpr const char* FX_CHORUS_RATE_ID = "fxChorusRate";
+    static constexpr const char* FX_CHORUS_MIX_ID = "fxChorusMix";
+    static constexpr const char* FX_MONO_ENABLED_ID = "fxMonoEnabled";
+    static constexpr const char* FX_MONO_FREQUENCY_ID = "fxMonoFrequency";
+    static constexpr const char* CAB_ENABLED_ID = "cabEnabled";
+    static constexpr const char* CAB_MIX_ID = "cabMix";
+
 private:
     // Create APVTS parameter layout
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    // Update all voices with current parameter values
+    // Update all voices with current parameter values (audio thread)
     void updateVoiceParameters();
+    void applyVoiceParameters (const VoiceParameters& params);
+
+    // Preset switching: latest snapshot from the message thread + click-free fade
+    void pushPresetSwitch (const VoiceParameters& params);
+    bool popPresetSwitch (VoiceParameters& params);
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    template <typename SampleType>
+    void renderSynth (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages);
+    void prepareControllerEvents (const juce::MidiBuffer& midiMessages, int numSamples);
+    void prepareGlobalModulation (int numSamples);
+    bool updateFilterOversampling();
+    void updatePrerenderCache (bool filterOversampled);
+    void updateQualityGovernor (juce::int64 startTicks, int numSamples);
+
+    // Post-synth FX, one rack per precision (both prepared, the host's one runs)
+    FxSettings getFxSettings() const;
+    template <typename SampleType>
+    FxRack<SampleType>& getFxRack();
+    template <typename SampleType>
+    void processCabinet (juce::AudioBuffer<SampleType>& buffer);
+    juce::Optional<juce::AudioPlayHead::PositionInfo> getHostPosition() const;
+    template <typename SampleType>
+    void applyPresetFade (juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+    bool isAnyVoiceActive() const;
+
+    // Idle fast path: no voice sounding, no fade running and no MIDI arriving
+    bool isSilentBlock (const juce::MidiBuffer& midiMessages) const;
+    void processSilentBlock (int numSamples);
+
+    // Parameter change tracking for the cached state blob
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override;
+    void markStateDirty() { stateGeneration.fetch_add (1, std::memory_order_release); }
+
+    // State beyond the parameters, as tagged chunks after the parameter slots
+    static constexpr juce::uint32 userPresetChunkTag = StateSerializer::makeTag ("UPRE");
+    static constexpr juce::uint32 morphChunkTag = StateSerializer::makeTag ("MRPH");
+    static constexpr juce::uint32 cabinetChunkTag = StateSerializer::makeTag ("CABI");
+    std::vector<StateSerializer::Chunk> makeStateChunks() const;
+    void restoreStateChunks (const std::vector<StateSerializer::Chunk>& chunks);
 
     // AudioProcessorValueTreeState for parameter management
     juce::AudioProcessorValueTreeState apvts;
 
-    // Synthesizer
-    juce::Synthesiser synth;
+    // Compact binary plugin state (reads legacy XML state too)
+    StateSerializer stateSerializer;
+
+    // Last serialised state, reused while nothing has changed.
+    // The generation is bumped (lock-free) on every parameter/preset change,
+    // which may happen on the audio thread. Serialisation only ever happens in
+    // getStateInformation, on the host's calling thread
+    std::atomic<juce::uint32> stateGeneration { 1 };
+    juce::uint32 cachedStateGeneration = 0;
+    juce::MemoryBlock cachedState;
+    juce::CriticalSection cachedStateLock;
+    int numStateWrites = 0;
+
+    // Synthesizer. The bank holds the oscillator phases of every voice and
+    // steps them together, so it is declared first and outlives them
     static constexpr int NUM_VOICES = 8;  // Polyphony
+    VoiceBank voiceBank { NUM_VOICES };
+    PrerenderCache prerenderCache;  // voices hold its entries, so it outlives them too
+    BankSynthesiser synth { voiceBank };
+
+    // Controller data is split off the MIDI input and handed to the voices as
+    // timestamped events, so the synthesiser only splits blocks at notes
+    static constexpr int maxControllerEventsPerBlock = 4096;
+
+    // MidiBuffer stores every event as a sample position, a byte count and the
+    // message bytes, so reserving for N short messages takes N times this
+    static constexpr int midiBufferBytesPerEvent = static_cast<int> (sizeof (int32_t) + sizeof (uint16_t)) + 3;
+    MidiControllerMap controllerMap;
+    juce::MidiBuffer synthMidi;
+    std::vector<ControllerEvent> controllerEvents;
+    std::vector<ControllerEvent> noteExpressionEvents;  // CLAP, merged into controllerEvents
+
+    // CLAP notes, turned into MIDI for the synthesiser at the next processBlock.
+    // Note IDs are kept with their channel and key until no voice plays that
+    // note any more (past the note-off, the release can still be modulated)
+    struct ClapNote
+    {
+        int32_t noteId = -1;
+        int channel = 0;  // 1-16
+        int key = -1;
+    };
+    juce::MidiBuffer clapNoteMidi;
+    std::array<ClapNote, 64> clapNotes;
+    size_t nextClapNote = 0;
+    int lastDirectEventOffset = 0;  // parameter modulation comes without a timestamp
+
+    void handleClapNote (const clap_event_note_t& note, uint16_t type, int sampleOffset);
+    const ClapNote* findClapNote (int32_t noteId) const;
+    void forgetEndedClapNotes();
+    void applyNoteModulation (ModDestination destination, float offset, int32_t noteId, int channel, int key) override;
+
+    // Global mode LFOs, rendered once per block at the rates the voices were last given
+    GlobalModulation globalModulation;
+    float globalLfoRate = 2.0f;
+    float globalLfo2Rate = 0.5f;
+
+    // Release time the voices were last given, reported as the tail
+    std::atomic<float> appliedAmpRelease { VoiceParameters().ampRelease };
+
+    // Settings the voices were last given, which the note cache renders with
+    VoiceParameters appliedParameters;
+
+    // Per-block timing against the deadline; the level applies from the next block
+    QualityGovernor qualityGovernor;
+    QualityGovernor::Level qualityLevel = QualityGovernor::Level::full;
+
+    // Realtime or offline, from the host's render mode at the start of each
+    // block. Offline float blocks render through doublePrecisionBuffer
+    QualityProfile qualityProfile;
+    juce::AudioBuffer<double> doublePrecisionBuffer;
+
+    // Set once a silent block has zeroed the meter and the visualiser
+    bool outputSilent = false;
+
+    FxRack<float> fxRackFloat;
+    FxRack<double> fxRackDouble;
+
+    // Processes float and double blocks in place
+    PartitionedConvolution cabinet;
+    bool cabinetEnabled = false;
 
     // Output level metering (thread-safe)
     std::atomic<float> currentOutputLevel { 0.0f };
@@ -107,8 +332,47 @@ private:
     std::atomic<int> waveformBufferPos { 0 };
     static constexpr int waveformBufferSize = 2048;
 
+    // Preset switching (message thread -> audio thread, single producer/consumer).
+    // Latest wins: switches made while the host isn't processing collapse into
+    // the last one instead of filling up a queue
+    static constexpr double presetFadeSeconds = 0.005;  // 5ms out + 5ms in
+    SnapshotMailbox<VoiceParameters> presetSwitchMailbox;
+    std::atomic<juce::uint32> parameterWriteSequence { 0 };
+
+    // Marks a multi-parameter write from the message thread (sequence is odd while in scope)
+    struct ScopedParameterWrite
+    {
+        explicit ScopedParameterWrite (std::atomic<juce::uint32>& s) : sequence (s) { sequence.fetch_add (1, std::memory_order_acq_rel); }
+        ~ScopedParameterWrite() { sequence.fetch_add (1, std::memory_order_release); }
+        std::atomic<juce::uint32>& sequence;
+    };
+
+    struct PresetFade
+    {
+        enum class Stage { idle, fadingOut, fadingIn };
+        Stage stage = Stage::idle;
+        int samplesRemaining = 0;
+        int fadeLength = 1;
+        VoiceParameters pending;
+    };
+    PresetFade presetFade;
+
+    // Preset morphing - replaces the APVTS voice values while active
+    MorphEngine morphEngine;
+
     // Preset management
     PresetManager presetManager;
+    juce::SharedResourcePointer<PresetLibrary> presetLibrary;
+    juce::String currentPresetName;
+    juce::File currentUserPresetFile;
+
+    // Cabinet IR file and name as last loaded, kept for the state
+    juce::File cabinetImpulseFile;
+    juce::String cabinetImpulseName;
+
+    // Restores the cabinet IR from a state chunk, on the message thread
+    void restoreCabinetImpulse (const juce::File& impulseFile, const juce::String& impulseName);
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE (PluginProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
 };
@@ -0,0 +1,293 @@
+#include "PrerenderCache.h"
+#include "SynthVoice.h"
+
+PrerenderCache::PrerenderCache()
+    : juce::Thread ("Thicc Bass note cache")
+{
+}
+
+PrerenderCache::~PrerenderCache()
+{
+    stopThread (4000);
+
+    for (auto& slot : slots)
+        delete slot.exchange (nullptr);
+
+    collectRetired (true);
+}
+
+void PrerenderCache::prepare (double newSampleRate)
+{
+    // Entries are only good for the rate they were rendered at. The audio
+    // thread is stopped and the voices dropped their entries when they were prepared
+    stopThread (4000);
+
+    sampleRate = newSampleRate;
+    handoverLength = juce::jmax (1, juce::roundToInt (handoverSeconds * sampleRate));
+
+    for (auto& slot : slots)
+        delete slot.exchange (nullptr);
+
+    for (auto& flag : requested)
+        flag.store (false);
+
+    collectRetired (true);
+    numLiveEntries = 0;
+    wanted.fill (false);
+
+    // The next update() publishes the settings again under a new generation
+    settingsFifo.reset();
+    audioSettings = {};
+    audioSettings.generation = -1;
+    active = false;
+    settingsPending = false;
+    workerSettings = {};
+    workerGeneration.store (-1);
+
+    startThread (juce::Thread::Priority::low);
+}
+
+bool PrerenderCache::isSameSettings (const Settings& a, const VoiceParameters& params, bool filterOversampled, bool enabled)
+{
+    // VoiceParameters is all 4-byte fields, so there is no padding to compare
+    return a.generation >= 0
+        && a.enabled == enabled
+        && a.filterOversampled == filterOversampled
+        && std::memcmp (&a.params, &params, sizeof (VoiceParameters)) == 0;
+}
+
+bool PrerenderCache::update (bool enabled, const VoiceParameters& params, bool filterOversampled)
+{
+    bool invalidated = false;
+
+    if (! isSameSettings (audioSettings, params, filterOversampled, enabled))
+    {
+        audioSettings.params = params;
+        audioSettings.filterOversampled = filterOversampled;
+        audioSettings.enabled = enabled;
+        audioSettings.generation = generation.load (std::memory_order_relaxed) + 1;
+        generation.store (audioSettings.generation, std::memory_order_release);
+
+        active = enabled && isStatic (params);
+        settingsPending = true;
+        invalidated = true;
+    }
+
+    // Only the latest settings matter - if the worker is behind, try again next block
+    if (settingsPending)
+    {
+        const auto scope = settingsFifo.write (1);
+        if (scope.blockSize1 > 0)
+        {
+            settingsQueue[static_cast<size_t> (scope.startIndex1)] = audioSettings;
+            settingsPending = false;
+        }
+    }
+
+    blockEpoch.fetch_add (1, std::memory_order_release);
+    return invalidated;
+}
+
+int PrerenderCache::getSlot (int midiNote, float velocity) const
+{
+    const auto layer = isVelocitySensitive (audioSettings.params)
+                           ? juce::jlimit (0, numVelocityLayers - 1, static_cast<int> (velocity * numVelocityLayers))
+                           : 0;
+    return juce::jlimit (0, 127, midiNote) * numVelocityLayers + layer;
+}
+
+PrerenderCache::Entry* PrerenderCache::acquire (int midiNote, float velocity)
+{
+    const auto slot = static_cast<size_t> (getSlot (midiNote, velocity));
+    auto* entry = slots[slot].load (std::memory_order_acquire);
+
+    if (entry == nullptr || entry->generation != audioSettings.generation)
+    {
+        requested[slot].store (true, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    entry->users.fetch_add (1, std::memory_order_acq_rel);
+    numHits.fetch_add (1, std::memory_order_relaxed);
+    return entry;
+}
+
+bool PrerenderCache::isUpToDate() const
+{
+    if (workerGeneration.load (std::memory_order_acquire) != generation.load (std::memory_order_acquire))
+        return false;
+
+    return std::none_of (requested.begin(), requested.end(), [] (const auto& flag) { return flag.load (std::memory_order_acquire); });
+}
+
+bool PrerenderCache::isStatic (const VoiceParameters& params)
+{
+    // Free-running, random or note-to-note sources make every note different
+    if (params.lfoAmount > 0.0f || params.glideTime > 0.0f)
+        return false;
+
+    for (const auto& route : params.modRoutes)
+    {
+        if (juce::exactlyEqual (route.amount, 0.0f))
+            continue;
+
+        const auto source = static_cast<ModSource> (route.source);
+        if (source == ModSource::lfo1 || source == ModSource::lfo2 || source == ModSource::random)
+            return false;
+    }
+
+    return true;
+}
+
+bool PrerenderCache::isVelocitySensitive (const VoiceParameters& params)
+{
+    if (params.velocityToFilter > 0.0f || params.velocityToAmp > 0.0f)
+        return true;
+
+    return std::any_of (params.modRoutes.begin(), params.modRoutes.end(), [] (const ModulationRoute& route) {
+        return static_cast<ModSource> (route.source) == ModSource::velocity && ! juce::exactlyEqual (route.amount, 0.0f);
+    });
+}
+
+//==============================================================================
+void PrerenderCache::run()
+{
+    while (! threadShouldExit())
+    {
+        takeSettings();
+        renderRequestedEntries();
+        collectRetired (false);
+        wait (20);
+    }
+}
+
+void PrerenderCache::takeSettings()
+{
+    bool changed = false;
+
+    while (settingsFifo.getNumReady() > 0)
+    {
+        const auto scope = settingsFifo.read (1);
+        workerSettings = settingsQueue[static_cast<size_t> (scope.startIndex1)];
+        changed = true;
+    }
+
+    if (! changed)
+        return;
+
+    // Everything rendered so far is stale. The keys that were played get
+    // rendered again for the new settings
+    const auto sensitive = isVelocitySensitive (workerSettings.params);
+
+    for (size_t slot = 0; slot < slots.size(); ++slot)
+    {
+        if (auto* entry = slots[slot].load (std::memory_order_acquire); entry != nullptr && entry->generation != workerSettings.generation)
+        {
+            slots[slot].store (nullptr, std::memory_order_release);
+            retire (entry);
+        }
+
+        if (wanted[slot])
+        {
+            const auto layerSlot = sensitive ? slot : slot - slot % numVelocityLayers;
+            requested[layerSlot].store (true, std::memory_order_relaxed);
+        }
+    }
+
+    workerGeneration.store (workerSettings.generation, std::memory_order_release);
+}
+
+void PrerenderCache::renderRequestedEntries()
+{
+    const bool renderable = workerSettings.enabled && isStatic (workerSettings.params);
+
+    for (size_t slot = 0; slot < slots.size(); ++slot)
+    {
+        // Newer settings first
+        if (threadShouldExit() || settingsFifo.getNumReady() > 0)
+            return;
+
+        if (! requested[slot].load (std::memory_order_acquire))
+            continue;
+
+        wanted[slot] = true;
+
+        const auto* existing = slots[slot].load (std::memory_order_acquire);
+        const bool upToDate = existing != nullptr && existing->generation == workerSettings.generation;
+
+        // A full cache leaves further keys playing live
+        if (renderable && ! upToDate && numLiveEntries < maxEntries)
+        {
+            auto entry = renderEntry (static_cast<int> (slot));
+            if (settingsFifo.getNumReady() > 0)
+                return;
+
+            ++numLiveEntries;
+            if (auto* previous = slots[slot].exchange (entry.release(), std::memory_order_acq_rel))
+                retire (previous);
+        }
+
+        requested[slot].store (false, std::memory_order_release);
+    }
+}
+
+std::unique_ptr<PrerenderCache::Entry> PrerenderCache::renderEntry (int slot) const
+{
+    constexpr int blockSize = 512;
+
+    const auto note = slot / numVelocityLayers;
+    const auto layer = slot % numVelocityLayers;
+    const auto velocity = isVelocitySensitive (workerSettings.params) ? (static_cast<float> (layer) + 0.5f) / numVelocityLayers : 1.0f;
+
+    // A fresh voice, settled on the settings, the way a live voice meets a new note
+    VoiceBank bank { 1 };
+    bank.prepare (blockSize);
+    SynthVoice voice (bank, 0);
+    voice.setCurrentPlaybackSampleRate (sampleRate);
+    voice.prepareToPlay (sampleRate, blockSize, 1);
+    voice.setFilterOversampling (workerSettings.filterOversampled);
+    voice.setParameters (workerSettings.params);
+    voice.skipParameterSmoothing();
+    voice.startNote (note, velocity, nullptr, 8192);
+
+    const auto length = juce::roundToInt (cachedSeconds * sampleRate);
+    juce::AudioBuffer<float> buffer (1, length);
+    buffer.clear();
+
+    for (int start = 0; start < length; start += blockSize)
+        voice.renderNextBlock (buffer, start, juce::jmin (blockSize, length - start));
+
+    // A voice that died away renders exact zeros - keep only what it played
+    const auto* samples = buffer.getReadPointer (0);
+    auto end = length;
+    while (end > 0 && juce::exactlyEqual (samples[end - 1], 0.0f))
+        --end;
+
+    auto entry = std::make_unique<Entry>();
+    entry->complete = end < length - blockSize;
+    entry->samples.assign (samples, samples + (entry->complete ? end : length));
+    entry->generation = workerSettings.generation;
+    return entry;
+}
+
+void PrerenderCache::retire (Entry* entry)
+{
+    // Voices may still be reading it, and the audio thread may have just
+    // loaded the pointer - it's freed once two blocks have passed and no voice holds it
+    retired.push_back ({ entry, blockEpoch.load (std::memory_order_acquire) });
+    --numLiveEntries;
+}
+
+void PrerenderCache::collectRetired (bool force)
+{
+    const auto epoch = blockEpoch.load (std::memory_order_acquire);
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(), [force, epoch] (const RetiredEntry& r) {
+                       if (! force && (epoch - r.epoch < 2 || r.entry->users.load (std::memory_order_acquire) > 0))
+                           return false;
+
+                       delete r.entry;
+                       return true;
+                   }),
+        retired.end());
+}
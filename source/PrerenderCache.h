@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "VoiceParameters.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Pre-rendered notes for static patches
+//
+// A patch is static when nothing but the note and its velocity decides what a
+// voice renders: no LFO depth, no glide, and matrix routes only from the
+// envelopes, velocity, key or controllers (controllers have to be at rest
+// when a note starts). Every note of a velocity layer then sounds the same, so
+// a background thread renders it once through a private SynthVoice and voices
+// play the cached audio instead of running the oscillators, filter and drive.
+//
+// Entries are rendered on demand: the first note of a key/layer plays live and
+// requests its entry, later ones play from memory. When the settings change,
+// every entry goes stale at once and the worker re-renders the ones that were
+// in use, so a patch that is switched back and forth stays warm.
+//
+// A cached voice still runs its envelopes, and hands over to the live render
+// with a short crossfade at note-off, on the first controller change, or when
+// the cached length runs out.
+class PrerenderCache : private juce::Thread
+{
+public:
+    static constexpr int numVelocityLayers = 8;
+    static constexpr double cachedSeconds = 2.0;
+    static constexpr double handoverSeconds = 0.005;
+    static constexpr int maxEntries = 64;  // ~25 MB of audio at 48 kHz
+
+    struct Entry
+    {
+        std::vector<float> samples;  // mono, what the voice adds to every output channel
+        bool complete = false;       // the note died away within the render
+        int generation = 0;
+        std::atomic<int> users { 0 };  // voices still reading it
+    };
+
+    PrerenderCache();
+    ~PrerenderCache() override;
+
+    // === Message thread ===
+    void prepare (double sampleRate);
+
+    // === Audio thread ===
+    // Once per block before rendering. Returns true if the entries went stale
+    // (voices playing one should hand over to the live render)
+    bool update (bool enabled, const VoiceParameters& params, bool filterOversampled);
+
+    // Enabled, and the current settings are static
+    bool isActive() const { return active; }
+
+    // The entry for a note at this velocity, held until release(). On a miss
+    // the entry is requested and nullptr returned - the note plays live
+    Entry* acquire (int midiNote, float velocity);
+    static void release (Entry* entry) { entry->users.fetch_sub (1, std::memory_order_acq_rel); }
+
+    int getHandoverLength() const { return handoverLength; }
+
+    // Notes served from memory so far, for tests and telemetry
+    int getNumHits() const { return numHits.load (std::memory_order_relaxed); }
+
+    // True when every requested entry for the current settings is rendered
+    bool isUpToDate() const;
+
+    static bool isStatic (const VoiceParameters& params);
+    static bool isVelocitySensitive (const VoiceParameters& params);
+
+private:
+    struct Settings
+    {
+        VoiceParameters params;
+        bool filterOversampled = false;
+        bool enabled = false;
+        int generation = 0;
+    };
+
+    static constexpr int numSlots = 128 * numVelocityLayers;
+
+    int getSlot (int midiNote, float velocity) const;
+    static bool isSameSettings (const Settings& a, const VoiceParameters& params, bool filterOversampled, bool enabled);
+
+    void run() override;
+    void takeSettings();
+    void renderRequestedEntries();
+    std::unique_ptr<Entry> renderEntry (int slot) const;
+    void retire (Entry* entry);
+    void collectRetired (bool force);
+
+    double sampleRate = 44100.0;
+    int handoverLength = 240;
+
+    // Audio thread
+    Settings audioSettings;
+    bool active = false;
+    bool settingsPending = false;
+    std::atomic<int> generation { 0 };
+    std::atomic<juce::uint32> blockEpoch { 0 };
+    std::atomic<int> numHits { 0 };
+
+    // Audio thread -> worker
+    static constexpr int settingsQueueSize = 4;
+    juce::AbstractFifo settingsFifo { settingsQueueSize };
+    std::array<Settings, settingsQueueSize> settingsQueue;
+    std::array<std::atomic<bool>, numSlots> requested {};
+
+    // Published entries, read lock-free by the audio thread
+    std::array<std::atomic<Entry*>, numSlots> slots {};
+
+    // Worker
+    Settings workerSettings;
+    std::atomic<int> workerGeneration { -1 };
+    int numLiveEntries = 0;
+    std::array<bool, numSlots> wanted {};  // slots played under any settings, re-rendered on a change
+    struct RetiredEntry
+    {
+        Entry* entry;
+        juce::uint32 epoch;
+    };
+    std::vector<RetiredEntry> retired;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PrerenderCache)
+};
@@ -0,0 +1,345 @@
+#include "PresetLibrary.h"
+#include "PluginProcessor.h"
+
+namespace
+{
+    constexpr int presetFileVersion = 1;
+
+    juce::var presetToParameters (const Preset& preset)
+    {
+        auto* parameters = new juce::DynamicObject();
+
+        parameters->setProperty (PluginProcessor::SUB_MIX_ID, preset.subMix);
+        parameters->setProperty (PluginProcessor::SUB_OCTAVE_ID, preset.subOctave);
+        parameters->setProperty (PluginProcessor::FILTER_CUTOFF_ID, preset.filterCutoff);
+        parameters->setProperty (PluginProcessor::FILTER_RESONANCE_ID, preset.filterResonance);
+        parameters->setProperty (PluginProcessor::FILTER_KEY_TRACK_ID, preset.filterKeyTrack);
+        parameters->setProperty (PluginProcessor::FILTER_ENV_ATTACK_ID, preset.filterEnvAttack);
+        parameters->setProperty (PluginProcessor::FILTER_ENV_DECAY_ID, preset.filterEnvDecay);
+        parameters->setProperty (PluginProcessor::FILTER_ENV_SUSTAIN_ID, preset.filterEnvSustain);
+        parameters->setProperty (PluginProcessor::FILTER_ENV_RELEASE_ID, preset.filterEnvRelease);
+        parameters->setProperty (PluginProcessor::FILTER_ENV_AMOUNT_ID, preset.filterEnvAmount);
+        parameters->setProperty (PluginProcessor::AMP_ATTACK_ID, preset.ampAttack);
+        parameters->setProperty (PluginProcessor::AMP_DECAY_ID, preset.ampDecay);
+        parameters->setProperty (PluginProcessor::AMP_SUSTAIN_ID, preset.ampSustain);
+        parameters->setProperty (PluginProcessor::AMP_RELEASE_ID, preset.ampRelease);
+        parameters->setProperty (PluginProcessor::LFO_RATE_ID, preset.lfoRate);
+        parameters->setProperty (PluginProcessor::LFO_AMOUNT_ID, preset.lfoAmount);
+        parameters->setProperty (PluginProcessor::VELOCITY_TO_FILTER_ID, preset.velocityToFilter);
+        parameters->setProperty (PluginProcessor::VELOCITY_TO_AMP_ID, preset.velocityToAmp);
+        parameters->setProperty (PluginProcessor::UNISON_VOICES_ID, preset.unisonVoices);
+        parameters->setProperty (PluginProcessor::UNISON_DETUNE_ID, preset.unisonDetune);
+        parameters->setProperty (PluginProcessor::DRIVE_AMOUNT_ID, preset.driveAmount);
+        parameters->setProperty (PluginProcessor::GLIDE_TIME_ID, preset.glideTime);
+
+        return juce::var (parameters);
+    }
+
+    // Missing values fall back to the factory "init" sound (first factory preset)
+    Preset parametersToPreset (const juce::String& name, const juce::var& parameters)
+    {
+        static const PresetManager factory;
+        Preset preset = factory.getPresets().front();
+        preset.name = name;
+
+        auto getFloat = [&parameters] (const char* id, float& value) {
+            if (parameters.hasProperty (id))
+                value = static_cast<float> (parameters[id]);
+        };
+
+        auto getInt = [&parameters] (const char* id, int& value) {
+            if (parameters.hasProperty (id))
+                value = static_cast<int> (parameters[id]);
+        };
+
+        getFloat (PluginProcessor::SUB_MIX_ID, preset.subMix);
+        getInt (PluginProcessor::SUB_OCTAVE_ID, preset.subOctave);
+        getFloat (PluginProcessor::FILTER_CUTOFF_ID, preset.filterCutoff);
+        getFloat (PluginProcessor::FILTER_RESONANCE_ID, preset.filterResonance);
+        getFloat (PluginProcessor::FILTER_KEY_TRACK_ID, preset.filterKeyTrack);
+        getFloat (PluginProcessor::FILTER_ENV_ATTACK_ID, preset.filterEnvAttack);
+        getFloat (PluginProcessor::FILTER_ENV_DECAY_ID, preset.filterEnvDecay);
+        getFloat (PluginProcessor::FILTER_ENV_SUSTAIN_ID, preset.filterEnvSustain);
+        getFloat (PluginProcessor::FILTER_ENV_RELEASE_ID, preset.filterEnvRelease);
+        getFloat (PluginProcessor::FILTER_ENV_AMOUNT_ID, preset.filterEnvAmount);
+        getFloat (PluginProcessor::AMP_ATTACK_ID, preset.ampAttack);
+        getFloat (PluginProcessor::AMP_DECAY_ID, preset.ampDecay);
+        getFloat (PluginProcessor::AMP_SUSTAIN_ID, preset.ampSustain);
+        getFloat (PluginProcessor::AMP_RELEASE_ID, preset.ampRelease);
+        getFloat (PluginProcessor::LFO_RATE_ID, preset.lfoRate);
+        getFloat (PluginProcessor::LFO_AMOUNT_ID, preset.lfoAmount);
+        getFloat (PluginProcessor::VELOCITY_TO_FILTER_ID, preset.velocityToFilter);
+        getFloat (PluginProcessor::VELOCITY_TO_AMP_ID, preset.velocityToAmp);
+        getInt (PluginProcessor::UNISON_VOICES_ID, preset.unisonVoices);
+        getFloat (PluginProcessor::UNISON_DETUNE_ID, preset.unisonDetune);
+        getFloat (PluginProcessor::DRIVE_AMOUNT_ID, preset.driveAmount);
+        getFloat (PluginProcessor::GLIDE_TIME_ID, preset.glideTime);
+
+        return preset;
+    }
+}
+
+//==============================================================================
+PresetLibrary::PresetLibrary()
+    : juce::Thread ("Thicc Bass preset scanner"),
+      directory (getDefaultDirectory()),
+      index (std::make_shared<const Index>())
+{
+    // Scanning starts in the background - constructing the library never waits on disk
+    startThread (juce::Thread::Priority::background);
+}
+
+PresetLibrary::~PresetLibrary()
+{
+    stopThread (4000);
+}
+
+juce::File PresetLibrary::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+        .getChildFile ("ThiccBass")
+        .getChildFile ("Presets");
+}
+
+juce::File PresetLibrary::getDirectory() const
+{
+    const juce::ScopedLock lock (directoryLock);
+    return directory;
+}
+
+void PresetLibrary::setDirectory (const juce::File& newDirectory)
+{
+    {
+        const juce::ScopedLock lock (directoryLock);
+        directory = newDirectory;
+    }
+
+    rescan();
+}
+
+void PresetLibrary::rescan()
+{
+    notify();
+}
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::getIndex() const
+{
+    const juce::ScopedLock lock (indexLock);
+    return index;
+}
+
+void PresetLibrary::publish (std::shared_ptr<const Index> newIndex)
+{
+    {
+        const juce::ScopedLock lock (indexLock);
+        index = std::move (newIndex);
+    }
+
+    // Asynchronous - listeners are called back on the message thread
+    sendChangeMessage();
+}
+
+//==============================================================================
+void PresetLibrary::run()
+{
+    while (! threadShouldExit())
+    {
+        scanDirectory (getDirectory());
+        wait (rescanIntervalMs);
+    }
+}
+
+void PresetLibrary::scanDirectory (const juce::File& directoryToScan)
+{
+    scanning.store (true);
+
+    const auto previous = getIndex();
+
+    // Previous entries by path, so unchanged files aren't read again
+    std::unordered_map<juce::String, const Entry*> previousByPath;
+    previousByPath.reserve (previous->entries.size());
+    for (const auto& entry : previous->entries)
+        previousByPath.emplace (entry.file.getFullPathName(), &entry);
+
+    auto newIndex = std::make_shared<Index>();
+    newIndex->entries.reserve (previous->entries.size());
+    bool changed = false;
+
+    if (directoryToScan.isDirectory())
+    {
+        for (const auto& file : juce::RangedDirectoryIterator (directoryToScan, true, juce::String ("*") + fileExtension, juce::File::findFiles))
+        {
+            if (threadShouldExit())
+            {
+                scanning.store (false);
+                return;
+            }
+
+            const auto modificationTime = file.getModificationTime().toMilliseconds();
+            const auto fileSize = file.getFileSize();
+            const auto found = previousByPath.find (file.getFile().getFullPathName());
+
+            if (found != previousByPath.end()
+                && found->second->modificationTime == modificationTime
+                && found->second->fileSize == fileSize)
+            {
+                newIndex->entries.push_back (*found->second);
+                continue;
+            }
+
+            changed = true;
+
+            if (auto entry = readEntry (file.getFile()))
+            {
+                entry->modificationTime = modificationTime;
+                entry->fileSize = fileSize;
+                newIndex->entries.push_back (std::move (*entry));
+            }
+        }
+    }
+
+    // Files that disappeared also count as a change
+    changed = changed || newIndex->entries.size() != previous->entries.size();
+
+    if (changed)
+    {
+        std::sort (newIndex->entries.begin(), newIndex->entries.end(), [] (const Entry& a, const Entry& b) {
+            return a.sortKey < b.sortKey;
+        });
+
+        for (size_t i = 0; i < newIndex->entries.size(); ++i)
+            for (const auto& tag : newIndex->entries[i].tags)
+                newIndex->entriesByTag[tag].push_back (i);
+
+        publish (std::move (newIndex));
+    }
+
+    scanning.store (false);
+}
+
+std::optional<PresetLibrary::Entry> PresetLibrary::readEntry (const juce::File& file)
+{
+    const auto json = juce::JSON::parse (file);
+
+    if (! json.isObject())
+        return std::nullopt;
+
+    Entry entry;
+    entry.file = file;
+    entry.name = json.getProperty ("name", file.getFileNameWithoutExtension()).toString();
+    entry.sortKey = entry.name.toLowerCase();
+    entry.author = json.getProperty ("author", {}).toString();
+
+    if (auto* tags = json.getProperty ("tags", {}).getArray())
+        for (const auto& tag : *tags)
+            entry.tags.addIfNotAlreadyThere (tag.toString().trim().toLowerCase());
+
+    const auto parameters = json.getProperty ("parameters", {});
+    entry.filterCutoff = static_cast<float> (parameters.getProperty (PluginProcessor::FILTER_CUTOFF_ID, 1000.0f));
+    entry.driveAmount = static_cast<float> (parameters.getProperty (PluginProcessor::DRIVE_AMOUNT_ID, 0.0f));
+    entry.subMix = static_cast<float> (parameters.getProperty (PluginProcessor::SUB_MIX_ID, 0.5f));
+    entry.unisonVoices = static_cast<int> (parameters.getProperty (PluginProcessor::UNISON_VOICES_ID, 1));
+
+    return entry;
+}
+
+//==============================================================================
+std::vector<PresetLibrary::Entry> PresetLibrary::search (const juce::String& query, int maxResults) const
+{
+    const auto snapshot = getIndex();
+    const auto& entries = snapshot->entries;
+
+    juce::String namePrefix;
+    juce::StringArray requiredTags;
+
+    for (const auto& word : juce::StringArray::fromTokens (query.toLowerCase(), true))
+    {
+        if (word.startsWithChar ('#'))
+            requiredTags.add (word.substring (1));
+        else
+            namePrefix << (namePrefix.isEmpty() ? "" : " ") << word;
+    }
+
+    auto hasAllTags = [&requiredTags] (const Entry& entry) {
+        for (const auto& tag : requiredTags)
+            if (! entry.tags.contains (tag))
+                return false;
+        return true;
+    };
+
+    std::vector<Entry> results;
+
+    if (namePrefix.isEmpty() && ! requiredTags.isEmpty())
+    {
+        // Tag-only query: walk the (already name-ordered) positions of the first tag
+        const auto found = snapshot->entriesByTag.find (requiredTags[0]);
+        if (found == snapshot->entriesByTag.end())
+            return results;
+
+        for (auto position : found->second)
+        {
+            if (static_cast<int> (results.size()) >= maxResults)
+                break;
+
+            if (hasAllTags (entries[position]))
+                results.push_back (entries[position]);
+        }
+
+        return results;
+    }
+
+    // Name prefix: binary search into the sorted index, then walk forward
+    auto it = std::lower_bound (entries.begin(), entries.end(), namePrefix, [] (const Entry& entry, const juce::String& key) {
+        return entry.sortKey < key;
+    });
+
+    for (; it != entries.end() && static_cast<int> (results.size()) < maxResults; ++it)
+    {
+        if (! it->sortKey.startsWith (namePrefix))
+            break;
+
+        if (hasAllTags (*it))
+            results.push_back (*it);
+    }
+
+    return results;
+}
+
+//==============================================================================
+std::optional<Preset> PresetLibrary::loadPreset (const juce::File& file)
+{
+    const auto json = juce::JSON::parse (file);
+
+    if (! json.isObject())
+        return std::nullopt;
+
+    const auto name = json.getProperty ("name", file.getFileNameWithoutExtension()).toString();
+    return parametersToPreset (name, json.getProperty ("parameters", {}));
+}
+
+bool PresetLibrary::savePreset (const Preset& preset, const juce::String& author, const juce::StringArray& tags)
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty ("version", presetFileVersion);
+    object->setProperty ("name", preset.name);
+    object->setProperty ("author", author);
+
+    juce::Array<juce::var> tagArray;
+    for (const auto& tag : tags)
+        tagArray.add (tag);
+    object->setProperty ("tags", tagArray);
+
+    object->setProperty ("parameters", presetToParameters (preset));
+
+    const auto targetDirectory = getDirectory();
+    if (! targetDirectory.createDirectory())
+        return false;
+
+    const auto file = targetDirectory.getChildFile (juce::File::createLegalFileName (preset.name) + fileExtension);
+
+    if (! file.replaceWithText (juce::JSON::toString (juce::var (object))))
+        return false;
+
+    rescan();
+    return true;
+}
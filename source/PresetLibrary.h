@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "PresetManager.h"
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+// User preset library
+//
+// A directory of preset files (JSON, ".thiccpreset") is scanned on a background
+// thread into a compact in-memory index. The index only holds metadata and a few
+// key parameters - the full preset is parsed when it is actually loaded.
+// Rescans are incremental: files whose size and modification time didn't change
+// keep their index entry without being read again.
+//
+// One library is shared by all plugin instances in the process
+// (use it through juce::SharedResourcePointer<PresetLibrary>).
+class PresetLibrary : public juce::ChangeBroadcaster,
+                      private juce::Thread
+{
+public:
+    struct Entry
+    {
+        juce::File file;
+        juce::String name;
+        juce::String sortKey;  // lower-case name, the index is sorted by this
+        juce::String author;
+        juce::StringArray tags;  // lower-case
+
+        juce::int64 modificationTime = 0;
+        juce::int64 fileSize = 0;
+
+        // Key parameters, so browsers can show a patch without loading it
+        float filterCutoff = 0.0f;
+        float driveAmount = 0.0f;
+        float subMix = 0.0f;
+        int unisonVoices = 1;
+    };
+
+    struct Index
+    {
+        std::vector<Entry> entries;                                  // sorted by sortKey
+        std::map<juce::String, std::vector<size_t>> entriesByTag;    // tag -> positions in entries
+    };
+
+    PresetLibrary();
+    ~PresetLibrary() override;
+
+    juce::File getDirectory() const;
+    void setDirectory (const juce::File& newDirectory);
+
+    // Wakes the scanner for an immediate (incremental) rescan
+    void rescan();
+    bool isScanning() const { return scanning.load(); }
+
+    // Immutable snapshot of the current index - cheap, never blocks on a scan
+    std::shared_ptr<const Index> getIndex() const;
+
+    // Space separated query: "#tag" words must all match, everything else is a
+    // case-insensitive name prefix. Results are in name order
+    std::vector<Entry> search (const juce::String& query, int maxResults) const;
+
+    // Full preset data, parsed on demand
+    static std::optional<Preset> loadPreset (const juce::File& file);
+
+    // Writes a preset file into the library directory and triggers a rescan
+    bool savePreset (const Preset& preset, const juce::String& author, const juce::StringArray& tags);
+
+    static juce::File getDefaultDirectory();
+    static constexpr const char* fileExtension = ".thiccpreset";
+
+private:
+    void run() override;
+    void scanDirectory (const juce::File& directory);
+    void publish (std::shared_ptr<const Index> newIndex);
+
+    static std::optional<Entry> readEntry (const juce::File& file);
+
+    static constexpr int rescanIntervalMs = 5000;
+
+    juce::File directory;
+    mutable juce::CriticalSection directoryLock;
+
+    std::shared_ptr<const Index> index;
+    mutable juce::CriticalSection indexLock;
+
+    std::atomic<bool> scanning { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetLibrary)
+};
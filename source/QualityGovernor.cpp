@@ -0,0 +1,87 @@
+#include "QualityGovernor.h"
+#include "VoiceBank.h"
+
+void QualityGovernor::prepare (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void QualityGovernor::reset()
+{
+    overloadedSeconds = 0.0;
+    calmSeconds = 0.0;
+    settleRemaining = 0.0;
+    smoothedLoad = 0.0f;
+    level.store (Level::full, std::memory_order_relaxed);
+    load.store (0.0f, std::memory_order_relaxed);
+}
+
+QualityGovernor::Level QualityGovernor::update (double processingSeconds, int numSamples, bool enabled)
+{
+    if (numSamples <= 0)
+        return getLevel();
+
+    // Load = share of the block's deadline spent processing it
+    const auto blockSeconds = numSamples / sampleRate;
+    const auto blockLoad = static_cast<float> (processingSeconds / blockSeconds);
+    const auto smoothing = static_cast<float> (1.0 - std::exp (-blockSeconds / smoothingSeconds));
+    smoothedLoad += (blockLoad - smoothedLoad) * smoothing;
+    load.store (smoothedLoad, std::memory_order_relaxed);
+
+    auto current = getLevel();
+
+    if (! enabled)
+    {
+        overloadedSeconds = 0.0;
+        calmSeconds = 0.0;
+        level.store (Level::full, std::memory_order_relaxed);
+        return Level::full;
+    }
+
+    overloadedSeconds = smoothedLoad > degradeLoad ? overloadedSeconds + blockSeconds : 0.0;
+    calmSeconds = smoothedLoad < recoverLoad ? calmSeconds + blockSeconds : 0.0;
+    settleRemaining = juce::jmax (0.0, settleRemaining - blockSeconds);
+
+    // A block past its deadline has already glitched - step down straight away
+    const bool overloaded = overloadedSeconds >= degradeSeconds || blockLoad > 1.0f;
+    if (overloaded && settleRemaining <= 0.0 && current != Level::minimal)
+    {
+        current = static_cast<Level> (static_cast<int> (current) + 1);
+        numDowngrades.fetch_add (1, std::memory_order_relaxed);
+        overloadedSeconds = 0.0;
+        settleRemaining = settleSeconds;
+    }
+    else if (calmSeconds >= recoverSeconds && current != Level::full)
+    {
+        current = static_cast<Level> (static_cast<int> (current) - 1);
+        calmSeconds = 0.0;
+    }
+
+    level.store (current, std::memory_order_relaxed);
+    return current;
+}
+
+juce::String QualityGovernor::getName (Level level)
+{
+    switch (level)
+    {
+        case Level::reduced: return "reduced";
+        case Level::low: return "low";
+        case Level::minimal: return "minimal";
+        case Level::full:
+        default: return "full";
+    }
+}
+
+int QualityGovernor::getMaxUnisonVoices (Level level)
+{
+    switch (level)
+    {
+        case Level::reduced: return 3;
+        case Level::low: return 2;
+        case Level::minimal: return 1;
+        case Level::full:
+        default: return VoiceBank::maxUnisonVoices;
+    }
+}
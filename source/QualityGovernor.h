@@ -0,0 +1,68 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+// Trades voice quality for CPU time when blocks come close to their deadline
+//
+// processBlock reports how long every block took against how long it lasts.
+// The load is smoothed over ~100 ms; once it stays above degradeLoad for
+// degradeSeconds (or a single block overruns its deadline) the level drops one
+// step, and the next step waits settleSeconds for the cheaper level to show in
+// the load. It only climbs back one step after the load stayed below
+// recoverLoad for recoverSeconds, so a patch sitting near the limit doesn't
+// flip back and forth every few blocks.
+//
+// The levels, cheapest last:
+//  - full: everything as set
+//  - reduced: HQ filter off, unison capped at 3 voices
+//  - low: drive at the base rate instead of 2x, unison capped at 2
+//  - minimal: one saw per voice, release tails below -36 dB fade out in 5 ms
+//
+// The filter and drive settings only reach notes that start after the change;
+// notes already sounding keep theirs, so a step never clicks.
+class QualityGovernor
+{
+public:
+    enum class Level { full, reduced, low, minimal };
+
+    static constexpr float degradeLoad = 0.8f;
+    static constexpr float recoverLoad = 0.5f;
+    static constexpr double degradeSeconds = 0.05;
+    static constexpr double recoverSeconds = 2.0;
+    static constexpr double settleSeconds = 0.25;
+    static constexpr double smoothingSeconds = 0.1;
+    static constexpr float quietTailLevel = 0.0158f;  // -36 dB
+
+    void prepare (double newSampleRate);
+    void reset();
+
+    // Audio thread, after every block: the time it took to process
+    // numSamples. When disabled the level stays at full and only the load is
+    // tracked. Returns the level for the next block
+    Level update (double processingSeconds, int numSamples, bool enabled);
+
+    // Any thread, for the editor and telemetry
+    Level getLevel() const { return level.load (std::memory_order_relaxed); }
+    float getLoad() const { return load.load (std::memory_order_relaxed); }
+    int getNumDowngrades() const { return numDowngrades.load (std::memory_order_relaxed); }
+
+    static juce::String getName (Level level);
+
+    // What each level keeps
+    static int getMaxUnisonVoices (Level level);
+    static bool allowsHqFilter (Level level) { return level == Level::full; }
+    static bool allowsDriveOversampling (Level level) { return level < Level::low; }
+    static bool cutsQuietTails (Level level) { return level == Level::minimal; }
+
+private:
+    double sampleRate = 44100.0;
+    double overloadedSeconds = 0.0;
+    double calmSeconds = 0.0;
+    double settleRemaining = 0.0;
+    float smoothedLoad = 0.0f;
+
+    std::atomic<Level> level { Level::full };
+    std::atomic<float> load { 0.0f };
+    std::atomic<int> numDowngrades { 0 };
+};
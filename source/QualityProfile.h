@@ -0,0 +1,22 @@
+#pragma once
+
+// What the synth spends on sound quality, picked by the host's render mode
+//
+// Realtime playback keeps the user's settings (and the quality governor may
+// trade them down further). Bounces and exports - isNonRealtime() - have no
+// deadline, so they get the expensive path. Every object behind a profile is
+// prepared in prepareToPlay: switching only flips flags on the audio thread.
+struct QualityProfile
+{
+    bool hqFilter = false;               // filter inside the oversampled pass, whatever the HQ toggle says
+    bool fourTimesOversampling = false;  // filter and drive at 4x instead of 2x
+    bool doublePrecision = false;        // float hosts are rendered through the double path
+    bool noteCache = true;               // pre-rendered notes may stand in for live voices
+
+    static QualityProfile realtime() { return {}; }
+    static QualityProfile offline() { return { true, true, true, false }; }
+
+    static QualityProfile forRenderMode (bool nonRealtime) { return nonRealtime ? offline() : realtime(); }
+
+    bool operator== (const QualityProfile&) const = default;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Hands the newest value from one writer thread to one reader thread
+//
+// A triple buffer: the writer fills a slot of its own and swaps it in as the
+// latest, the reader swaps the latest out for a slot of its own. Neither side
+// waits or allocates, and nothing is ever dropped in favour of something
+// older - a value pushed while the reader is away replaces the one before it.
+template <typename ValueType>
+class SnapshotMailbox
+{
+public:
+    // === Writer thread ===
+    void push (const ValueType& value)
+    {
+        slots[static_cast<size_t> (writeSlot)] = value;
+        writeSlot = latest.exchange (writeSlot | hasNewValue, std::memory_order_acq_rel) & slotMask;
+    }
+
+    // === Reader thread ===
+    // The newest value pushed since the last pop, if any
+    bool pop (ValueType& value)
+    {
+        if ((latest.load (std::memory_order_acquire) & hasNewValue) == 0)
+            return false;
+
+        readSlot = latest.exchange (readSlot, std::memory_order_acq_rel) & slotMask;
+        value = slots[static_cast<size_t> (readSlot)];
+        return true;
+    }
+
+private:
+    static constexpr int slotMask = 3;
+    static constexpr int hasNewValue = 4;
+
+    std::array<ValueType, 3> slots {};
+    std::atomic<int> latest { 1 };  // slot index, plus hasNewValue until the reader took it
+    int writeSlot = 0;
+    int readSlot = 2;
+};
@@ -0,0 +1,170 @@
+#include "StateSerializer.h"
+
+StateSerializer::StateSerializer (juce::AudioProcessorValueTreeState& apvts)
+{
+    // Build the slot table once - reading and writing then never touch strings
+    for (auto* p : apvts.processor.getParameters())
+    {
+        if (auto* parameter = dynamic_cast<juce::RangedAudioParameter*> (p))
+        {
+            const auto hash = hashParameterID (parameter->getParameterID());
+
+            // Two IDs hashing to the same slot would make blobs ambiguous
+            jassert (std::none_of (slots.begin(), slots.end(), [hash] (const Slot& s) { return s.hash == hash; }));
+
+            slots.push_back ({ hash, parameter });
+        }
+    }
+}
+
+juce::uint32 StateSerializer::hashParameterID (const juce::String& parameterID)
+{
+    // 32-bit FNV-1a over the UTF-8 bytes
+    juce::uint32 hash = 2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8> (*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+bool StateSerializer::isBinaryState (const void* data, int sizeInBytes)
+{
+    return data != nullptr
+        && sizeInBytes >= headerSize
+        && juce::ByteOrder::littleEndianInt (data) == magicNumber;
+}
+
+void StateSerializer::write (juce::MemoryBlock& destData, int presetIndex, const std::vector<Chunk>& chunks) const
+{
+    auto size = static_cast<size_t> (headerSize + slotSize * static_cast<int> (slots.size()));
+    for (const auto& chunk : chunks)
+        size += chunkHeaderSize + chunk.data.getSize();
+
+    destData.setSize (size);
+    juce::MemoryOutputStream stream (destData, false);
+
+    stream.writeInt (static_cast<int> (magicNumber));
+    stream.writeShort (static_cast<short> (currentVersion));
+    stream.writeShort (static_cast<short> (slots.size()));
+    stream.writeInt (presetIndex);
+
+    for (const auto& slot : slots)
+    {
+        stream.writeInt (static_cast<int> (slot.hash));
+        stream.writeFloat (slot.parameter->convertFrom0to1 (slot.parameter->getValue()));
+    }
+
+    for (const auto& chunk : chunks)
+    {
+        stream.writeInt (static_cast<int> (chunk.tag));
+        stream.writeInt (static_cast<int> (chunk.data.getSize()));
+        stream.write (chunk.data.getData(), chunk.data.getSize());
+    }
+}
+
+void StateSerializer::readChunks (const char* bytes, int sizeInBytes, int offset, std::vector<Chunk>& chunks)
+{
+    chunks.clear();
+
+    while (offset + chunkHeaderSize <= sizeInBytes)
+    {
+        const auto tag = juce::ByteOrder::littleEndianInt (bytes + offset);
+        const auto size = static_cast<juce::int64> (juce::ByteOrder::littleEndianInt (bytes + offset + 4));
+        offset += chunkHeaderSize;
+
+        if (size > sizeInBytes - offset)
+            return;
+
+        chunks.push_back ({ tag, juce::MemoryBlock (bytes + offset, static_cast<size_t> (size)) });
+        offset += static_cast<int> (size);
+    }
+}
+
+bool StateSerializer::read (const void* data, int sizeInBytes, int& presetIndex, std::vector<Chunk>* chunks) const
+{
+    if (! isBinaryState (data, sizeInBytes))
+        return false;
+
+    auto* bytes = static_cast<const char*> (data);
+    const auto version = juce::ByteOrder::littleEndianShort (bytes + 4);
+    const auto numSlots = static_cast<int> (juce::ByteOrder::littleEndianShort (bytes + 6));
+
+    // Newer versions may change the layout - refuse rather than misread
+    if (version == 0 || version > currentVersion)
+        return false;
+
+    if (sizeInBytes < headerSize + numSlots * slotSize)
+        return false;
+
+    presetIndex = static_cast<int> (juce::ByteOrder::littleEndianInt (bytes + 8));
+
+    if (chunks != nullptr)
+        readChunks (bytes, sizeInBytes, headerSize + numSlots * slotSize, *chunks);
+
+    auto readSlot = [bytes] (int index, juce::uint32& hash, float& value) {
+        auto* slotData = bytes + headerSize + index * slotSize;
+        hash = juce::ByteOrder::littleEndianInt (slotData);
+        const auto valueBits = juce::ByteOrder::littleEndianInt (slotData + 4);
+        std::memcpy (&value, &valueBits, sizeof (float));
+    };
+
+    // Fast path: blob written by this build, slots line up one to one
+    bool slotsMatch = numSlots == static_cast<int> (slots.size());
+
+    for (int i = 0; slotsMatch && i < numSlots; ++i)
+    {
+        juce::uint32 hash;
+        float value;
+        readSlot (i, hash, value);
+        slotsMatch = hash == slots[static_cast<size_t> (i)].hash;
+    }
+
+    if (slotsMatch)
+    {
+        for (int i = 0; i < numSlots; ++i)
+        {
+            juce::uint32 hash;
+            float value;
+            readSlot (i, hash, value);
+            applyValue (*slots[static_cast<size_t> (i)].parameter, value);
+        }
+
+        return true;
+    }
+
+    // Slow path: different parameter set - match by hash, defaults for the rest
+    for (const auto& slot : slots)
+    {
+        float restoredValue = slot.parameter->convertFrom0to1 (slot.parameter->getDefaultValue());
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            juce::uint32 hash;
+            float value;
+            readSlot (i, hash, value);
+
+            if (hash == slot.hash)
+            {
+                restoredValue = value;
+                break;
+            }
+        }
+
+        applyValue (*slot.parameter, restoredValue);
+    }
+
+    return true;
+}
+
+void StateSerializer::applyValue (juce::RangedAudioParameter& parameter, float value)
+{
+    const auto normalised = parameter.convertTo0to1 (value);
+
+    // Skip untouched parameters so the host isn't notified about them
+    if (! juce::approximatelyEqual (normalised, parameter.getValue()))
+        parameter.setValueNotifyingHost (normalised);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <vector>
+
+// Compact, versioned binary plugin state
+//
+// Layout (little endian):
+//   uint32 magic "TBS1" | uint16 version | uint16 numSlots | int32 presetIndex
+//   numSlots x { uint32 parameterIdHash, float value }
+//   optional chunks: { uint32 tag, uint32 size, size bytes } up to the end
+//
+// Parameter IDs are hashed (FNV-1a) into fixed slots, so a blob stays readable
+// when parameters are added or reordered. Values are stored denormalised,
+// the same as the legacy XML state.
+// State that isn't a parameter (user preset, morph slots) goes into tagged
+// chunks after the slots. Readers skip tags they don't know, and builds from
+// before the chunks existed stop reading at the last slot, so the version
+// stays at 1.
+class StateSerializer
+{
+public:
+    explicit StateSerializer (juce::AudioProcessorValueTreeState& apvts);
+
+    struct Chunk
+    {
+        juce::uint32 tag = 0;
+        juce::MemoryBlock data;
+    };
+
+    // Serialises every parameter plus the preset index and chunks into destData
+    void write (juce::MemoryBlock& destData, int presetIndex, const std::vector<Chunk>& chunks = {}) const;
+
+    // Restores parameters from a binary blob. Returns false (and leaves the
+    // parameters untouched) if the data isn't a valid binary state. The chunks
+    // found after the slots are handed back; a truncated one ends the list
+    bool read (const void* data, int sizeInBytes, int& presetIndex, std::vector<Chunk>* chunks = nullptr) const;
+
+    // Chunk tags, four characters read little endian
+    static constexpr juce::uint32 makeTag (const char (&name)[5])
+    {
+        return static_cast<juce::uint32> (name[0]) | (static_cast<juce::uint32> (name[1]) << 8)
+             | (static_cast<juce::uint32> (name[2]) << 16) | (static_cast<juce::uint32> (name[3]) << 24);
+    }
+
+    // True if the data starts with the binary state header (legacy XML doesn't)
+    static bool isBinaryState (const void* data, int sizeInBytes);
+
+    static juce::uint32 hashParameterID (const juce::String& parameterID);
+
+    static constexpr juce::uint32 magicNumber = 0x31534254;  // "TBS1"
+    static constexpr juce::uint16 currentVersion = 1;
+
+private:
+    struct Slot
+    {
+        juce::uint32 hash;
+        juce::RangedAudioParameter* parameter;
+    };
+
+    static constexpr int headerSize = 12;
+    static constexpr int slotSize = 8;
+    static constexpr int chunkHeaderSize = 8;
+
+    static void readChunks (const char* bytes, int sizeInBytes, int offset, std::vector<Chunk>& chunks);
+
+    static void applyValue (juce::RangedAudioParameter& parameter, float value);
+
+    std::vector<Slot> slots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StateSerializer)
+};
@@ -1,10 +1,49 @@
 #include "SynthVoice.h"
 
-SynthVoice::SynthVoice()
-    : oversampling (2, 1, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR)  // 2x oversampling, 1 channel
+namespace
 {
-    // Initialize filter to lowpass mode
-    filter.setMode (juce::dsp::LadderFilter<float>::Mode::LPF24);
+    ModSource toModSource (ControllerSource source)
+    {
+        switch (source)
+        {
+            case ControllerSource::modWheel:   return ModSource::modWheel;
+            case ControllerSource::aftertouch: return ModSource::aftertouch;
+            case ControllerSource::timbre:     return ModSource::timbre;
+            case ControllerSource::none:
+            case ControllerSource::numSources:
+            default:                           return ModSource::none;
+        }
+    }
+}
+
+template <typename SampleType>
+SynthVoice::SignalPath<SampleType>::SignalPath()
+    : oversampling (2, 1, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR),  // 2x oversampling, 1 channel
+      fourTimesOversampling (2, 2, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR)
+{
+    // Initialize filters to lowpass mode - all three, so the oversampled
+    // ladders sound like the base-rate one
+    for (auto* ladder : { &filter, &oversampledFilter, &fourTimesFilter })
+        ladder->setMode (juce::dsp::LadderFilter<SampleType>::Mode::LPF24);
+}
+
+template <>
+SynthVoice::SignalPath<float>& SynthVoice::getSignalPath<float>()
+{
+    return floatPath;
+}
+
+template <>
+SynthVoice::SignalPath<double>& SynthVoice::getSignalPath<double>()
+{
+    return doublePath;
+}
+
+SynthVoice::SynthVoice (VoiceBank& voiceBank, int index)
+    : bank (voiceBank),
+      bankIndex (index)
+{
+    jassert (juce::isPositiveAndBelow (bankIndex, bank.getNumVoices()));
 
     // Set default amp envelope parameters (these will be overridden by parameters)
     ampEnvParams.attack = 0.01f;   // 10ms attack
@@ -30,6 +69,8 @@ void SynthVoice::startNote (int midiNoteNumber, float velocity,
                            juce::SynthesiserSound* sound,
                            int currentPitchWheelPosition)
 {
+    // The pitch wheel is tracked through controller events, also while the
+    // voice is idle, so the synthesiser's wheel position isn't needed
     juce::ignoreUnused (sound, currentPitchWheelPosition);
 
     currentMidiNote = midiNoteNumber;
@@ -38,17 +79,30 @@ void SynthVoice::startNote (int midiNoteNumber, float velocity,
     // Update oscillator frequency based on MIDI note
     updateFrequency();
 
-    // Reset phase to avoid clicks
-    phase = 0.0;
-    subPhase = 0.0;
+    // Reset the saw, unison and sub phases to avoid clicks
+    bank.resetVoice (bankIndex);
+
+    // Per-note expression starts from the note's MPE channel state, host
+    // modulation of the previous note doesn't carry over
+    startNoteExpression();
+    resetNoteModulation();
+
+    // Per-note matrix sources: velocity and key are bipolar around 64 / C4
+    modulationMatrix.setConstantSource (ModSource::velocity, (velocity - 0.5f) * 2.0f);
+    modulationMatrix.setConstantSource (ModSource::key, static_cast<float> (midiNoteNumber - 60) / 64.0f);
+    modulationMatrix.setConstantSource (ModSource::random, random.nextFloat() * 2.0f - 1.0f);
 
-    // Phase 3: Reset unison oscillator phases
-    for (auto& uniPhase : unisonPhases)
-        uniPhase = 0.0;
+    // Cached notes were rendered from silence, a retrigger mid-release isn't.
+    // Oversampling changes wait for a note like that too
+    const bool wasIdle = ! ampEnvelope.isActive();
+    if (wasIdle)
+        applyOversamplingSettings();
 
     // Trigger envelopes
     ampEnvelope.noteOn();
     filterEnvelope.noteOn();
+
+    startCachedPlayback (wasIdle);
 }
 
 void SynthVoice::stopNote (float velocity, bool allowTailOff)
@@ -57,9 +111,11 @@ void SynthVoice::stopNote (float velocity, bool allowTailOff)
 
     if (allowTailOff)
     {
-        // Let the envelopes tail off naturally
+        // Let the envelopes tail off naturally. The cached audio is of a held
+        // note, so the release is rendered live
         ampEnvelope.noteOff();
         filterEnvelope.noteOff();
+        stopCachedPlayback();
     }
     else
     {
@@ -67,33 +123,338 @@ void SynthVoice::stopNote (float velocity, bool allowTailOff)
         clearCurrentNote();
         ampEnvelope.reset();
         filterEnvelope.reset();
+        releaseCachedEntry();
     }
 }
 
+// The processor normally hands controller data over as timestamped events
+// (see setControllerEvents), so these only see what reaches juce::Synthesiser
+// directly. They go through the same routing either way
+
 void SynthVoice::pitchWheelMoved (int newPitchWheelValue)
 {
-    juce::ignoreUnused (newPitchWheelValue);
-    // TODO: Implement pitch bend in Phase 2
+    ControllerEvent event;
+    if (controllerMap != nullptr && controllerMap->toEvent (juce::MidiMessage::pitchWheel (1, newPitchWheelValue), 0, event))
+        applyControllerEvent (event, isVoiceActive());
 }
 
 void SynthVoice::controllerMoved (int controllerNumber, int newControllerValue)
 {
-    juce::ignoreUnused (controllerNumber, newControllerValue);
-    // TODO: Implement MIDI CC in Phase 2
+    ControllerEvent event;
+    if (controllerMap != nullptr && controllerMap->toEvent (juce::MidiMessage::controllerEvent (1, controllerNumber, newControllerValue), 0, event))
+        applyControllerEvent (event, isVoiceActive());
+}
+
+void SynthVoice::channelPressureChanged (int newChannelPressureValue)
+{
+    ControllerEvent event;
+    if (controllerMap != nullptr && controllerMap->toEvent (juce::MidiMessage::channelPressureChange (1, newChannelPressureValue), 0, event))
+        applyControllerEvent (event, isVoiceActive());
+}
+
+void SynthVoice::setControllerEvents (const ControllerEvent* events, int numEvents)
+{
+    controllerEvents = events;
+    numControllerEvents = numEvents;
+    nextControllerEvent = 0;
+}
+
+void SynthVoice::setGlobalModulation (const float* lfo1, const float* lfo2)
+{
+    globalLfo1 = lfo1;
+    globalLfo2 = lfo2;
+}
+
+void SynthVoice::applyControllerEvent (const ControllerEvent& event, bool smooth)
+{
+    auto setValue = [smooth] (auto& smoother, auto value) {
+        if (smooth)
+            smoother.setTargetValue (value);
+        else
+            smoother.setCurrentAndTargetValue (value);
+    };
+
+    const bool isChannelWide = event.channel == 0 && event.key < 0;
+
+    // Per-note events only reach the voice playing that note. Every voice keeps
+    // the MPE channel state though, so a note starts from what was sent before it
+    if (! isChannelWide)
+    {
+        rememberChannelExpression (event);
+        if (! isPlayingNoteFor (event))
+            return;
+    }
+
+    switch (event.type)
+    {
+        case ControllerEvent::Type::pitchBend:
+            setValue (pitchBendRatio, static_cast<double> (event.value));
+            break;
+
+        case ControllerEvent::Type::notePitch:
+            setValue (notePitchRatio, static_cast<double> (event.value));
+            break;
+
+        case ControllerEvent::Type::resetAll:
+            if (isChannelWide)
+            {
+                setValue (pitchBendRatio, 1.0);
+                globalControllerValues.fill (0.0f);
+                channelExpressions.fill ({});
+            }
+
+            // Per-note values fall back to the channel-wide ones
+            setValue (notePitchRatio, 1.0);
+            for (size_t i = 0; i < controllerValues.size(); ++i)
+                setValue (controllerValues[i], globalControllerValues[i]);
+            break;
+
+        case ControllerEvent::Type::noteModulation:
+            if (const auto index = getNoteModulationIndex (static_cast<ModDestination> (event.destination)); index >= 0)
+            {
+                setValue (noteModulation[static_cast<size_t> (index)], event.value);
+                noteModulated = true;
+            }
+            break;
+
+        case ControllerEvent::Type::choke:
+            // No release tail; the cached audio is of a held note, so the
+            // fade is rendered live
+            if (ampEnvelope.isActive())
+            {
+                stopCachedPlayback();
+                ampEnvelope.fastRelease (chokeFadeSeconds);
+                filterEnvelope.noteOff();
+            }
+            break;
+
+        case ControllerEvent::Type::source:
+        default:
+            if (isChannelWide)
+                globalControllerValues[static_cast<size_t> (event.source)] = event.value;
+
+            setValue (getControllerValue (event.source), event.value);
+            break;
+    }
+}
+
+void SynthVoice::rememberChannelExpression (const ControllerEvent& event)
+{
+    // Only MPE member channel state outlives a note - key-addressed
+    // expressions belong to the note they were sent to
+    if (event.channel <= 0 || event.key >= 0)
+        return;
+
+    auto& expression = channelExpressions[static_cast<size_t> (event.channel)];
+
+    switch (event.type)
+    {
+        case ControllerEvent::Type::notePitch:
+            expression.pitchRatio = static_cast<double> (event.value);
+            break;
+
+        case ControllerEvent::Type::source:
+            expression.values[static_cast<size_t> (event.source)] = event.value;
+            expression.hasValue[static_cast<size_t> (event.source)] = true;
+            break;
+
+        case ControllerEvent::Type::resetAll:
+            expression = {};
+            break;
+
+        case ControllerEvent::Type::pitchBend:
+        default:
+            break;
+    }
+}
+
+bool SynthVoice::isPlayingNoteFor (const ControllerEvent& event) const
+{
+    const int note = getCurrentlyPlayingNote();
+    if (note < 0)
+        return false;
+
+    return (event.channel == 0 || isPlayingChannel (event.channel))
+           && (event.key < 0 || event.key == note);
+}
+
+void SynthVoice::startNoteExpression()
+{
+    int channel = 0;
+    for (int ch = 1; ch <= 16 && channel == 0; ++ch)
+        if (isPlayingChannel (ch))
+            channel = ch;
+
+    // Channel 0 is never written, so outside MPE this is the rest state
+    const auto& expression = channelExpressions[static_cast<size_t> (channel)];
+    notePitchRatio.setCurrentAndTargetValue (expression.pitchRatio);
+
+    for (size_t i = 0; i < controllerValues.size(); ++i)
+        controllerValues[i].setCurrentAndTargetValue (expression.hasValue[i] ? expression.values[i] : globalControllerValues[i]);
+}
+
+void SynthVoice::skipControllerEvents (int endSample)
+{
+    // Idle voices still follow the controllers, without ramps, so a note that
+    // starts later in the block begins from the current wheel positions
+    while (nextControllerEvent < numControllerEvents && controllerEvents[nextControllerEvent].samplePosition < endSample)
+        applyControllerEvent (controllerEvents[nextControllerEvent++], false);
+}
+
+juce::SmoothedValue<float>& SynthVoice::getControllerValue (ControllerSource source)
+{
+    jassert (source < ControllerSource::numSources);
+    return controllerValues[static_cast<size_t> (source)];
+}
+
+int SynthVoice::getNoteModulationIndex (ModDestination destination)
+{
+    const auto found = std::find (noteModulationDestinations.begin(), noteModulationDestinations.end(), destination);
+    return found != noteModulationDestinations.end() ? static_cast<int> (found - noteModulationDestinations.begin()) : -1;
+}
+
+void SynthVoice::resetNoteModulation()
+{
+    for (auto& offset : noteModulation)
+        offset.setCurrentAndTargetValue (0.0f);
+    noteModulated = false;
+}
+
+void SynthVoice::updateModulationRoutes()
+{
+    modulationMatrix.clearRoutes();
+
+    for (const auto& route : modulationRoutes)
+    {
+        const auto destination = static_cast<ModDestination> (route.destination);
+        modulationMatrix.addRoute (static_cast<ModSource> (route.source), destination,
+                                   route.amount * ModulationMatrix::getDestinationRange (destination));
+    }
+
+    // Fixed routes from the filter section
+    modulationMatrix.addRoute (ModSource::filterEnvelope, ModDestination::cutoff, filterEnvAmount * 10000.0f);  // up to +10kHz
+    modulationMatrix.addRoute (ModSource::velocity, ModDestination::cutoff, velocityToFilterAmount * 3000.0f);  // +/- 3kHz
+
+    // C4 is the reference point, 50 Hz per semitone at 100%
+    if (filterKeyTrackAmount > 0.01f)
+        modulationMatrix.addRoute (ModSource::key, ModDestination::cutoff, filterKeyTrackAmount * 50.0f * 64.0f);
+
+    // The render loop only sets the resonance while something modulates it
+    if (! modulationMatrix.isRouted (ModDestination::resonance))
+        forEachFilter ([this] (auto& filter) { filter.setResonance (smoothedResonance.getCurrentValue()); });
+
+    modulationRoutesChanged = false;
+}
+
+int SynthVoice::renderModulationSources (int startSample, int numSamples)
+{
+    auto* lfo1 = modulationSources.getWritePointer (static_cast<int> (ModSource::lfo1));
+    auto* lfo2 = modulationSources.getWritePointer (static_cast<int> (ModSource::lfo2));
+    auto* filterEnv = modulationSources.getWritePointer (static_cast<int> (ModSource::filterEnvelope));
+    auto* ampEnv = modulationSources.getWritePointer (static_cast<int> (ModSource::ampEnvelope));
+
+    // Global mode: the processor already rendered the LFOs for every voice
+    const bool useGlobalLfos = globalLfo1 != nullptr && globalLfo2 != nullptr;
+    const bool needsLfo2 = modulationMatrix.isUsed (ModSource::lfo2);
+
+    if (useGlobalLfos)
+    {
+        juce::FloatVectorOperations::copy (lfo1, globalLfo1 + startSample, numSamples);
+        if (needsLfo2)
+            juce::FloatVectorOperations::copy (lfo2, globalLfo2 + startSample, numSamples);
+    }
+
+    // Envelopes render the whole chunk at once (exponential segments, no
+    // extra curve needed). The voice is done where the amp envelope went silent
+    filterEnvelope.process (filterEnv, numSamples);
+    const int activeSamples = ampEnvelope.process (ampEnv, numSamples);
+
+    const double lfoPhaseDelta = lfoRate / currentSampleRate;
+    const double lfo2PhaseDelta = lfo2Rate / currentSampleRate;
+
+    // Host modulation rows are only filled while a note is modulated
+    noteModulationRendered = noteModulated;
+
+    for (int sample = 0; sample < activeSamples; ++sample)
+    {
+        // Controller events that are due at this sample
+        while (nextControllerEvent < numControllerEvents
+               && controllerEvents[nextControllerEvent].samplePosition <= startSample + sample)
+            applyControllerEvent (controllerEvents[nextControllerEvent++], true);
+
+        // Pitch bend and per-note pitch scale the phase increments
+        pitchRatios[sample] = pitchBendRatio.getNextValue() * notePitchRatio.getNextValue();
+
+        if (! useGlobalLfos)
+        {
+            // LFO 1 (sine wave, -1 to 1)
+            lfo1[sample] = tables->sine (lfoPhase);
+            lfoPhase += lfoPhaseDelta;
+            if (lfoPhase >= 1.0)
+                lfoPhase -= 1.0;
+
+            // LFO 2 (triangle, -1 to 1)
+            if (needsLfo2)
+                lfo2[sample] = lfo_shapes::triangle (lfo2Phase);
+            lfo2Phase += lfo2PhaseDelta;
+            if (lfo2Phase >= 1.0)
+                lfo2Phase -= 1.0;
+        }
+
+        for (size_t i = 1; i < numControllerSources; ++i)
+            modulationSources.setSample (static_cast<int> (toModSource (static_cast<ControllerSource> (i))), sample, controllerValues[i].getNextValue());
+
+        // The first host modulation in this chunk: everything before it was at rest
+        if (noteModulated && ! noteModulationRendered)
+        {
+            noteModulationRows.clear (0, sample);
+            noteModulationRendered = true;
+        }
+
+        if (noteModulationRendered)
+            for (size_t i = 0; i < noteModulation.size(); ++i)
+                noteModulationRows.setSample (static_cast<int> (i), sample, noteModulation[i].getNextValue());
+    }
+
+    // Back at rest: the next chunk can skip the rows again
+    if (noteModulated && std::none_of (noteModulation.begin(), noteModulation.end(), [] (const auto& offset) {
+            return offset.isSmoothing() || ! juce::exactlyEqual (offset.getCurrentValue(), 0.0f);
+        }))
+        noteModulated = false;
+
+    return activeSamples;
 }
 
 void SynthVoice::prepareToPlay (double sampleRate, int samplesPerBlock, int numChannels)
 {
+    juce::ignoreUnused (numChannels);
     currentSampleRate = sampleRate;
 
     // Prepare filter
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = static_cast<uint32_t> (samplesPerBlock);
-    spec.numChannels = static_cast<uint32_t> (numChannels);
-
-    filter.prepare (spec);
-    filter.reset();
+    spec.numChannels = 1;  // Voices are mono until they are summed into the output
+
+    // The HQ filter runs inside the 2x drive pass
+    auto oversampledSpec = spec;
+    oversampledSpec.sampleRate = sampleRate * static_cast<double> (floatPath.oversampling.getOversamplingFactor());
+    oversampledSpec.maximumBlockSize = spec.maximumBlockSize * static_cast<uint32_t> (floatPath.oversampling.getOversamplingFactor());
+
+    auto fourTimesSpec = spec;
+    fourTimesSpec.sampleRate = sampleRate * static_cast<double> (floatPath.fourTimesOversampling.getOversamplingFactor());
+    fourTimesSpec.maximumBlockSize = spec.maximumBlockSize * static_cast<uint32_t> (floatPath.fourTimesOversampling.getOversamplingFactor());
+
+    auto prepareFilters = [&spec, &oversampledSpec, &fourTimesSpec] (auto& path) {
+        path.filter.prepare (spec);
+        path.filter.reset();
+        path.oversampledFilter.prepare (oversampledSpec);
+        path.oversampledFilter.reset();
+        path.fourTimesFilter.prepare (fourTimesSpec);
+        path.fourTimesFilter.reset();
+    };
+    prepareFilters (floatPath);
+    prepareFilters (doublePath);
 
     // Initialize smoothed values (10ms ramp time to prevent clicks)
     smoothedCutoff.reset (sampleRate, 0.01);   // 10ms ramp
@@ -102,8 +463,10 @@ void SynthVoice::prepareToPlay (double sampleRate, int samplesPerBlock, int numC
     // Set default filter parameters
     smoothedCutoff.setCurrentAndTargetValue (1000.0f);
     smoothedResonance.setCurrentAndTargetValue (0.5f);
-    filter.setCutoffFrequencyHz (1000.0f);
-    filter.setResonance (0.5f);
+    forEachFilter ([] (auto& filter) {
+        filter.setCutoffFrequencyHz (1000.0f);
+        filter.setResonance (0.5f);
+    });
 
     // Prepare envelopes
     ampEnvelope.setSampleRate (sampleRate);
@@ -112,171 +475,665 @@ void SynthVoice::prepareToPlay (double sampleRate, int samplesPerBlock, int numC
     filterEnvelope.setSampleRate (sampleRate);
     filterEnvelope.reset();
 
+    // Cached audio is only good for the rate it was rendered at
+    releaseCachedEntry();
+
     // Prepare oversampling (2x for drive/saturation)
     juce::dsp::ProcessSpec oversamplingSpec;
     oversamplingSpec.sampleRate = sampleRate;
     oversamplingSpec.maximumBlockSize = static_cast<uint32_t> (samplesPerBlock);
     oversamplingSpec.numChannels = 1;  // Mono processing
-    oversampling.initProcessing (static_cast<size_t> (samplesPerBlock));
-    oversampling.reset();
-
-    // Allocate temporary buffer for processing
-    tempBuffer.setSize (numChannels, samplesPerBlock);
+    floatPath.oversampling.initProcessing (static_cast<size_t> (samplesPerBlock));
+    floatPath.oversampling.reset();
+    doublePath.oversampling.initProcessing (static_cast<size_t> (samplesPerBlock));
+    doublePath.oversampling.reset();
+    floatPath.fourTimesOversampling.initProcessing (static_cast<size_t> (samplesPerBlock));
+    floatPath.fourTimesOversampling.reset();
+    doublePath.fourTimesOversampling.initProcessing (static_cast<size_t> (samplesPerBlock));
+    doublePath.fourTimesOversampling.reset();
+
+    // Allocate mono voice buffers for processing
+    floatPath.buffer.setSize (1, samplesPerBlock);
+    doublePath.buffer.setSize (1, samplesPerBlock);
+
+    // Modulation matrix rows
+    modulationSources.setSize (ModulationMatrix::numSources, samplesPerBlock);
+    modulationDestinations.setSize (ModulationMatrix::numDestinations, samplesPerBlock);
+    modulationSources.clear();
+    noteModulationRows.setSize (static_cast<int> (noteModulationDestinations.size()), samplesPerBlock);
+    pitchRatios.allocate (static_cast<size_t> (samplesPerBlock), true);
+    phaseDeltas.allocate (static_cast<size_t> (samplesPerBlock), true);
+    modulationRoutesChanged = true;
 
     // Initialize glide smoother (Phase 3)
-    glidedFrequency.reset (sampleRate, 0.1);  // Default 100ms glide
+    updateGlideRamp();
+    glidedFrequency.setCurrentAndTargetValue (440.0);
+
+    // Controller smoothing - keeps the current wheel positions
+    for (auto& value : controllerValues)
+        value.reset (sampleRate, controllerSmoothingSeconds);
+    pitchBendRatio.reset (sampleRate, controllerSmoothingSeconds);
+    notePitchRatio.reset (sampleRate, controllerSmoothingSeconds);
+    for (auto& offset : noteModulation)
+        offset.reset (sampleRate, controllerSmoothingSeconds);
+}
+
+void SynthVoice::reset()
+{
+    clearCurrentNote();
+    releaseCachedEntry();
+    applyOversamplingSettings();
+    ampEnvelope.reset();
+    filterEnvelope.reset();
+
+    lfoPhase = 0.0;
+    lfo2Phase = 0.0;
+    random.setSeed (0x5eed);
+
+    // Controllers back at rest, channel-wide and per channel
+    for (auto& value : controllerValues)
+        value.setCurrentAndTargetValue (0.0f);
+    globalControllerValues.fill (0.0f);
+    channelExpressions.fill ({});
+    pitchBendRatio.setCurrentAndTargetValue (1.0);
+    notePitchRatio.setCurrentAndTargetValue (1.0);
+    resetNoteModulation();
     glidedFrequency.setCurrentAndTargetValue (440.0);
+
+    skipParameterSmoothing();
+    floatPath.oversampling.reset();
+    doublePath.oversampling.reset();
+    floatPath.fourTimesOversampling.reset();
+    doublePath.fourTimesOversampling.reset();
 }
 
 void SynthVoice::renderNextBlock (juce::AudioBuffer<float>& outputBuffer,
                                  int startSample,
                                  int numSamples)
 {
-    // If envelope is not active, voice is done
-    if (! ampEnvelope.isActive())
+    renderVoice (outputBuffer, startSample, numSamples);
+}
+
+void SynthVoice::renderNextBlock (juce::AudioBuffer<double>& outputBuffer,
+                                 int startSample,
+                                 int numSamples)
+{
+    renderVoice (outputBuffer, startSample, numSamples);
+}
+
+template <typename SampleType>
+void SynthVoice::renderVoice (juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples)
+{
+    // If envelope is not active, voice is done. A chunk the synthesiser
+    // already prepared still renders: its modulation pass may be what took
+    // the envelope to its end
+    if (! ampEnvelope.isActive() && ! bankedChunkPrepared)
     {
+        skipControllerEvents (startSample + numSamples);
         clearCurrentNote();
+        releaseCachedEntry();
         return;
     }
 
-    // Render audio
-    for (int sample = 0; sample < numSamples; ++sample)
+    const int endSample = startSample + numSamples;
+
+    // Render in chunks that fit the preallocated voice buffer (hosts may exceed
+    // the block size they announced in prepareToPlay) and the bank's step rows
+    jassert (bank.getTileSize() > 0);
+
+    while (numSamples > 0 && (ampEnvelope.isActive() || bankedChunkPrepared))
     {
-        // === Phase 3: Update glided frequency ===
-        updateGlidedFrequency();
+        const int chunkSize = juce::jmin (numSamples, getSignalPath<SampleType>().buffer.getNumSamples(), bank.getTileSize());
 
-        // Generate LFO (sine wave, -1 to 1)
-        float lfoValue = std::sin (static_cast<float> (juce::MathConstants<double>::twoPi * lfoPhase));
+        // Cached playback stops short where the live render has to take over
+        if (cachePlayback == CachePlayback::playing)
+        {
+            const int played = renderCachedChunk (outputBuffer, startSample, chunkSize);
+            startSample += played;
+            numSamples -= played;
+            continue;
+        }
 
-        // Increment LFO phase
-        double lfoPhaseDelta = lfoRate / currentSampleRate;
-        lfoPhase += lfoPhaseDelta;
-        if (lfoPhase >= 1.0)
-            lfoPhase -= 1.0;
+        renderVoiceChunk (outputBuffer, startSample, chunkSize);
+        startSample += chunkSize;
+        numSamples -= chunkSize;
+    }
 
-        // === Phase 3: Get envelope values with exponential curves ===
-        float filterEnvValue = applyExponentialCurve (filterEnvelope.getNextSample());
-        float ampEnvValue = applyExponentialCurve (ampEnvelope.getNextSample());
+    // Free the voice as soon as the tail has dropped below -96 dB, mid-block
+    // included, so the next note-on sees the same free voices regardless of
+    // how the host split the blocks
+    if (! ampEnvelope.isActive())
+    {
+        skipControllerEvents (endSample);
+        clearCurrentNote();
+        releaseCachedEntry();
+    }
+}
+
+bool SynthVoice::prepareBankedChunk (int startSample, int numSamples)
+{
+    // Only what renderVoice would render live as one chunk
+    if (! ampEnvelope.isActive() || cachePlayback == CachePlayback::playing
+        || numSamples > floatPath.buffer.getNumSamples() || numSamples > bank.getTileSize())
+        return false;
+
+    // Past the end of the amp envelope nothing is written: stand still there
+    const auto numPrepared = prepareChunk (startSample, numSamples);
+    bankedChunkPrepared = true;
+
+    if (numPrepared > 0)
+    {
+        bank.clearIncrements (bankIndex, numPrepared, numSamples);
+        bank.markActive (bankIndex);
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+void SynthVoice::renderVoiceChunk (juce::AudioBuffer<SampleType>& outputBuffer,
+                                  int startSample,
+                                  int numSamples)
+{
+    // Stepped by the synthesiser together with the other voices, or on our own
+    if (! bankedChunkPrepared)
+    {
+        prepareChunk (startSample, numSamples);
+        bank.stepVoice (bankIndex, preparedChunk.numSamples);
+    }
+
+    bankedChunkPrepared = false;
+    finishChunk (outputBuffer, startSample);
+}
+
+int SynthVoice::prepareChunk (int startSample, int numSamples)
+{
+    if (modulationRoutesChanged)
+        updateModulationRoutes();
+
+    // === Modulation: sources, then every route as one vector pass ===
+    // Anything after the amp envelope went silent isn't rendered at all
+    numSamples = renderModulationSources (startSample, numSamples);
+    preparedChunk.numSamples = numSamples;
+    if (numSamples == 0)
+        return 0;
 
-        // === Phase 3: Velocity sensitivity for filter ===
-        float velocityFilterMod = (currentVelocity - 0.5f) * 2.0f * velocityToFilterAmount;  // -1 to +1 range
-        velocityFilterMod *= 3000.0f;  // +/- 3kHz based on velocity
+    modulationMatrix.process (modulationSources, modulationDestinations, numSamples);
 
-        // === Phase 3: Filter key tracking ===
-        float keyTrackMod = 0.0f;
-        if (filterKeyTrackAmount > 0.01f)
+    // CLAP per-note modulation adds to whatever the matrix sent there
+    if (noteModulationRendered)
+    {
+        for (size_t i = 0; i < noteModulationDestinations.size(); ++i)
         {
-            // C4 (MIDI 60) is the reference point
-            float noteOffset = currentMidiNote - 60;
-            keyTrackMod = noteOffset * 50.0f * filterKeyTrackAmount;  // 50 Hz per semitone at 100%
+            const auto destination = noteModulationDestinations[i];
+            auto* row = modulationDestinations.getWritePointer (static_cast<int> (destination));
+            const auto* offsets = noteModulationRows.getReadPointer (static_cast<int> (i));
+
+            if (modulationMatrix.isRouted (destination))
+                juce::FloatVectorOperations::add (row, offsets, numSamples);
+            else
+                juce::FloatVectorOperations::copy (row, offsets, numSamples);
         }
+    }
 
-        // Apply modulation to cutoff frequency
-        float baseCutoff = smoothedCutoff.isSmoothing() ? smoothedCutoff.getNextValue() : smoothedCutoff.getCurrentValue();
-        float envModulation = filterEnvValue * filterEnvAmount * 10000.0f;   // Envelope: up to +10kHz
-        float lfoModulation = lfoValue * lfoAmount * 5000.0f;                // LFO: +/- 5kHz
-        float modulatedCutoff = baseCutoff + envModulation + lfoModulation + velocityFilterMod + keyTrackMod;
+    auto isModulated = [this] (ModDestination destination) {
+        return modulationMatrix.isRouted (destination) || (noteModulationRendered && getNoteModulationIndex (destination) >= 0);
+    };
+
+    auto rowIfRouted = [this, &isModulated] (ModDestination destination) -> const float* {
+        return isModulated (destination) ? modulationDestinations.getReadPointer (static_cast<int> (destination)) : nullptr;
+    };
+
+    auto* cutoffModulation = modulationDestinations.getWritePointer (static_cast<int> (ModDestination::cutoff));
+    if (! isModulated (ModDestination::cutoff))
+        juce::FloatVectorOperations::clear (cutoffModulation, numSamples);
+
+    // LFO 1 -> cutoff (+/- 5kHz), its depth is the LFO amount plus whatever the matrix adds
+    auto* lfoDepth = modulationDestinations.getWritePointer (static_cast<int> (ModDestination::lfoDepth));
+    if (modulationMatrix.isRouted (ModDestination::lfoDepth))
+        juce::FloatVectorOperations::add (lfoDepth, lfoAmount, numSamples);
+    else
+        juce::FloatVectorOperations::fill (lfoDepth, lfoAmount, numSamples);
+
+    juce::FloatVectorOperations::clip (lfoDepth, lfoDepth, 0.0f, 1.0f, numSamples);
+    juce::FloatVectorOperations::multiply (lfoDepth, modulationSources.getReadPointer (static_cast<int> (ModSource::lfo1)), numSamples);
+    juce::FloatVectorOperations::addWithMultiply (cutoffModulation, lfoDepth, 5000.0f, numSamples);
+
+    // === Oscillators: this chunk's increments, for the bank to step ===
+    // A glide only starts at a note-on, which always begins a new render call
+    const auto* detuneStep = convertPitchRows (numSamples, isModulated (ModDestination::pitch), isModulated (ModDestination::detune));
+    const auto writer = getIncrementWriter (unisonVoices, glidedFrequency.isSmoothing());
+    (this->*writer) (detuneStep, numSamples);
+
+    // === Phase 3: Velocity sensitivity for amp ===
+    const float velocityGain = 1.0f - velocityToAmpAmount + (currentVelocity * velocityToAmpAmount);
+
+    auto* resonanceRow = modulationDestinations.getWritePointer (static_cast<int> (ModDestination::resonance));
+    preparedChunk.rows = { cutoffModulation, rowIfRouted (ModDestination::resonance), rowIfRouted (ModDestination::subMix),
+                           rowIfRouted (ModDestination::amp), modulationSources.getReadPointer (static_cast<int> (ModSource::ampEnvelope)),
+                           velocityGain, cutoffModulation, resonanceRow };
+    preparedChunk.driveModulation = rowIfRouted (ModDestination::drive);
+    return numSamples;
+}
+
+template <typename SampleType>
+void SynthVoice::finishChunk (juce::AudioBuffer<SampleType>& outputBuffer, int startSample)
+{
+    const int numSamples = preparedChunk.numSamples;
+    if (numSamples == 0)
+        return;
+
+    const auto& rows = preparedChunk.rows;
+    const auto* driveModulation = preparedChunk.driveModulation;
+
+    // Render audio with the kernel built for this unison count and filter mode
+    auto& path = getSignalPath<SampleType>();
+    const auto kernel = getRenderKernel<SampleType> (unisonVoices, filterOversampled);
+    (this->*kernel) (path.buffer.getWritePointer (0), rows, numSamples);
+
+    juce::dsp::AudioBlock<SampleType> block (path.buffer);
+    auto voiceBlock = block.getSubBlock (0, static_cast<size_t> (numSamples));
+
+    // One 2x (4x offline) round trip for whatever runs oversampled: the filter
+    // in HQ mode, the drive whenever it's on or modulated (unless the governor
+    // moved it to the base rate)
+    const bool driveActive = driveAmount > 0.01f || driveModulation != nullptr;
+    if (driveActive && ! driveOversampled && ! filterOversampled)
+    {
+        driveOversampledBlock (voiceBlock, driveModulation, 1);
+    }
+    else if (filterOversampled || driveActive)
+    {
+        auto& oversampling = fourTimesOversampled ? path.fourTimesOversampling : path.oversampling;
+        auto oversampledBlock = oversampling.processSamplesUp (voiceBlock);
+        const auto factor = oversampling.getOversamplingFactor();
+
+        if (filterOversampled)
+            filterOversampledBlock (fourTimesOversampled ? path.fourTimesFilter : path.oversampledFilter,
+                                    oversampledBlock, rows.filterCutoff, rows.filterResonance, factor);
+
+        if (driveActive)
+            driveOversampledBlock (oversampledBlock, driveModulation, factor);
+
+        oversampling.processSamplesDown (voiceBlock);
+    }
+
+    if (cachePlayback == CachePlayback::handingOver)
+        crossfadeFromCache (path.buffer.getWritePointer (0), numSamples);
+
+    // Mono voice to all output channels
+    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+        outputBuffer.addFrom (channel, startSample, path.buffer, 0, 0, numSamples);
+}
+
+template <typename SampleType>
+int SynthVoice::renderCachedChunk (juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples)
+{
+    const auto& samples = cachedEntry->samples;
+    const auto numCached = static_cast<int> (samples.size());
+
+    // The live render takes over before the first controller event (the entry
+    // assumes controllers at rest) and before a held note runs out of audio.
+    // A note that died away inside the render plays to its end
+    if (nextControllerEvent < numControllerEvents)
+        numSamples = juce::jmin (numSamples, controllerEvents[nextControllerEvent].samplePosition - startSample);
+    if (! cachedEntry->complete)
+        numSamples = juce::jmin (numSamples, numCached - prerenderCache->getHandoverLength() - cachedPosition);
+
+    if (numSamples <= 0)
+    {
+        stopCachedPlayback();
+        return 0;
+    }
+
+    // Envelopes, LFO phases and smoothers run on as if the voice were
+    // rendering, so the live render picks up exactly where the note is
+    numSamples = renderModulationSources (startSample, numSamples);
+
+    for (int voice = 0; voice < unisonVoices; ++voice)
+    {
+        auto& phase = bank.phase (voice, bankIndex);
+        phase = std::fmod (phase + phaseDelta * unisonDetuneRatios[static_cast<size_t> (voice)] * numSamples, 1.0);
+    }
+
+    auto& subPhase = bank.phase (VoiceBank::subLane, bankIndex);
+    subPhase = std::fmod (subPhase + subPhaseDelta * numSamples, 1.0);
+
+    smoothedCutoff.skip (numSamples);
+    smoothedResonance.skip (numSamples);
+
+    const auto numToCopy = juce::jlimit (0, numSamples, numCached - cachedPosition);
+    for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+    {
+        auto* output = outputBuffer.getWritePointer (channel, startSample);
+        for (int i = 0; i < numToCopy; ++i)
+            output[i] += static_cast<SampleType> (samples[static_cast<size_t> (cachedPosition + i)]);
+    }
+
+    cachedPosition += numSamples;
+    return numSamples;
+}
+
+template <typename SampleType>
+void SynthVoice::crossfadeFromCache (SampleType* voiceData, int numSamples)
+{
+    const auto& samples = cachedEntry->samples;
+    const auto handoverLength = static_cast<SampleType> (prerenderCache->getHandoverLength());
+
+    for (int i = 0; i < numSamples && handoverRemaining > 0; ++i, --handoverRemaining, ++cachedPosition)
+    {
+        const auto liveGain = SampleType (1) - static_cast<SampleType> (handoverRemaining) / handoverLength;
+        const auto cached = cachedPosition < static_cast<int> (samples.size()) ? static_cast<SampleType> (samples[static_cast<size_t> (cachedPosition)]) : SampleType (0);
+        voiceData[i] = voiceData[i] * liveGain + cached * (SampleType (1) - liveGain);
+    }
+
+    if (handoverRemaining == 0)
+        releaseCachedEntry();
+}
+
+bool SynthVoice::areControllersAtRest() const
+{
+    if (! juce::exactlyEqual (pitchBendRatio.getCurrentValue(), 1.0) || ! juce::exactlyEqual (notePitchRatio.getCurrentValue(), 1.0))
+        return false;
+
+    return std::all_of (controllerValues.begin(), controllerValues.end(), [] (const auto& value) {
+        return ! value.isSmoothing() && juce::exactlyEqual (value.getCurrentValue(), 0.0f);
+    });
+}
+
+void SynthVoice::startCachedPlayback (bool wasIdle)
+{
+    // A retriggered voice lets go of the previous note's audio first
+    releaseCachedEntry();
+
+    if (prerenderCache == nullptr || ! prerenderCache->isActive() || ! wasIdle || ! areControllersAtRest())
+        return;
+
+    cachedEntry = prerenderCache->acquire (currentMidiNote, currentVelocity);
+    if (cachedEntry != nullptr)
+    {
+        cachePlayback = CachePlayback::playing;
+        cachedPosition = 0;
+    }
+}
+
+void SynthVoice::stopCachedPlayback()
+{
+    if (cachePlayback != CachePlayback::playing)
+        return;
+
+    cachePlayback = CachePlayback::handingOver;
+    handoverRemaining = prerenderCache->getHandoverLength();
+}
+
+void SynthVoice::releaseCachedEntry()
+{
+    if (cachedEntry != nullptr)
+        PrerenderCache::release (cachedEntry);
 
-        // Update filter parameters
-        filter.setCutoffFrequencyHz (juce::jlimit (20.0f, 20000.0f, modulatedCutoff));
+    cachedEntry = nullptr;
+    cachePlayback = CachePlayback::off;
+    handoverRemaining = 0;
+}
+
+const float* SynthVoice::convertPitchRows (int numSamples, bool pitchModulated, bool detuneModulated)
+{
+    // Pitch: +/- semitones on top of bend and per-note pitch
+    if (pitchModulated)
+    {
+        const auto* semitones = modulationDestinations.getReadPointer (static_cast<int> (ModDestination::pitch));
+        for (int sample = 0; sample < numSamples; ++sample)
+            pitchRatios[sample] *= std::exp2 (static_cast<double> (semitones[sample]) / 12.0);
+    }
 
-        if (smoothedResonance.isSmoothing())
-            filter.setResonance (smoothedResonance.getNextValue());
+    const int numVoices = juce::jlimit (1, maxUnisonVoices, unisonVoices);
+    if (! detuneModulated || numVoices == 1)
+        return nullptr;
 
-        // === Phase 3: Unison - generate multiple detuned oscillators ===
-        float unisonSample = 0.0f;
+    // Detune: the same spread as getUnisonDetuneRatio (up to +/- 100 cents, off
+    // below 0.01), as half the ratio between neighbouring voices, in place
+    auto* row = modulationDestinations.getWritePointer (static_cast<int> (ModDestination::detune));
+    const float exponentPerDetune = 100.0f / 2400.0f / static_cast<float> (numVoices - 1);
 
-        for (int voice = 0; voice < unisonVoices; ++voice)
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const float detune = juce::jlimit (0.0f, 1.0f, unisonDetune + row[sample]);
+        row[sample] = detune > 0.01f ? std::exp2 (detune * exponentPerDetune) : 1.0f;
+    }
+
+    return row;
+}
+
+SynthVoice::IncrementWriter SynthVoice::getIncrementWriter (int numUnisonVoices, bool gliding)
+{
+    // [unison voices - 1][gliding]
+    static constexpr IncrementWriter writers[maxUnisonVoices][2] = {
+        { &SynthVoice::writeOscillatorIncrements<1, false>, &SynthVoice::writeOscillatorIncrements<1, true> },
+        { &SynthVoice::writeOscillatorIncrements<2, false>, &SynthVoice::writeOscillatorIncrements<2, true> },
+        { &SynthVoice::writeOscillatorIncrements<3, false>, &SynthVoice::writeOscillatorIncrements<3, true> },
+        { &SynthVoice::writeOscillatorIncrements<4, false>, &SynthVoice::writeOscillatorIncrements<4, true> },
+        { &SynthVoice::writeOscillatorIncrements<5, false>, &SynthVoice::writeOscillatorIncrements<5, true> },
+    };
+
+    return writers[juce::jlimit (1, maxUnisonVoices, numUnisonVoices) - 1][gliding ? 1 : 0];
+}
+
+template <int NumUnisonVoices, bool Gliding>
+void SynthVoice::writeOscillatorIncrements (const float* detuneStep, int numSamples)
+{
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // === Phase 3: Update glided frequency ===
+        if constexpr (Gliding)
+            updateGlidedFrequency();
+
+        const double bend = pitchRatios[sample];
+        const double bentPhaseDelta = phaseDelta * bend;
+        phaseDeltas[sample] = bentPhaseDelta;
+
+        // A modulated spread: neighbouring voices are step^2 apart, symmetric
+        // around the note, so the lowest is step^-(voices - 1)
+        std::array<float, NumUnisonVoices> detuneRatios;
+        if constexpr (NumUnisonVoices > 1)
         {
-            // Calculate detune amount for this voice
-            float detuneCents = 0.0f;
-            if (unisonVoices > 1 && unisonDetune > 0.01f)
+            if (detuneStep != nullptr)
+            {
+                const float step = detuneStep[sample];
+                float lowest = 1.0f;
+                for (int voice = 1; voice < NumUnisonVoices; ++voice)
+                    lowest *= step;
+
+                detuneRatios[0] = 1.0f / lowest;
+                for (size_t voice = 1; voice < detuneRatios.size(); ++voice)
+                    detuneRatios[voice] = detuneRatios[voice - 1] * step * step;
+            }
+            else
             {
-                // Spread voices evenly: -detune to +detune
-                float spread = (voice / static_cast<float> (unisonVoices - 1)) - 0.5f;  // -0.5 to +0.5
-                detuneCents = spread * unisonDetune * 100.0f;  // Up to +/- 100 cents at max detune
+                std::copy (unisonDetuneRatios.begin(), unisonDetuneRatios.begin() + NumUnisonVoices, detuneRatios.begin());
             }
+        }
+        else
+        {
+            detuneRatios[0] = unisonDetuneRatios[0];
+        }
 
-            // Calculate detuned frequency
-            float detuneRatio = std::pow (2.0f, detuneCents / 1200.0f);
-            double detunedPhaseDelta = phaseDelta * detuneRatio;
+        // Detuned (and bent) frequency for each unison voice; the lanes past
+        // the unison count stand still
+        for (int voice = 0; voice < NumUnisonVoices; ++voice)
+            bank.increment (sample, voice, bankIndex) = bentPhaseDelta * detuneRatios[static_cast<size_t> (voice)];
+        for (int voice = NumUnisonVoices; voice < maxUnisonVoices; ++voice)
+            bank.increment (sample, voice, bankIndex) = 0.0;
 
-            // Generate oscillator sample for this unison voice
-            double voicePhase = (voice == 0) ? phase : unisonPhases[voice];
-            float oscOutput = static_cast<float> (voicePhase * 2.0 - 1.0);
-            oscOutput -= polyBlep (voicePhase);
+        bank.increment (sample, VoiceBank::subLane, bankIndex) = subPhaseDelta * bend;
+    }
+}
 
-            // Increment and wrap phase for this voice
-            voicePhase += detunedPhaseDelta;
-            if (voicePhase >= 1.0)
-                voicePhase -= 1.0;
+template <typename SampleType>
+SynthVoice::RenderKernel<SampleType> SynthVoice::getRenderKernel (int numUnisonVoices, bool oversampledFilter)
+{
+    // [unison voices - 1][oversampled filter]
+    static constexpr RenderKernel<SampleType> kernels[maxUnisonVoices][2] = {
+        { &SynthVoice::renderKernel<SampleType, 1, false>, &SynthVoice::renderKernel<SampleType, 1, true> },
+        { &SynthVoice::renderKernel<SampleType, 2, false>, &SynthVoice::renderKernel<SampleType, 2, true> },
+        { &SynthVoice::renderKernel<SampleType, 3, false>, &SynthVoice::renderKernel<SampleType, 3, true> },
+        { &SynthVoice::renderKernel<SampleType, 4, false>, &SynthVoice::renderKernel<SampleType, 4, true> },
+        { &SynthVoice::renderKernel<SampleType, 5, false>, &SynthVoice::renderKernel<SampleType, 5, true> },
+    };
+
+    return kernels[juce::jlimit (1, maxUnisonVoices, numUnisonVoices) - 1][oversampledFilter ? 1 : 0];
+}
 
-            // Store phase for non-primary voices
-            if (voice == 0)
-                phase = voicePhase;
+template <typename SampleType, int NumUnisonVoices, bool OversampledFilter>
+void SynthVoice::renderKernel (SampleType* voiceData, const KernelRows& rows, int numSamples)
+{
+    [[maybe_unused]] auto& filter = getSignalPath<SampleType>().filter;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // Apply modulation to cutoff frequency
+        float baseCutoff = smoothedCutoff.isSmoothing() ? smoothedCutoff.getNextValue() : smoothedCutoff.getCurrentValue();
+        const float cutoff = juce::jlimit (20.0f, 20000.0f, baseCutoff + rows.cutoff[sample]);
+
+        if constexpr (OversampledFilter)
+            rows.filterCutoff[sample] = cutoff;
+        else
+            filter.setCutoffFrequencyHz (static_cast<SampleType> (cutoff));
+
+        if (smoothedResonance.isSmoothing() || rows.resonance != nullptr)
+        {
+            float baseResonance = smoothedResonance.isSmoothing() ? smoothedResonance.getNextValue() : smoothedResonance.getCurrentValue();
+            float resonanceOffset = rows.resonance != nullptr ? rows.resonance[sample] : 0.0f;
+            const float resonance = juce::jlimit (0.0f, 1.0f, baseResonance + resonanceOffset);
+
+            if constexpr (OversampledFilter)
+                rows.filterResonance[sample] = resonance;
             else
-                unisonPhases[voice] = voicePhase;
+                filter.setResonance (static_cast<SampleType> (resonance));
+        }
+        else if constexpr (OversampledFilter)
+        {
+            rows.filterResonance[sample] = smoothedResonance.getCurrentValue();
+        }
+
+        // === Phase 3: Unison - the detuned saws, at the phases the bank stepped ===
+        SampleType unisonSample = 0;
+        const double dt = phaseDeltas[sample];
+
+        for (int voice = 0; voice < NumUnisonVoices; ++voice)
+        {
+            const auto voicePhase = bank.phaseAt (sample, voice, bankIndex);
+            auto oscOutput = static_cast<SampleType> (voicePhase * 2.0 - 1.0);
+            oscOutput -= static_cast<SampleType> (polyBlep (voicePhase, dt));
 
             // Add to unison mix
             unisonSample += oscOutput;
         }
 
         // Average the unison voices
-        if (unisonVoices > 1)
-            unisonSample /= static_cast<float> (unisonVoices);
+        if constexpr (NumUnisonVoices > 1)
+            unisonSample /= static_cast<SampleType> (NumUnisonVoices);
 
         // Generate sub-oscillator sample
-        float subSample = generateSubOscillator();
+        const auto subSample = generateSubOscillator<SampleType> (bank.phaseAt (sample, VoiceBank::subLane, bankIndex));
 
         // Mix oscillators
-        float mixedSample = unisonSample + (subSample * subMix);
-
-        // === Phase 3: Velocity sensitivity for amp ===
-        float velocityGain = 1.0f - velocityToAmpAmount + (currentVelocity * velocityToAmpAmount);
-        mixedSample *= velocityGain;
+        float modulatedSubMix = rows.subMix != nullptr ? juce::jlimit (0.0f, 1.0f, subMix + rows.subMix[sample]) : subMix;
+        SampleType mixedSample = unisonSample + (subSample * modulatedSubMix);
+        mixedSample *= rows.velocityGain;
 
         // Apply amplitude envelope
-        float finalSample = mixedSample * ampEnvValue;
+        SampleType finalSample = mixedSample * rows.ampEnvelope[sample];
+        if (rows.amp != nullptr)
+            finalSample *= juce::jmax (0.0f, 1.0f + rows.amp[sample]);
 
-        // Write to all output channels
-        for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+        // Apply filter per sample so the modulated cutoff above is the one used
+        if constexpr (OversampledFilter)
         {
-            outputBuffer.addSample (channel, startSample + sample, finalSample);
+            voiceData[sample] = finalSample;
+        }
+        else
+        {
+            filter.updateSmoothers();
+            voiceData[sample] = filter.processSample (finalSample, 0);
         }
     }
+}
 
-    // Apply filter using DSP module (operates on blocks)
-    // Create an alias of the output buffer section we're working with
-    juce::dsp::AudioBlock<float> block (outputBuffer);
-    auto subBlock = block.getSubBlock (static_cast<size_t> (startSample),
-                                       static_cast<size_t> (numSamples));
-    juce::dsp::ProcessContextReplacing<float> context (subBlock);
-    filter.process (context);
-
-    // Apply drive/saturation with oversampling (if drive > 0)
-    if (driveAmount > 0.01f)
+template <typename SampleType>
+void SynthVoice::filterOversampledBlock (FilterType<SampleType>& filter, juce::dsp::AudioBlock<SampleType>& block,
+                                         const float* cutoff, const float* resonance, size_t factor)
+{
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
     {
-        // Upsample to 2x sample rate
-        auto oversampledBlock = oversampling.processSamplesUp (subBlock);
-
-        // Apply drive (boost signal before saturation)
-        float driveGain = 1.0f + (driveAmount * 9.0f);  // 1x to 10x gain
+        auto* channelData = block.getChannelPointer (channel);
 
-        // Apply tanh saturation (soft clipping for even harmonics)
-        for (size_t channel = 0; channel < oversampledBlock.getNumChannels(); ++channel)
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
         {
-            auto* channelData = oversampledBlock.getChannelPointer (channel);
-            for (size_t i = 0; i < oversampledBlock.getNumSamples(); ++i)
+            // Cutoff and resonance are computed per base-rate sample and held
+            if (i % factor == 0)
             {
-                channelData[i] = std::tanh (channelData[i] * driveGain);
+                filter.setCutoffFrequencyHz (static_cast<SampleType> (cutoff[i / factor]));
+                filter.setResonance (static_cast<SampleType> (resonance[i / factor]));
             }
+
+            filter.updateSmoothers();
+            channelData[i] = filter.processSample (channelData[i], channel);
         }
+    }
+}
+
+template <typename SampleType>
+void SynthVoice::driveOversampledBlock (juce::dsp::AudioBlock<SampleType>& block, const float* driveModulation, size_t factor)
+{
+    // Apply tanh saturation (soft clipping for even harmonics), boosting
+    // 1x to 10x before it. The modulated case gets its own loop so the
+    // common fixed-drive one doesn't read the drive row
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* channelData = block.getChannelPointer (channel);
+        const auto numOversampled = block.getNumSamples();
 
-        // Downsample back to original sample rate
-        oversampling.processSamplesDown (subBlock);
+        if (driveModulation != nullptr)
+        {
+            for (size_t i = 0; i < numOversampled; ++i)
+            {
+                const float drive = juce::jlimit (0.0f, 1.0f, driveAmount + driveModulation[i / factor]);
+                channelData[i] = std::tanh (channelData[i] * static_cast<SampleType> (1.0f + drive * 9.0f));
+            }
+        }
+        else
+        {
+            const auto driveGain = static_cast<SampleType> (1.0f + driveAmount * 9.0f);
+            for (size_t i = 0; i < numOversampled; ++i)
+                channelData[i] = std::tanh (channelData[i] * driveGain);
+        }
     }
 }
 
+void SynthVoice::setParameters (const VoiceParameters& params)
+{
+    setFilterCutoff (params.filterCutoff);
+    setFilterResonance (params.filterResonance);
+    setAmpEnvelope (params.ampAttack, params.ampDecay, params.ampSustain, params.ampRelease);
+    setFilterEnvelope (params.filterEnvAttack, params.filterEnvDecay, params.filterEnvSustain, params.filterEnvRelease);
+    setFilterEnvAmount (params.filterEnvAmount);
+    setSubMix (params.subMix);
+    setLFORate (params.lfoRate);
+    setLFOAmount (params.lfoAmount);
+    setLFO2Rate (params.lfo2Rate);
+    setDriveAmount (params.driveAmount);
+
+    // Phase 3 parameters
+    setGlideTime (params.glideTime);
+    setVelocityToFilter (params.velocityToFilter);
+    setVelocityToAmp (params.velocityToAmp);
+    setFilterKeyTracking (params.filterKeyTrack);
+    setUnisonVoices (params.unisonVoices);
+    setUnisonDetune (params.unisonDetune);
+    setSubOctave (params.subOctave);
+    setModulationRoutes (params.modRoutes);
+}
+
 void SynthVoice::setFilterCutoff (float cutoff)
 {
     // Set target value for smoothed cutoff (prevents clicks)
@@ -291,6 +1148,12 @@ void SynthVoice::setFilterResonance (float resonance)
 
 void SynthVoice::setAmpEnvelope (float attack, float decay, float sustain, float release)
 {
+    // Only touch the ADSR on a real change: setParameters() recalculates the
+    // release rate, which would bend a tail that is already releasing
+    if (juce::exactlyEqual (attack, ampEnvParams.attack) && juce::exactlyEqual (decay, ampEnvParams.decay)
+        && juce::exactlyEqual (sustain, ampEnvParams.sustain) && juce::exactlyEqual (release, ampEnvParams.release))
+        return;
+
     ampEnvParams.attack = attack;
     ampEnvParams.decay = decay;
     ampEnvParams.sustain = sustain;
@@ -305,6 +1168,10 @@ void SynthVoice::setSubMix (float mix)
 
 void SynthVoice::setFilterEnvelope (float attack, float decay, float sustain, float release)
 {
+    if (juce::exactlyEqual (attack, filterEnvParams.attack) && juce::exactlyEqual (decay, filterEnvParams.decay)
+        && juce::exactlyEqual (sustain, filterEnvParams.sustain) && juce::exactlyEqual (release, filterEnvParams.release))
+        return;
+
     filterEnvParams.attack = attack;
     filterEnvParams.decay = decay;
     filterEnvParams.sustain = sustain;
@@ -314,7 +1181,9 @@ void SynthVoice::setFilterEnvelope (float attack, float decay, float sustain, fl
 
 void SynthVoice::setFilterEnvAmount (float amount)
 {
-    filterEnvAmount = juce::jlimit (0.0f, 1.0f, amount);
+    const auto newAmount = juce::jlimit (0.0f, 1.0f, amount);
+    modulationRoutesChanged |= ! juce::exactlyEqual (newAmount, filterEnvAmount);
+    filterEnvAmount = newAmount;
 }
 
 void SynthVoice::setLFORate (float rate)
@@ -327,6 +1196,78 @@ void SynthVoice::setLFOAmount (float amount)
     lfoAmount = juce::jlimit (0.0f, 1.0f, amount);
 }
 
+void SynthVoice::setLFO2Rate (float rate)
+{
+    lfo2Rate = juce::jlimit (0.01f, 20.0f, rate);
+}
+
+void SynthVoice::skipParameterSmoothing()
+{
+    smoothedCutoff.setCurrentAndTargetValue (smoothedCutoff.getTargetValue());
+    smoothedResonance.setCurrentAndTargetValue (smoothedResonance.getTargetValue());
+    forEachFilter ([this] (auto& filter) {
+        filter.setCutoffFrequencyHz (smoothedCutoff.getCurrentValue());
+        filter.setResonance (smoothedResonance.getCurrentValue());
+        filter.reset();
+    });
+}
+
+void SynthVoice::setFilterOversampling (bool shouldOversample)
+{
+    pendingFilterOversampled = shouldOversample;
+    if (! isVoiceActive())
+        applyOversamplingSettings();
+}
+
+void SynthVoice::setDriveOversampling (bool shouldOversample)
+{
+    pendingDriveOversampled = shouldOversample;
+    if (! isVoiceActive())
+        applyOversamplingSettings();
+}
+
+void SynthVoice::setFourTimesOversampling (bool shouldUseFourTimes)
+{
+    pendingFourTimesOversampled = shouldUseFourTimes;
+    if (! isVoiceActive())
+        applyOversamplingSettings();
+}
+
+void SynthVoice::applyOversamplingSettings()
+{
+    // Only between notes: the filters and passes that take over start from
+    // silence rather than stale state, which is what the next note expects
+    if (pendingFilterOversampled != filterOversampled || pendingFourTimesOversampled != fourTimesOversampled)
+        forEachFilter ([] (auto& filter) { filter.reset(); });
+
+    if (pendingDriveOversampled != driveOversampled)
+    {
+        floatPath.oversampling.reset();
+        doublePath.oversampling.reset();
+    }
+
+    if (pendingFourTimesOversampled != fourTimesOversampled)
+    {
+        floatPath.fourTimesOversampling.reset();
+        doublePath.fourTimesOversampling.reset();
+    }
+
+    filterOversampled = pendingFilterOversampled;
+    driveOversampled = pendingDriveOversampled;
+    fourTimesOversampled = pendingFourTimesOversampled;
+}
+
+bool SynthVoice::cutQuietTail (float level)
+{
+    if (! ampEnvelope.isReleasing() || ampEnvelope.getLevel() >= level)
+        return false;
+
+    // A short fade rather than a hard stop, which would click even at -36 dB.
+    // The voice frees itself once the envelope is silent
+    ampEnvelope.fastRelease (quietTailFadeSeconds);
+    return true;
+}
+
 void SynthVoice::setDriveAmount (float drive)
 {
     driveAmount = juce::jlimit (0.0f, 1.0f, drive);
@@ -336,17 +1277,22 @@ void SynthVoice::setDriveAmount (float drive)
 
 void SynthVoice::setGlideTime (float time)
 {
-    glideTime = juce::jlimit (0.0f, 2.0f, time);
-    // Update glide smoothing rate based on glide time
-    if (glideTime > 0.001f)
-        glidedFrequency.reset (currentSampleRate, glideTime);
-    else
-        glidedFrequency.reset (currentSampleRate, 0.0001);  // Instant
+    const auto newGlideTime = juce::jlimit (0.0f, 2.0f, time);
+
+    // SmoothedValue::reset() jumps to the target, so re-applying an unchanged
+    // glide time every block would cut any glide in progress short
+    if (juce::exactlyEqual (newGlideTime, glideTime))
+        return;
+
+    glideTime = newGlideTime;
+    updateGlideRamp();
 }
 
 void SynthVoice::setVelocityToFilter (float amount)
 {
-    velocityToFilterAmount = juce::jlimit (0.0f, 1.0f, amount);
+    const auto newAmount = juce::jlimit (0.0f, 1.0f, amount);
+    modulationRoutesChanged |= ! juce::exactlyEqual (newAmount, velocityToFilterAmount);
+    velocityToFilterAmount = newAmount;
 }
 
 void SynthVoice::setVelocityToAmp (float amount)
@@ -356,17 +1302,29 @@ void SynthVoice::setVelocityToAmp (float amount)
 
 void SynthVoice::setFilterKeyTracking (float amount)
 {
-    filterKeyTrackAmount = juce::jlimit (0.0f, 1.0f, amount);
+    const auto newAmount = juce::jlimit (0.0f, 1.0f, amount);
+    modulationRoutesChanged |= ! juce::exactlyEqual (newAmount, filterKeyTrackAmount);
+    filterKeyTrackAmount = newAmount;
 }
 
 void SynthVoice::setUnisonVoices (int voices)
 {
-    unisonVoices = juce::jlimit (1, 5, voices);
+    const auto newUnisonVoices = juce::jlimit (1, 5, voices);
+    if (newUnisonVoices == unisonVoices)
+        return;
+
+    unisonVoices = newUnisonVoices;
+    updateUnisonDetuneRatios();
 }
 
 void SynthVoice::setUnisonDetune (float detune)
 {
-    unisonDetune = juce::jlimit (0.0f, 1.0f, detune);
+    const auto newUnisonDetune = juce::jlimit (0.0f, 1.0f, detune);
+    if (juce::exactlyEqual (newUnisonDetune, unisonDetune))
+        return;
+
+    unisonDetune = newUnisonDetune;
+    updateUnisonDetuneRatios();
 }
 
 void SynthVoice::setSubOctave (int octave)
@@ -374,19 +1332,59 @@ void SynthVoice::setSubOctave (int octave)
     subOctaveDown = juce::jlimit (1, 2, octave);
 }
 
+void SynthVoice::setModulationRoutes (const std::array<ModulationRoute, ModulationMatrix::numUserRoutes>& routes)
+{
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+        auto route = routes[i];
+        route.source = juce::jlimit (0, ModulationMatrix::numSources - 1, route.source);
+        route.destination = juce::jlimit (0, ModulationMatrix::numDestinations - 1, route.destination);
+        route.amount = juce::jlimit (-1.0f, 1.0f, route.amount);
+
+        auto& current = modulationRoutes[i];
+        if (route.source != current.source || route.destination != current.destination || ! juce::exactlyEqual (route.amount, current.amount))
+        {
+            current = route;
+            modulationRoutesChanged = true;
+        }
+    }
+}
+
 // === Helper Methods ===
 
-float SynthVoice::applyExponentialCurve (float linearValue)
+void SynthVoice::updateGlideRamp()
 {
-    // Apply exponential shaping for more natural envelope response
-    // y = x^2 gives a nice exponential feel for envelopes
-    return linearValue * linearValue;
+    // Update glide smoothing rate based on glide time
+    if (glideTime > 0.001f)
+        glidedFrequency.reset (currentSampleRate, glideTime);
+    else
+        glidedFrequency.reset (currentSampleRate, 0.0001);  // Instant
+}
+
+void SynthVoice::updateUnisonDetuneRatios()
+{
+    for (int voice = 0; voice < static_cast<int> (unisonDetuneRatios.size()); ++voice)
+        unisonDetuneRatios[static_cast<size_t> (voice)] = getUnisonDetuneRatio (voice, unisonVoices, unisonDetune);
+}
+
+float SynthVoice::getUnisonDetuneRatio (int voice, int numVoices, float detune)
+{
+    // Calculate detune amount for this voice
+    float detuneCents = 0.0f;
+    if (numVoices > 1 && detune > 0.01f && voice < numVoices)
+    {
+        // Spread voices evenly: -detune to +detune
+        float spread = (voice / static_cast<float> (numVoices - 1)) - 0.5f;  // -0.5 to +0.5
+        detuneCents = spread * detune * 100.0f;  // Up to +/- 100 cents at max detune
+    }
+
+    return std::pow (2.0f, detuneCents / 1200.0f);
 }
 
 void SynthVoice::updateFrequency()
 {
     // Convert MIDI note to frequency using equal temperament
-    targetFrequency = 440.0 * std::pow (2.0, (currentMidiNote - 69) / 12.0);
+    targetFrequency = tables->noteFrequency (currentMidiNote);
 
     // If glide is off, jump immediately
     if (glideTime < 0.001f)
@@ -423,63 +1421,34 @@ void SynthVoice::updateGlidedFrequency()
     }
 }
 
-float SynthVoice::generateOscillator()
-{
-    // PolyBLEP sawtooth oscillator
-    // Phase goes from 0 to 1
-    float output = static_cast<float> (phase * 2.0 - 1.0);  // Convert to -1 to 1
-
-    // Apply polyBLEP to smooth discontinuities
-    // Check for discontinuity at phase wrap (near 0)
-    output -= polyBlep (phase);
-
-    // Increment phase
-    phase += phaseDelta;
-
-    // Wrap phase
-    if (phase >= 1.0)
-        phase -= 1.0;
-
-    return output;
-}
-
-float SynthVoice::polyBlep (double t)
+double SynthVoice::polyBlep (double t, double dt)
 {
     // PolyBLEP (Polynomial Bandlimited Step) algorithm
-    // Reduces aliasing by smoothing discontinuities
-
-    double dt = phaseDelta;
+    // Reduces aliasing by smoothing discontinuities. dt is the saw's increment
 
     // Check for discontinuity near 0 (phase wrap)
     if (t < dt)
     {
         // Use polynomial to smooth the step
         t /= dt;
-        return static_cast<float> (t + t - t * t - 1.0);
+        return t + t - t * t - 1.0;
     }
     // Check for discontinuity near 1 (before wrap)
     else if (t > 1.0 - dt)
     {
         // Use polynomial to smooth the step
         t = (t - 1.0) / dt;
-        return static_cast<float> (t * t + t + t + 1.0);
+        return t * t + t + t + 1.0;
     }
 
     // No discontinuity, return 0
-    return 0.0f;
+    return 0.0;
 }
 
-float SynthVoice::generateSubOscillator()
+template <typename SampleType>
+SampleType SynthVoice::generateSubOscillator (double subPhase)
 {
-    // Pure sine wave for sub-bass (no polyBLEP needed for sine)
-    float output = std::sin (static_cast<float> (juce::MathConstants<double>::twoPi * subPhase));
-
-    // Increment phase
-    subPhase += subPhaseDelta;
-
-    // Wrap phase
-    if (subPhase >= 1.0)
-        subPhase -= 1.0;
-
-    return output;
+    // Pure sine wave for sub-bass (no polyBLEP needed for sine). Computed, not
+    // read from the table: it is audible, and the offline render runs it in double
+    return std::sin (static_cast<SampleType> (juce::MathConstants<double>::twoPi * subPhase));
 }
@@ -2,6 +2,13 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
+#include "DspTables.h"
+#include "EnvelopeGenerator.h"
+#include "GlobalModulation.h"
+#include "MidiControllerMap.h"
+#include "PrerenderCache.h"
+#include "VoiceBank.h"
+#include "VoiceParameters.h"
 
 class SynthSound : public juce::SynthesiserSound
 {
@@ -13,7 +20,8 @@ public:
 class SynthVoice : public juce::SynthesiserVoice
 {
 public:
-    SynthVoice();
+    // The oscillator phases live in the processor's VoiceBank, in column bankIndex
+    SynthVoice (VoiceBank& bank, int bankIndex);
 
     bool canPlaySound (juce::SynthesiserSound* sound) override;
 
@@ -25,12 +33,43 @@ public:
 
     void pitchWheelMoved (int newPitchWheelValue) override;
     void controllerMoved (int controllerNumber, int newControllerValue) override;
+    void channelPressureChanged (int newChannelPressureValue) override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock, int numChannels);
 
+    // Silences the voice and puts every bit of running state (controllers,
+    // LFO phases, filters, oversampling, random source) back to how
+    // prepareToPlay left it, so the next note renders like in a fresh instance
+    void reset();
+
     void renderNextBlock (juce::AudioBuffer<float>& outputBuffer,
                          int startSample,
                          int numSamples) override;
+    void renderNextBlock (juce::AudioBuffer<double>& outputBuffer,
+                         int startSample,
+                         int numSamples) override;
+
+    // Banked rendering (see BankSynthesiser): runs everything up to the
+    // oscillators for the next numSamples and writes this voice's phase
+    // increments into the bank, marking it active there. The next
+    // renderNextBlock renders from the phases the bank stepped instead of
+    // stepping them itself. Returns false
+    // if the voice won't render live there (idle, or playing cached audio)
+    bool prepareBankedChunk (int startSample, int numSamples);
+
+    // MIDI controller routing, owned by the processor
+    void setControllerMap (const MidiControllerMap* map) { controllerMap = map; }
+
+    // Controller events for the current processBlock, applied at their
+    // timestamps while rendering (audio thread, call before rendering the block)
+    void setControllerEvents (const ControllerEvent* events, int numEvents);
+
+    // Global LFO rows for the current processBlock (audio thread, call before
+    // rendering the block). nullptr = the voice runs its own LFOs
+    void setGlobalModulation (const float* lfo1, const float* lfo2);
+
+    // Applies a complete parameter snapshot (audio thread)
+    void setParameters (const VoiceParameters& params);
 
     // Parameter update methods
     void setFilterCutoff (float cutoff);
@@ -41,6 +80,7 @@ public:
     void setSubMix (float mix);
     void setLFORate (float rate);
     void setLFOAmount (float amount);
+    void setLFO2Rate (float rate);
     void setDriveAmount (float drive);
 
     // Phase 3 parameter update methods
@@ -52,16 +92,54 @@ public:
     void setUnisonDetune (float detune);
     void setSubOctave (int octave);
 
+    // The oversampling settings below take effect at the next note that
+    // starts from silence - switching a sounding note's filter or 2x pass
+    // would restart it from silence and click (audio thread)
+
+    // Runs the filter at the oversampled rate, sharing one up/down pass with
+    // the drive instead of filtering at the base rate
+    void setFilterOversampling (bool shouldOversample);
+
+    // Runs the drive at the base rate instead of 2x when off - the quality
+    // governor's cheaper setting
+    void setDriveOversampling (bool shouldOversample);
+
+    // Runs the oversampled stages at 4x instead of 2x - the offline quality
+    // profile
+    void setFourTimesOversampling (bool shouldUseFourTimes);
+
+    // How long a choked note takes to stop - short enough to be a hard stop,
+    // long enough not to click
+    static constexpr float chokeFadeSeconds = 0.001f;
+
+    // Fades the voice out over quietTailFadeSeconds if it's in its release
+    // and below the level (audio thread). Returns true if it was cut
+    static constexpr float quietTailFadeSeconds = 0.005f;
+    bool cutQuietTail (float level);
+
+    // User routes of the modulation matrix
+    void setModulationRoutes (const std::array<ModulationRoute, ModulationMatrix::numUserRoutes>& routes);
+
+    // Jumps the smoothed cutoff and resonance to their targets, for offline
+    // renders that start from a freshly prepared voice
+    void skipParameterSmoothing();
+
+    // Pre-rendered notes for static patches, owned by the processor. A voice
+    // playing one hands over to the live render when stopCachedPlayback() is
+    // called (the cache went stale), at note-off or on a controller change
+    void setPrerenderCache (PrerenderCache* cache) { prerenderCache = cache; }
+    void stopCachedPlayback();
+
 private:
-    // Oscillator state
-    double phase = 0.0;
+    // Oscillator state - unison saw and sub phases, see VoiceBank
+    VoiceBank& bank;
+    const int bankIndex;
     double frequency = 440.0;
     double phaseDelta = 0.0;
     int currentMidiNote = -1;
     float currentVelocity = 0.0f;
 
     // Sub-oscillator state (one octave down, pure sine)
-    double subPhase = 0.0;
     double subPhaseDelta = 0.0;
     float subMix = 0.0f;
 
@@ -69,33 +147,94 @@ private:
     double currentSampleRate = 44100.0;
 
     // Filter (Moog ladder filter)
-    using FilterType = juce::dsp::LadderFilter<float>;
-    FilterType filter;
+    // Exposes the per-sample API so cutoff modulation lands on the sample it was
+    // computed for, instead of only the last value of each block being used
+    template <typename SampleType>
+    class FilterType : public juce::dsp::LadderFilter<SampleType>
+    {
+    public:
+        using juce::dsp::LadderFilter<SampleType>::processSample;
+        using juce::dsp::LadderFilter<SampleType>::updateSmoothers;
+    };
+
+    // Everything downstream of the oscillators, in the host's sample type.
+    // Modulation and oscillator phases are the same for both precisions;
+    // only the path that matches the processBlock being called runs
+    template <typename SampleType>
+    struct SignalPath
+    {
+        SignalPath();
+
+        FilterType<SampleType> filter;
+        FilterType<SampleType> oversampledFilter;  // prepared at the oversampled rate
+        FilterType<SampleType> fourTimesFilter;    // prepared at 4x, for offline renders
+
+        // Drive/Saturation with oversampling (per bass guide: 2x), and the
+        // 4x pass offline renders take instead
+        juce::dsp::Oversampling<SampleType> oversampling;
+        juce::dsp::Oversampling<SampleType> fourTimesOversampling;
+
+        // Mono voice buffer - the voice is filtered and driven here before being
+        // added to the shared output, so voices never process each other's signal
+        juce::AudioBuffer<SampleType> buffer;
+    };
+    SignalPath<float> floatPath;
+    SignalPath<double> doublePath;
+
+    template <typename SampleType>
+    SignalPath<SampleType>& getSignalPath();
+
+    // Applies the same settings to both precisions' filters
+    template <typename Function>
+    void forEachFilter (Function&& function)
+    {
+        function (floatPath.filter);
+        function (floatPath.oversampledFilter);
+        function (floatPath.fourTimesFilter);
+        function (doublePath.filter);
+        function (doublePath.oversampledFilter);
+        function (doublePath.fourTimesFilter);
+    }
+
+    // LFO sine and note pitch tables, one set for every voice in the process
+    juce::SharedResourcePointer<DspTables> tables;
 
     // Smoothed filter parameters (prevents clicks/zippers)
     juce::SmoothedValue<float> smoothedCutoff;
     juce::SmoothedValue<float> smoothedResonance;
 
     // ADSR envelope for amplitude
-    juce::ADSR ampEnvelope;
-    juce::ADSR::Parameters ampEnvParams;
+    EnvelopeGenerator ampEnvelope;
+    EnvelopeGenerator::Parameters ampEnvParams;
 
     // ADSR envelope for filter cutoff modulation
-    juce::ADSR filterEnvelope;
-    juce::ADSR::Parameters filterEnvParams;
+    EnvelopeGenerator filterEnvelope;
+    EnvelopeGenerator::Parameters filterEnvParams;
     float filterEnvAmount = 0.0f;  // How much the envelope affects cutoff
 
-    // LFO for filter modulation
+    // LFO for filter modulation (per-voice mode)
     double lfoPhase = 0.0;
     float lfoRate = 1.0f;      // Hz
     float lfoAmount = 0.0f;    // 0-1
 
-    // Drive/Saturation with oversampling (per bass guide: 2x)
+    // Second LFO (triangle), matrix source only
+    double lfo2Phase = 0.0;
+    float lfo2Rate = 0.5f;     // Hz
+
+    // Shared LFO rows in global mode, indexed like the processBlock buffer
+    const float* globalLfo1 = nullptr;
+    const float* globalLfo2 = nullptr;
+
     float driveAmount = 0.0f;  // 0-1
-    juce::dsp::Oversampling<float> oversampling;
+    bool filterOversampled = false;
+    bool driveOversampled = true;
+    bool fourTimesOversampled = false;
 
-    // Temporary buffer for processing
-    juce::AudioBuffer<float> tempBuffer;
+    // What the setters asked for, applied between notes
+    bool pendingFilterOversampled = false;
+    bool pendingDriveOversampled = true;
+    bool pendingFourTimesOversampled = false;
+    void applyOversamplingSettings();
 
     // === Phase 3: Advanced Features ===
 
@@ -112,22 +251,184 @@ private:
     float filterKeyTrackAmount = 0.0f;  // 0-1
 
     // Unison (multiple detuned voices)
+    static constexpr int maxUnisonVoices = VoiceBank::maxUnisonVoices;
     int unisonVoices = 1;              // 1-5 voices
     float unisonDetune = 0.0f;         // 0-1 (detune amount)
-    std::array<double, 5> unisonPhases = {0.0};  // Phases for unison voices
 
     // Sub-oscillator octave
     int subOctaveDown = 1;  // 1 or 2 octaves down
 
-    // Exponential envelope shaping
-    float applyExponentialCurve (float linearValue);
+    // Detune ratio per unison voice, recalculated when the unison settings change
+    std::array<float, maxUnisonVoices> unisonDetuneRatios = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+    // === MIDI controllers ===
+    static constexpr double controllerSmoothingSeconds = 0.005;
+
+    const MidiControllerMap* controllerMap = nullptr;
+    const ControllerEvent* controllerEvents = nullptr;
+    int numControllerEvents = 0;
+    int nextControllerEvent = 0;
+
+    static constexpr size_t numControllerSources = static_cast<size_t> (ControllerSource::numSources);
+
+    // Smoothed controller value per source (0-1). Channel-wide controllers and
+    // per-note expression (MPE, CLAP note expressions) both land here, the
+    // modulation matrix decides where they go
+    std::array<juce::SmoothedValue<float>, numControllerSources> controllerValues;
+
+    // Latest channel-wide values, a new note starts from these
+    std::array<float, numControllerSources> globalControllerValues {};
+
+    // Latest per-note values sent on each MPE member channel, including the
+    // ones sent just before the note-on
+    struct ChannelExpression
+    {
+        double pitchRatio = 1.0;
+        std::array<float, numControllerSources> values {};
+        std::array<bool, numControllerSources> hasValue {};
+    };
+    std::array<ChannelExpression, 17> channelExpressions;  // indexed by MIDI channel
+
+    // Pitch bend as a frequency ratio, smoothed multiplicatively so it can be
+    // applied to the phase increments without a pow() per sample.
+    // The channel-wide bend and the per-note pitch multiply
+    juce::SmoothedValue<double, juce::ValueSmoothingTypes::Multiplicative> pitchBendRatio { 1.0 };
+    juce::SmoothedValue<double, juce::ValueSmoothingTypes::Multiplicative> notePitchRatio { 1.0 };
+
+    // CLAP per-note parameter modulation: offsets in the matrix destinations'
+    // units, smoothed like the controllers and added to the matrix rows. Only
+    // this note moves, the shared parameter values stay where they are
+    static constexpr std::array<ModDestination, 4> noteModulationDestinations {
+        ModDestination::cutoff, ModDestination::resonance, ModDestination::drive, ModDestination::detune
+    };
+    std::array<juce::SmoothedValue<float>, noteModulationDestinations.size()> noteModulation;
+    juce::AudioBuffer<float> noteModulationRows;  // one row per destination above
+    bool noteModulated = false;                   // an offset is non-zero or still ramping
+    bool noteModulationRendered = false;          // the rows hold the current chunk
+
+    // === Modulation matrix ===
+    // The user routes plus the fixed ones (filter envelope, velocity and key
+    // tracking -> cutoff), rebuilt before rendering when any of them changed
+    ModulationMatrix modulationMatrix;
+    std::array<ModulationRoute, ModulationMatrix::numUserRoutes> modulationRoutes = ModulationMatrix::getDefaultRoutes();
+    bool modulationRoutesChanged = true;
+
+    // One row per source / destination, sized to the block in prepareToPlay
+    juce::AudioBuffer<float> modulationSources;
+    juce::AudioBuffer<float> modulationDestinations;
+
+    // Pitch bend x per-note pitch, per sample of the chunk
+    juce::HeapBlock<double> pitchRatios;
+
+    // The saw's increment per sample of the chunk, bent and glided (polyBLEP width)
+    juce::HeapBlock<double> phaseDeltas;
+
+    // Per-note random source - fixed seed so renders are repeatable
+    juce::Random random { 0x5eed };
+
+    // === Pre-rendered playback ===
+    enum class CachePlayback { off, playing, handingOver };
+
+    PrerenderCache* prerenderCache = nullptr;
+    PrerenderCache::Entry* cachedEntry = nullptr;
+    CachePlayback cachePlayback = CachePlayback::off;
+    int cachedPosition = 0;
+    int handoverRemaining = 0;
+
+    bool areControllersAtRest() const;
+    void startCachedPlayback (bool wasIdle);
+    void releaseCachedEntry();
+    template <typename SampleType>
+    int renderCachedChunk (juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples);
+    template <typename SampleType>
+    void crossfadeFromCache (SampleType* voiceData, int numSamples);
 
     // Helper methods
+    template <typename SampleType>
+    void renderVoice (juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples);
+    template <typename SampleType>
+    void renderVoiceChunk (juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples);
+
+    // A chunk is rendered in two halves around the bank step: prepareChunk
+    // runs the modulation and writes the oscillator increments (the same for
+    // both precisions), finishChunk renders from the stepped phases
+    int prepareChunk (int startSample, int numSamples);
+    template <typename SampleType>
+    void finishChunk (juce::AudioBuffer<SampleType>& outputBuffer, int startSample);
+
+    // Per-sample render loop, specialised for each unison count and filter
+    // mode, so the inner loop carries no dead branches.
+    // The matrix rows are nullptr when nothing is routed there
+    // In oversampled mode the kernel leaves filtering to the 2x pass and
+    // writes the final cutoff and resonance per sample to filterCutoff and
+    // filterResonance instead (these may alias cutoff and resonance)
+    struct KernelRows
+    {
+        const float* cutoff;
+        const float* resonance;
+        const float* subMix;
+        const float* amp;
+        const float* ampEnvelope;
+        float velocityGain;
+        float* filterCutoff;
+        float* filterResonance;
+    };
+
+    // What prepareChunk left for finishChunk
+    struct PreparedChunk
+    {
+        KernelRows rows {};
+        const float* driveModulation = nullptr;
+        int numSamples = 0;
+    };
+    PreparedChunk preparedChunk;
+    bool bankedChunkPrepared = false;  // the synthesiser stepped the bank for it
+
+    template <typename SampleType>
+    using RenderKernel = void (SynthVoice::*) (SampleType*, const KernelRows&, int);
+
+    // Turns the pitch and detune rows into ratios once per chunk, one exp2 per
+    // sample each, so the increments are only multiplies. Returns the detune
+    // step row, 2^(cents between neighbouring unison voices / 2400) (nullptr
+    // when the unison spread isn't modulated)
+    const float* convertPitchRows (int numSamples, bool pitchModulated, bool detuneModulated);
+
+    // Writes the chunk's oscillator increments into the bank, specialised for
+    // each unison count and for whether a glide is running
+    using IncrementWriter = void (SynthVoice::*) (const float*, int);
+    static IncrementWriter getIncrementWriter (int numUnisonVoices, bool gliding);
+    template <int NumUnisonVoices, bool Gliding>
+    void writeOscillatorIncrements (const float* detuneStep, int numSamples);
+
+    template <typename SampleType>
+    static RenderKernel<SampleType> getRenderKernel (int numUnisonVoices, bool oversampledFilter);
+    template <typename SampleType, int NumUnisonVoices, bool OversampledFilter>
+    void renderKernel (SampleType* voiceData, const KernelRows& rows, int numSamples);
+
+    // The 2x stages: filter (oversampled mode) and drive, one up/down pass
+    template <typename SampleType>
+    void filterOversampledBlock (FilterType<SampleType>& filter, juce::dsp::AudioBlock<SampleType>& block,
+                                 const float* cutoff, const float* resonance, size_t factor);
+    template <typename SampleType>
+    void driveOversampledBlock (juce::dsp::AudioBlock<SampleType>& block, const float* driveModulation, size_t factor);
+    void applyControllerEvent (const ControllerEvent& event, bool smooth);
+    void rememberChannelExpression (const ControllerEvent& event);
+    bool isPlayingNoteFor (const ControllerEvent& event) const;
+    void startNoteExpression();
+    void skipControllerEvents (int endSample);
+    juce::SmoothedValue<float>& getControllerValue (ControllerSource source);
+    static int getNoteModulationIndex (ModDestination destination);
+    void resetNoteModulation();
+    void updateModulationRoutes();
+    int renderModulationSources (int startSample, int numSamples);
+    void updateUnisonDetuneRatios();
+    static float getUnisonDetuneRatio (int voice, int numVoices, float detune);
+    void updateGlideRamp();
     void updateFrequency();
     void updateGlidedFrequency();
-    float generateOscillator();     // PolyBLEP sawtooth
-    float generateSubOscillator();  // Pure sine wave, -1 or -2 octaves
-    float polyBlep (double t);      // PolyBLEP correction function
+    template <typename SampleType>
+    SampleType generateSubOscillator (double subPhase);  // Pure sine wave, -1 or -2 octaves
+    static double polyBlep (double t, double dt);        // PolyBLEP correction function
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SynthVoice)
 };
@@ -0,0 +1,154 @@
+#include "VoiceBank.h"
+
+VoiceBank::VoiceBank (int numVoicesToAllocate)
+    : numVoices (numVoicesToAllocate),
+      laneStride ((numVoicesToAllocate + voicesPerLine - 1) / voicesPerLine * voicesPerLine)
+{
+    jassert (numVoices > 0);
+
+    // One spare line so the first lane can start on a cache line boundary
+    phaseStorage.calloc (static_cast<size_t> (numLanes * laneStride + voicesPerLine));
+    phases = juce::snapPointerToAlignment (phaseStorage.get(), alignment);
+
+    activeVoices.reserve (static_cast<size_t> (numVoices));
+    voiceActive.assign (static_cast<size_t> (laneStride), false);
+}
+
+void VoiceBank::prepare (int maxBlockSize)
+{
+    // As many samples as fit the L1 budget, but never more than a block
+    const auto bytesPerSample = static_cast<size_t> (numLanes * laneStride) * sizeof (double);
+    tileSize = juce::jlimit (1, juce::jmax (1, maxBlockSize), static_cast<int> (tileBytes / bytesPerSample));
+
+    rowStorage.calloc (static_cast<size_t> (tileSize * numLanes * laneStride + voicesPerLine));
+    rows = juce::snapPointerToAlignment (rowStorage.get(), alignment);
+    beginTile();
+}
+
+void VoiceBank::resetVoice (int voice)
+{
+    jassert (juce::isPositiveAndBelow (voice, numVoices));
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        phase (lane, voice) = 0.0;
+}
+
+void VoiceBank::clearIncrements (int voice, int fromSample, int toSample)
+{
+    jassert (juce::isPositiveAndBelow (voice, laneStride) && toSample <= tileSize);
+
+    for (int sample = fromSample; sample < toSample; ++sample)
+        for (int lane = 0; lane < numLanes; ++lane)
+            increment (sample, lane, voice) = 0.0;
+}
+
+void VoiceBank::beginTile()
+{
+    for (const auto voice : activeVoices)
+        voiceActive[static_cast<size_t> (voice)] = false;
+
+    activeVoices.clear();
+}
+
+void VoiceBank::markActive (int voice)
+{
+    jassert (juce::isPositiveAndBelow (voice, numVoices));
+
+    if (! voiceActive[static_cast<size_t> (voice)])
+    {
+        voiceActive[static_cast<size_t> (voice)] = true;
+        activeVoices.push_back (voice);
+    }
+}
+
+void VoiceBank::stepActive (int numSamples)
+{
+    jassert (numSamples <= tileSize);
+
+    // A lone voice: a line step would mostly move idle voices
+    if (getNumActiveVoices() < minVoicesToStepTogether)
+    {
+        for (const auto voice : activeVoices)
+            stepVoice (voice, numSamples);
+        return;
+    }
+
+    for (int line = 0; line < laneStride / voicesPerLine; ++line)
+    {
+        // Voices sitting this tile out keep their phases: their (stale)
+        // increments are masked to zero rather than cleared
+        std::array<double, voicesPerLine> mask {};
+        bool lineActive = false;
+
+        for (int i = 0; i < voicesPerLine; ++i)
+        {
+            const bool active = voiceActive[static_cast<size_t> (line * voicesPerLine + i)];
+            mask[static_cast<size_t> (i)] = active ? 1.0 : 0.0;
+            lineActive = lineActive || active;
+        }
+
+        if (lineActive)
+            stepLine (line, numSamples, mask);
+    }
+}
+
+void VoiceBank::stepAll (int numSamples)
+{
+    jassert (numSamples <= tileSize);
+
+    std::array<double, voicesPerLine> mask;
+    mask.fill (1.0);
+
+    for (int line = 0; line < laneStride / voicesPerLine; ++line)
+        stepLine (line, numSamples, mask);
+}
+
+void VoiceBank::stepLine (int line, int numSamples, const std::array<double, voicesPerLine>& activeMask)
+{
+    // One line of a lane is eight voices side by side. The phases and the mask
+    // are copied out for the tile, so nothing aliases the rows and the inner
+    // loop is a fixed-width vector pass
+    const int first = line * voicesPerLine;
+    const auto mask = activeMask;
+    std::array<double, numLanes * voicesPerLine> current;
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        std::copy_n (phases + lane * laneStride + first, voicesPerLine, current.begin() + lane * voicesPerLine);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto* row = rows + (sample * numLanes + lane) * laneStride + first;
+            auto* lanePhases = current.data() + lane * voicesPerLine;
+
+            for (int i = 0; i < voicesPerLine; ++i)
+            {
+                const auto phase = lanePhases[i];
+                const auto next = phase + row[i] * mask[static_cast<size_t> (i)];
+                row[i] = phase;
+                lanePhases[i] = next >= 1.0 ? next - 1.0 : next;
+            }
+        }
+    }
+
+    for (int lane = 0; lane < numLanes; ++lane)
+        std::copy_n (current.begin() + lane * voicesPerLine, voicesPerLine, phases + lane * laneStride + first);
+}
+
+void VoiceBank::stepVoice (int voice, int numSamples)
+{
+    jassert (juce::isPositiveAndBelow (voice, numVoices) && numSamples <= tileSize);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto& value = increment (sample, lane, voice);
+            auto& current = phase (lane, voice);
+            const auto next = current + value;
+            value = current;
+            current = next >= 1.0 ? next - 1.0 : next;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <vector>
+
+// Oscillator phases and increments of every voice, as voice-indexed lanes
+//
+// Structure of arrays: one lane per oscillator (the unison saws, then the
+// sub), each lane holding that oscillator's value for every voice side by
+// side in aligned 64-byte lines. Voices write the per-sample increments of
+// a tile into the step rows, then stepActive() advances the oscillators of
+// the voices that wrote them, a line of voices at a time, and leaves the
+// phase each oscillator had at each sample in the rows for the voices to
+// render from.
+//
+// The rows only ever hold one tile, sized so they stay in L1 (tileBytes)
+// however large the host's blocks are. With only a few voices sounding (the
+// common mono bass) each steps just its own column: a line step costs the
+// same however many of its voices are idle, and only pays off from
+// minVoicesToStepTogether up (see the voice bank benchmark).
+//
+// A voice rendering on its own (cached playback handing over, offline
+// renders) writes its increments the same way and steps just its column.
+class VoiceBank
+{
+public:
+    static constexpr int maxUnisonVoices = 5;
+    static constexpr int subLane = maxUnisonVoices;
+    static constexpr int numLanes = maxUnisonVoices + 1;
+    static constexpr int voicesPerLine = 8;  // one cache line of doubles
+    static constexpr size_t alignment = voicesPerLine * sizeof (double);
+    static constexpr size_t tileBytes = 16 * 1024;  // half a typical L1 data cache
+    static constexpr int minVoicesToStepTogether = 6;
+
+    explicit VoiceBank (int numVoices);
+
+    // Step rows for one tile, at most maxBlockSize samples (message thread)
+    void prepare (int maxBlockSize);
+
+    int getNumVoices() const { return numVoices; }
+
+    // Samples per tile, 0 until prepared
+    int getTileSize() const { return tileSize; }
+
+    // Distance between one voice's values in consecutive lanes
+    int getLaneStride() const { return laneStride; }
+
+    // The running phase (0-1) of one oscillator
+    double& phase (int lane, int voice) { return phases[lane * laneStride + voice]; }
+    void resetVoice (int voice);
+
+    // The increment of one oscillator at one sample of the tile, written
+    // before stepping. Stepping replaces it with the phase at that sample
+    double& increment (int sample, int lane, int voice) { return rows[(sample * numLanes + lane) * laneStride + voice]; }
+    double phaseAt (int sample, int lane, int voice) const { return rows[(sample * numLanes + lane) * laneStride + voice]; }
+
+    // Zeroes one voice's increments, so its phases stand still there
+    void clearIncrements (int voice, int fromSample, int toSample);
+
+    // === Stepping a tile (audio thread) ===
+    // Forget the voices of the previous tile, then mark every voice that
+    // wrote its increments for this one
+    void beginTile();
+    void markActive (int voice);
+    int getNumActiveVoices() const { return static_cast<int> (activeVoices.size()); }
+
+    // The marked voices: alone when there are few of them, otherwise every
+    // line holding one, with its unmarked voices' increments masked out
+    void stepActive (int numSamples);
+
+    // Every line of the bank, marked or not
+    void stepAll (int numSamples);
+
+    // One voice's oscillators only
+    void stepVoice (int voice, int numSamples);
+
+private:
+    void stepLine (int line, int numSamples, const std::array<double, voicesPerLine>& activeMask);
+
+    int numVoices = 0;
+    int laneStride = 0;  // voices rounded up to whole lines
+    int tileSize = 0;
+
+    juce::HeapBlock<double> phaseStorage;
+    double* phases = nullptr;
+
+    juce::HeapBlock<double> rowStorage;
+    double* rows = nullptr;
+
+    // Reserved for every voice up front, so marking never allocates
+    std::vector<int> activeVoices;
+    std::vector<bool> voiceActive;
+
+    JUCE_DECLARE_NON_COPYABLE (VoiceBank)
+};
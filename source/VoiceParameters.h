@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ModulationMatrix.h"
+#include "PresetManager.h"
+
+// Complete set of synthesis parameters a voice needs, in plain (denormalised)
+// units. Trivially copyable, so it can be built on the message thread and
+// handed to the audio thread through a lock-free mailbox as one unit
+struct VoiceParameters
+{
+    // Oscillator
+    float subMix = 0.5f;
+    int subOctave = 1;  // 1 or 2 octaves down
+
+    // Filter
+    float filterCutoff = 1000.0f;
+    float filterResonance = 0.5f;
+    float filterKeyTrack = 0.0f;
+
+    // Filter Envelope
+    float filterEnvAttack = 0.01f;
+    float filterEnvDecay = 0.2f;
+    float filterEnvSustain = 0.3f;
+    float filterEnvRelease = 0.2f;
+    float filterEnvAmount = 0.5f;
+
+    // Amp Envelope
+    float ampAttack = 0.01f;
+    float ampDecay = 0.1f;
+    float ampSustain = 0.8f;
+    float ampRelease = 0.1f;
+
+    // LFO
+    float lfoRate = 2.0f;
+    float lfoAmount = 0.0f;
+    float lfo2Rate = 0.5f;
+
+    // Modulation matrix (user routes - the fixed ones follow the settings below)
+    std::array<ModulationRoute, ModulationMatrix::numUserRoutes> modRoutes = ModulationMatrix::getDefaultRoutes();
+
+    // Modulation
+    float velocityToFilter = 0.5f;
+    float velocityToAmp = 0.7f;
+
+    // Unison
+    int unisonVoices = 1;
+    float unisonDetune = 0.0f;
+
+    // Misc
+    float driveAmount = 0.0f;
+    float glideTime = 0.0f;
+
+    // Presets don't store LFO 2 or the matrix routes, those keep their defaults
+    static VoiceParameters fromPreset (const Preset& preset)
+    {
+        VoiceParameters p;
+        p.subMix = preset.subMix;
+        p.subOctave = preset.subOctave + 1;  // Preset stores the choice index (0,1)
+        p.filterCutoff = preset.filterCutoff;
+        p.filterResonance = preset.filterResonance;
+        p.filterKeyTrack = preset.filterKeyTrack;
+        p.filterEnvAttack = preset.filterEnvAttack;
+        p.filterEnvDecay = preset.filterEnvDecay;
+        p.filterEnvSustain = preset.filterEnvSustain;
+        p.filterEnvRelease = preset.filterEnvRelease;
+        p.filterEnvAmount = preset.filterEnvAmount;
+        p.ampAttack = preset.ampAttack;
+        p.ampDecay = preset.ampDecay;
+        p.ampSustain = preset.ampSustain;
+        p.ampRelease = preset.ampRelease;
+        p.lfoRate = preset.lfoRate;
+        p.lfoAmount = preset.lfoAmount;
+        p.velocityToFilter = preset.velocityToFilter;
+        p.velocityToAmp = preset.velocityToAmp;
+        p.unisonVoices = preset.unisonVoices;
+        p.unisonDetune = preset.unisonDetune;
+        p.driveAmount = preset.driveAmount;
+        p.glideTime = preset.glideTime;
+        return p;
+    }
+};
+
+static_assert (std::is_trivially_copyable_v<VoiceParameters>);
@@ -0,0 +1,125 @@
+#include <EnvelopeGenerator.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    EnvelopeGenerator makeEnvelope (float attack, float decay, float sustain, float release)
+    {
+        EnvelopeGenerator envelope;
+        envelope.setSampleRate (sampleRate);
+        envelope.setParameters ({ attack, decay, sustain, release });
+        return envelope;
+    }
+}
+
+TEST_CASE ("Exponential envelope segments", "[envelope]")
+{
+    auto envelope = makeEnvelope (0.01f, 0.1f, 0.5f, 0.1f);
+    std::vector<float> output (48000);
+
+    envelope.noteOn();
+    REQUIRE (envelope.process (output.data(), static_cast<int> (output.size())) == static_cast<int> (output.size()));
+
+    SECTION ("attack reaches the peak in the attack time")
+    {
+        const auto peak = std::max_element (output.begin(), output.end());
+        CHECK (*peak == 1.0f);
+        CHECK (std::distance (output.begin(), peak) == Catch::Approx (480).margin (2));
+    }
+
+    SECTION ("decay settles on the sustain level")
+    {
+        CHECK (output.back() == 0.5f);
+    }
+
+    SECTION ("release curves down exponentially")
+    {
+        envelope.noteOff();
+        std::vector<float> release (480);
+        envelope.process (release.data(), static_cast<int> (release.size()));
+
+        // A one-pole release drops fastest at the start
+        CHECK (release[0] - release[100] > release[100] - release[200]);
+    }
+}
+
+TEST_CASE ("Envelope retires mid-block", "[envelope]")
+{
+    SECTION ("release below -96 dB ends the envelope at that sample")
+    {
+        auto envelope = makeEnvelope (0.001f, 0.01f, 1.0f, 0.05f);
+        std::vector<float> output (48000);
+
+        envelope.noteOn();
+        envelope.process (output.data(), 4800);
+        envelope.noteOff();
+
+        const auto activeSamples = envelope.process (output.data(), static_cast<int> (output.size()));
+        CHECK_FALSE (envelope.isActive());
+        CHECK (activeSamples > 0);
+        CHECK (activeSamples <= 2400);  // 50ms release
+        CHECK (output[static_cast<size_t> (activeSamples - 1)] >= EnvelopeGenerator::silenceThreshold);
+        CHECK (output[static_cast<size_t> (activeSamples)] == 0.0f);
+    }
+
+    SECTION ("a fast release ends the envelope within its time")
+    {
+        auto envelope = makeEnvelope (0.001f, 0.01f, 1.0f, 2.0f);
+        std::vector<float> output (48000);
+
+        envelope.noteOn();
+        envelope.process (output.data(), 4800);
+        envelope.noteOff();
+        envelope.process (output.data(), 480);
+
+        // Parameter updates don't bring the slow release back
+        envelope.fastRelease (0.005f);
+        envelope.setParameters ({ 0.001f, 0.01f, 1.0f, 2.0f });
+
+        const auto activeSamples = envelope.process (output.data(), static_cast<int> (output.size()));
+        CHECK_FALSE (envelope.isActive());
+        CHECK (activeSamples <= 240);  // 5ms
+        CHECK (output[0] > 0.5f);      // it fades from where it was
+
+        // The next note releases at the set time again
+        envelope.noteOn();
+        envelope.process (output.data(), 4800);
+        envelope.noteOff();
+        CHECK (envelope.process (output.data(), static_cast<int> (output.size())) == static_cast<int> (output.size()));
+    }
+
+    SECTION ("a decay to zero sustain ends the envelope")
+    {
+        auto envelope = makeEnvelope (0.001f, 0.05f, 0.0f, 1.0f);
+        std::vector<float> output (48000);
+
+        envelope.noteOn();
+        CHECK (envelope.process (output.data(), static_cast<int> (output.size())) < 4800);
+        CHECK_FALSE (envelope.isActive());
+    }
+
+    SECTION ("block splits don't move the end")
+    {
+        auto whole = makeEnvelope (0.001f, 0.01f, 0.7f, 0.2f);
+        auto split = makeEnvelope (0.001f, 0.01f, 0.7f, 0.2f);
+        std::vector<float> output (48000);
+
+        for (auto* envelope : { &whole, &split })
+        {
+            envelope->noteOn();
+            envelope->process (output.data(), 1000);
+            envelope->noteOff();
+        }
+
+        const auto wholeEnd = whole.process (output.data(), 20000);
+
+        int splitEnd = 0;
+        while (split.isActive())
+            splitEnd += split.process (output.data(), 37);
+
+        CHECK (splitEnd == wholeEnd);
+    }
+}
@@ -0,0 +1,113 @@
+#include <FxRack.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int numBlocks = 40;
+
+    // Stereo sine, the right channel a quarter cycle behind the left
+    void fillSine (juce::AudioBuffer<float>& buffer, double frequency, float gain, int startSample)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, gain * static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * frequency * (startSample + i) / sampleRate + ch * juce::MathConstants<double>::halfPi)));
+    }
+
+    // Runs numBlocks of the sine through the rack, returns the last block
+    juce::AudioBuffer<float> process (const FxSettings& settings, double frequency, float gain)
+    {
+        FxRack<float> rack;
+        rack.prepare (sampleRate, blockSize, 2);
+
+        juce::AudioBuffer<float> buffer (2, blockSize);
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            fillSine (buffer, frequency, gain, block * blockSize);
+            rack.setSettings (settings);
+            rack.process (buffer);
+        }
+        return buffer;
+    }
+}
+
+TEST_CASE ("FX rack", "[fx]")
+{
+    SECTION ("a fully bypassed rack leaves the signal untouched")
+    {
+        juce::AudioBuffer<float> dry (2, blockSize);
+        fillSine (dry, 55.0, 0.5f, (numBlocks - 1) * blockSize);
+
+        const auto wet = process ({}, 55.0, 0.5f);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < blockSize; ++i)
+                REQUIRE (wet.getSample (ch, i) == dry.getSample (ch, i));
+    }
+
+    SECTION ("the mono-maker sums the low end to mono")
+    {
+        FxSettings settings;
+        settings.monoEnabled = true;
+
+        const auto wet = process (settings, 40.0, 0.5f);
+        float peakSide = 0.0f;
+        for (int i = 0; i < blockSize; ++i)
+            peakSide = std::max (peakSide, std::abs (wet.getSample (0, i) - wet.getSample (1, i)));
+
+        // The dry quarter-cycle offset puts the side signal near 0.7
+        CHECK (peakSide < 0.1f);
+    }
+
+    SECTION ("the chorus widens a mono signal, the mono-maker narrows its lows again")
+    {
+        // The voices are mono: both channels carry the same signal
+        auto processMono = [] (const FxSettings& settings, double frequency) {
+            FxRack<float> rack;
+            rack.prepare (sampleRate, blockSize, 2);
+
+            juce::AudioBuffer<float> buffer (2, blockSize);
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample (ch, i, 0.5f * static_cast<float> (std::sin (juce::MathConstants<double>::twoPi * frequency * (block * blockSize + i) / sampleRate)));
+
+                rack.setSettings (settings);
+                rack.process (buffer);
+            }
+            return buffer;
+        };
+
+        auto peakSide = [] (const juce::AudioBuffer<float>& buffer) {
+            float peak = 0.0f;
+            for (int i = 0; i < blockSize; ++i)
+                peak = std::max (peak, std::abs (buffer.getSample (0, i) - buffer.getSample (1, i)));
+            return peak;
+        };
+
+        FxSettings settings;
+        settings.chorusEnabled = true;
+        settings.chorusRate = 2.0f;
+        settings.chorusMix = 0.5f;
+
+        CHECK (peakSide (processMono (settings, 40.0)) > 0.01f);
+        CHECK (peakSide (processMono (settings, 2000.0)) > 0.1f);
+
+        settings.monoEnabled = true;
+        const auto narrowed = peakSide (processMono (settings, 40.0));
+        settings.monoEnabled = false;
+        CHECK (narrowed < 0.25f * peakSide (processMono (settings, 40.0)));
+    }
+
+    SECTION ("the compressor reduces loud peaks")
+    {
+        FxSettings settings;
+        settings.compressorEnabled = true;
+        settings.compressorThreshold = -24.0f;
+        settings.compressorRatio = 8.0f;
+
+        const auto wet = process (settings, 110.0, 0.9f);
+        CHECK (wet.getMagnitude (0, 0, blockSize) < 0.5f);
+    }
+}
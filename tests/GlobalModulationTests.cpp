@@ -0,0 +1,88 @@
+#include "helpers/render_helpers.h"
+#include <GlobalModulation.h>
+#include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int totalSamples = 24000;
+
+    juce::AudioBuffer<float> render (bool globalLfo, int blockSize = 256)
+    {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getAPVTS();
+        apvts.getParameter (PluginProcessor::LFO_MODE_ID)->setValueNotifyingHost (globalLfo ? 1.0f : 0.0f);
+        apvts.getParameter (PluginProcessor::LFO_AMOUNT_ID)->setValueNotifyingHost (0.8f);
+
+        // Two notes a third of a second apart, so per-voice LFOs are out of phase
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0);
+        midi.addEvent (juce::MidiMessage::noteOn (1, 43, (juce::uint8) 100), 16000);
+        midi.addEvent (juce::MidiMessage::allNotesOff (1), totalSamples - 4000);
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        auto output = render_helpers::renderMidi (plugin, midi, totalSamples, blockSize);
+        plugin.releaseResources();
+        return output;
+    }
+}
+
+TEST_CASE ("Global LFO", "[modulation]")
+{
+    GlobalModulation modulation;
+    modulation.prepare (sampleRate, 512);
+
+    SECTION ("free-running LFOs start at phase zero")
+    {
+        REQUIRE (modulation.process (512, 2.0f, 0.5f, 0, nullptr));
+        CHECK (modulation.getLfo1()[0] == 0.0f);
+        CHECK (modulation.getLfo2()[0] == Catch::Approx (-1.0f));
+    }
+
+    SECTION ("blocks larger than prepared fall back to the voices")
+    {
+        CHECK_FALSE (modulation.process (1024, 2.0f, 0.5f, 0, nullptr));
+    }
+
+    SECTION ("advancing without rendering keeps the phase")
+    {
+        GlobalModulation rendered;
+        rendered.prepare (sampleRate, 512);
+
+        REQUIRE (rendered.process (300, 2.0f, 0.5f, 0, nullptr));
+        modulation.advance (300, 2.0f, 0.5f, 0, nullptr);
+
+        REQUIRE (rendered.process (1, 2.0f, 0.5f, 0, nullptr));
+        REQUIRE (modulation.process (1, 2.0f, 0.5f, 0, nullptr));
+        CHECK (modulation.getLfo1()[0] == Catch::Approx (rendered.getLfo1()[0]).margin (1.0e-5));
+        CHECK (modulation.getLfo2()[0] == Catch::Approx (rendered.getLfo2()[0]).margin (1.0e-5));
+    }
+
+    SECTION ("tempo sync locks to the song position")
+    {
+        juce::AudioPlayHead::PositionInfo position;
+        position.setBpm (120.0);
+        position.setIsPlaying (true);
+        position.setPpqPosition (1.25);  // a quarter of the way into a 1/4 cycle
+
+        const auto quarterNote = GlobalModulation::getSyncNames().indexOf ("1/4");
+        REQUIRE (modulation.process (512, 2.0f, 0.5f, quarterNote, &position));
+        CHECK (modulation.getLfo1()[0] == Catch::Approx (1.0f));
+    }
+}
+
+TEST_CASE ("Global LFO mode renders", "[modulation]")
+{
+    SECTION ("shared phase sounds different from per-voice phases")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (false), render (true)) > 0.01f);
+    }
+
+    SECTION ("global renders don't depend on the block size")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (true, 64), render (true, 512)) < 1.0e-5f);
+    }
+}
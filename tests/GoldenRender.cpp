@@ -0,0 +1,273 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+/* Golden-render regression tests.
+ *
+ * Every factory preset is rendered through a fixed MIDI phrase and compared
+ * against a stored reference render in tests/golden. The comparison is
+ * tolerance based (time-domain error + band spectrum) so DSP optimisations
+ * that change rounding, but not the sound, still pass.
+ *
+ * The references are only ever written on request. To (re)generate them,
+ * build the Tests target from the tree whose sound is intended and run
+ *   THICC_BASS_REGENERATE_GOLDEN=1 ./Tests "[golden]"
+ * then commit tests/golden/*.wav. While tests/golden holds no references at
+ * all the comparison is skipped (reported, not passed); once any are there,
+ * every preset and rate needs one and a missing reference fails the test.
+ */
+
+namespace
+{
+    // Rendered at these block sizes, all compared against the same reference
+    constexpr int referenceBlockSize = 512;
+    constexpr int blockSizes[] = { 64, 480, 1024 };
+
+    // Tolerances against stored references (covers compiler / platform drift)
+    constexpr float maxRelativeErrorDecibels = -40.0f;
+    constexpr float maxBandDifferenceDecibels = 1.0f;
+    constexpr float bandFloorDecibels = -60.0f;
+
+    juce::File getGoldenDirectory()
+    {
+        return juce::File (THICC_BASS_GOLDEN_DIR);
+    }
+
+    bool shouldRegenerateReferences()
+    {
+        return juce::SystemStats::getEnvironmentVariable ("THICC_BASS_REGENERATE_GOLDEN", {}).getIntValue() != 0;
+    }
+
+    bool hasAnyReferences()
+    {
+        return getGoldenDirectory().getNumberOfChildFiles (juce::File::findFiles, "*.wav") > 0;
+    }
+
+    juce::File getReferenceFile (const Preset& preset, double sampleRate)
+    {
+        auto name = preset.name.replaceCharacter (' ', '_') + "_" + juce::String (juce::roundToInt (sampleRate)) + ".wav";
+        return getGoldenDirectory().getChildFile (name);
+    }
+
+    void writeReference (const juce::File& file, const juce::AudioBuffer<float>& buffer, double sampleRate)
+    {
+        file.getParentDirectory().createDirectory();
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (file),
+            sampleRate,
+            static_cast<unsigned int> (buffer.getNumChannels()),
+            32,
+            {},
+            0));
+
+        REQUIRE (writer != nullptr);
+        writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+    }
+
+    juce::AudioBuffer<float> readReference (const juce::File& file)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        REQUIRE (reader != nullptr);
+
+        juce::AudioBuffer<float> buffer (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return buffer;
+    }
+
+    void checkBandSpectraMatch (const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& test, double sampleRate)
+    {
+        const auto referenceBands = render_helpers::bandSpectrumDecibels (reference, sampleRate);
+        const auto testBands = render_helpers::bandSpectrumDecibels (test, sampleRate);
+        const auto loudestBand = *std::max_element (referenceBands.begin(), referenceBands.end());
+
+        for (size_t b = 0; b < referenceBands.size(); ++b)
+        {
+            // Bands far below the loudest one are dominated by numerical noise
+            if (referenceBands[b] < loudestBand + bandFloorDecibels)
+                continue;
+
+            INFO ("band " << b);
+            CHECK (std::abs (testBands[b] - referenceBands[b]) < maxBandDifferenceDecibels);
+        }
+    }
+}
+
+TEST_CASE ("Factory presets match golden renders", "[golden]")
+{
+    const PresetManager presetManager;
+    const auto presetIndex = GENERATE (range (0, 5));
+    const auto sampleRate = GENERATE (44100.0, 48000.0, 96000.0);
+
+    REQUIRE (presetIndex < static_cast<int> (presetManager.getPresets().size()));
+    const auto& preset = presetManager.getPresets()[static_cast<size_t> (presetIndex)];
+    const auto referenceFile = getReferenceFile (preset, sampleRate);
+
+    INFO (preset.name << " @ " << sampleRate << " Hz");
+
+    if (shouldRegenerateReferences())
+    {
+        writeReference (referenceFile, render_helpers::renderFactoryPreset (presetIndex, sampleRate, referenceBlockSize), sampleRate);
+        WARN ("Wrote golden reference " << referenceFile.getFullPathName());
+        return;
+    }
+
+    if (! hasAnyReferences())
+        SKIP ("No golden references in " << getGoldenDirectory().getFullPathName()
+              << " - render them with THICC_BASS_REGENERATE_GOLDEN=1 and commit them");
+
+    if (! referenceFile.existsAsFile())
+        FAIL ("Missing golden reference " << referenceFile.getFullPathName()
+              << " - regenerate the references with THICC_BASS_REGENERATE_GOLDEN=1 and commit them");
+
+    const auto reference = readReference (referenceFile);
+
+    for (const auto blockSize : blockSizes)
+    {
+        INFO ("block size " << blockSize);
+        const auto render = render_helpers::renderFactoryPreset (presetIndex, sampleRate, blockSize);
+
+        REQUIRE (render.getNumChannels() == reference.getNumChannels());
+        REQUIRE (render.getNumSamples() == reference.getNumSamples());
+
+        CHECK (render_helpers::relativeErrorDecibels (reference, render) < maxRelativeErrorDecibels);
+        checkBandSpectraMatch (reference, render, sampleRate);
+    }
+}
+
+TEST_CASE ("Render output is independent of block size", "[golden]")
+{
+    const auto presetIndex = GENERATE (range (0, 5));
+    const double sampleRate = 48000.0;
+
+    const auto small = render_helpers::renderFactoryPreset (presetIndex, sampleRate, 32);
+    const auto odd = render_helpers::renderFactoryPreset (presetIndex, sampleRate, 333);
+    const auto large = render_helpers::renderFactoryPreset (presetIndex, sampleRate, 2048);
+
+    INFO ("preset " << presetIndex);
+    CHECK (render_helpers::peakAbsoluteDifference (small, large) < 1.0e-5f);
+    CHECK (render_helpers::peakAbsoluteDifference (odd, large) < 1.0e-5f);
+}
+
+TEST_CASE ("Double precision renders match single precision", "[golden]")
+{
+    const auto presetIndex = GENERATE (range (0, 5));
+    const double sampleRate = 48000.0;
+
+    const auto single = render_helpers::renderFactoryPreset (presetIndex, sampleRate, 512);
+    const auto doubleRender = render_helpers::renderFactoryPreset<double> (presetIndex, sampleRate, 512);
+
+    juce::AudioBuffer<float> converted (doubleRender.getNumChannels(), doubleRender.getNumSamples());
+    for (int ch = 0; ch < converted.getNumChannels(); ++ch)
+        for (int i = 0; i < converted.getNumSamples(); ++i)
+            converted.setSample (ch, i, static_cast<float> (doubleRender.getSample (ch, i)));
+
+    // Same DSP, only the rounding differs
+    INFO ("preset " << presetIndex);
+    CHECK (render_helpers::relativeErrorDecibels (single, converted) < -60.0f);
+}
+
+TEST_CASE ("Every unison kernel is independent of block size", "[golden]")
+{
+    const auto unisonVoices = GENERATE (range (1, 6));
+    const double sampleRate = 48000.0;
+
+    auto render = [&] (int blockSize) {
+        PluginProcessor plugin;
+        auto* unison = plugin.getAPVTS().getParameter (PluginProcessor::UNISON_VOICES_ID);
+        unison->setValueNotifyingHost (unison->convertTo0to1 (static_cast<float> (unisonVoices)));
+        plugin.getAPVTS().getParameter (PluginProcessor::UNISON_DETUNE_ID)->setValueNotifyingHost (0.5f);
+        plugin.getAPVTS().getParameter (PluginProcessor::GLIDE_TIME_ID)->setValueNotifyingHost (0.3f);
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        const auto totalSamples = static_cast<int> (render_helpers::phraseLengthSeconds * sampleRate);
+        auto output = render_helpers::renderMidi (plugin, render_helpers::makeFixedPhrase (sampleRate), totalSamples, blockSize);
+        plugin.releaseResources();
+        return output;
+    };
+
+    INFO ("unison voices " << unisonVoices);
+    CHECK (render_helpers::peakAbsoluteDifference (render (37), render (1024)) < 1.0e-5f);
+}
+
+TEST_CASE ("HQ filter runs filter and drive oversampled", "[golden]")
+{
+    const double sampleRate = 48000.0;
+
+    auto render = [&] (bool hqFilter, int blockSize) {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getAPVTS();
+        apvts.getParameter (PluginProcessor::FILTER_OVERSAMPLING_ID)->setValueNotifyingHost (hqFilter ? 1.0f : 0.0f);
+        apvts.getParameter (PluginProcessor::FILTER_RESONANCE_ID)->setValueNotifyingHost (0.9f);
+        apvts.getParameter (PluginProcessor::DRIVE_AMOUNT_ID)->setValueNotifyingHost (0.8f);
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        const auto totalSamples = static_cast<int> (render_helpers::phraseLengthSeconds * sampleRate);
+        auto output = render_helpers::renderMidi (plugin, render_helpers::makeFixedPhrase (sampleRate), totalSamples, blockSize);
+        plugin.releaseResources();
+        return output;
+    };
+
+    const auto hq = render (true, 1024);
+
+    SECTION ("it filters differently from the base-rate ladder")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (false, 1024), hq) > 1.0e-3f);
+    }
+
+    SECTION ("it doesn't depend on the block size")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (true, 37), hq) < 1.0e-5f);
+    }
+}
+
+TEST_CASE ("Offline renders use the offline quality profile", "[golden]")
+{
+    const double sampleRate = 48000.0;
+
+    auto render = [&] (bool nonRealtime, int blockSize, auto sampleType) {
+        using SampleType = decltype (sampleType);
+
+        PluginProcessor plugin;
+        auto& apvts = plugin.getAPVTS();
+        apvts.getParameter (PluginProcessor::FILTER_RESONANCE_ID)->setValueNotifyingHost (0.9f);
+        apvts.getParameter (PluginProcessor::DRIVE_AMOUNT_ID)->setValueNotifyingHost (0.8f);
+
+        plugin.setNonRealtime (nonRealtime);
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        const auto totalSamples = static_cast<int> (render_helpers::phraseLengthSeconds * sampleRate);
+        auto rendered = render_helpers::renderMidi<SampleType> (plugin, render_helpers::makeFixedPhrase (sampleRate), totalSamples, blockSize);
+        plugin.releaseResources();
+
+        juce::AudioBuffer<float> output (rendered.getNumChannels(), rendered.getNumSamples());
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                output.setSample (ch, i, static_cast<float> (rendered.getSample (ch, i)));
+        return output;
+    };
+
+    const auto offline = render (true, 1024, 0.0f);
+
+    SECTION ("the bounce takes the HQ filter at 4x")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (false, 1024, 0.0f), offline) > 1.0e-3f);
+    }
+
+    SECTION ("it doesn't depend on the block size")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (true, 37, 0.0f), offline) < 1.0e-5f);
+    }
+
+    SECTION ("float hosts render through the double path")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (render (true, 1024, 0.0), offline) < 1.0e-6f);
+    }
+}
@@ -0,0 +1,134 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int totalSamples = 24000;
+
+    juce::MidiBuffer makeHeldNote (int channel = 1)
+    {
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (channel, 36, (juce::uint8) 100), 0);
+        midi.addEvent (juce::MidiMessage::noteOff (channel, 36), totalSamples - 4000);
+        return midi;
+    }
+
+    juce::AudioBuffer<float> render (const juce::MidiBuffer& midi, bool mpe = false)
+    {
+        PluginProcessor plugin;
+        plugin.getAPVTS().getParameter (PluginProcessor::MPE_ENABLED_ID)->setValueNotifyingHost (mpe ? 1.0f : 0.0f);
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        auto output = render_helpers::renderMidi (plugin, midi, totalSamples, blockSize);
+        plugin.releaseResources();
+        return output;
+    }
+}
+
+TEST_CASE ("MIDI controller split", "[midi]")
+{
+    MidiControllerMap map;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+    midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, 64), 10);
+    midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 127), 11);
+    midi.addEvent (juce::MidiMessage::pitchWheel (1, 16383), 12);
+    midi.addEvent (juce::MidiMessage::channelPressureChange (1, 127), 13);
+    midi.addEvent (juce::MidiMessage::controllerEvent (1, 20, 5), 14);
+
+    juce::MidiBuffer synthMidi;
+    std::vector<ControllerEvent> events;
+    events.reserve (16);
+    map.splitMidi (midi, synthMidi, events);
+
+    SECTION ("notes and pedals stay with the synthesiser")
+    {
+        CHECK (synthMidi.getNumEvents() == 2);
+    }
+
+    SECTION ("routed controllers become timestamped events")
+    {
+        REQUIRE (events.size() == 3);  // CC 20 isn't routed anywhere
+
+        CHECK (events[0].samplePosition == 10);
+        CHECK (events[0].source == ControllerSource::modWheel);
+
+        CHECK (events[1].type == ControllerEvent::Type::pitchBend);
+        CHECK (events[1].value > 1.12f);  // close to +2 semitones
+        CHECK (events[1].value < 1.123f);
+
+        CHECK (events[2].source == ControllerSource::aftertouch);
+        CHECK (events[2].value == 1.0f);
+    }
+}
+
+TEST_CASE ("MIDI controllers reach the voices", "[midi]")
+{
+    const auto reference = render (makeHeldNote());
+
+    SECTION ("centred wheel and unrouted CCs leave the sound untouched")
+    {
+        auto midi = makeHeldNote();
+        for (int i = 0; i < totalSamples; i += 3)
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 20, i % 128), i);
+        midi.addEvent (juce::MidiMessage::pitchWheel (1, 8192), 100);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render (midi)) == 0.0f);
+    }
+
+    SECTION ("pitch bend changes the sound")
+    {
+        auto midi = makeHeldNote();
+        midi.addEvent (juce::MidiMessage::pitchWheel (1, 16383), 4000);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render (midi)) > 0.01f);
+    }
+
+    SECTION ("mod wheel changes the sound")
+    {
+        auto midi = makeHeldNote();
+        for (int i = 0; i < 128; ++i)
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, i), 4000 + i * 16);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render (midi)) > 0.01f);
+    }
+}
+
+TEST_CASE ("MPE expression only reaches its own note", "[midi]")
+{
+    const auto reference = render (makeHeldNote (2), true);
+
+    SECTION ("another member channel leaves the note alone")
+    {
+        auto midi = makeHeldNote (2);
+        midi.addEvent (juce::MidiMessage::pitchWheel (3, 16383), 4000);
+        midi.addEvent (juce::MidiMessage::channelPressureChange (3, 127), 4000);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render (midi, true)) == 0.0f);
+    }
+
+    SECTION ("the note's own channel bends it")
+    {
+        auto midi = makeHeldNote (2);
+        midi.addEvent (juce::MidiMessage::pitchWheel (2, 9000), 4000);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render (midi, true)) > 0.01f);
+    }
+
+    SECTION ("expression sent before the note-on is kept")
+    {
+        // Bent on the member channel a block before its note starts
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::pitchWheel (2, 9000), 0);
+        midi.addEvents (makeHeldNote (2), 0, -1, blockSize);
+
+        juce::MidiBuffer unbent;
+        unbent.addEvents (makeHeldNote (2), 0, -1, blockSize);
+
+        CHECK (render_helpers::peakAbsoluteDifference (render (unbent, true), render (midi, true)) > 0.01f);
+    }
+}
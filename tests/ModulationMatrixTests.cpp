@@ -0,0 +1,112 @@
+#include "helpers/render_helpers.h"
+#include <ModulationMatrix.h>
+#include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int totalSamples = 24000;
+
+    struct Route
+    {
+        ModSource source;
+        ModDestination destination;
+        float amount;
+    };
+
+    juce::AudioBuffer<float> render (std::initializer_list<Route> routes, int blockSize = 256)
+    {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getAPVTS();
+
+        int index = 0;
+        for (const auto& route : routes)
+        {
+            auto set = [&] (const char* id, float plainValue) {
+                auto* parameter = apvts.getParameter (id);
+                parameter->setValueNotifyingHost (parameter->convertTo0to1 (plainValue));
+            };
+
+            set (PluginProcessor::MOD_SOURCE_IDS[index], static_cast<float> (route.source));
+            set (PluginProcessor::MOD_DESTINATION_IDS[index], static_cast<float> (route.destination));
+            set (PluginProcessor::MOD_AMOUNT_IDS[index], route.amount);
+            ++index;
+        }
+
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 40), totalSamples - 4000);
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        auto output = render_helpers::renderMidi (plugin, midi, totalSamples, blockSize);
+        plugin.releaseResources();
+        return output;
+    }
+}
+
+TEST_CASE ("Modulation matrix accumulates routes", "[modmatrix]")
+{
+    constexpr int numSamples = 64;
+
+    juce::AudioBuffer<float> sources (ModulationMatrix::numSources, numSamples);
+    juce::AudioBuffer<float> destinations (ModulationMatrix::numDestinations, numSamples);
+    sources.clear();
+    destinations.clear();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        sources.setSample (static_cast<int> (ModSource::lfo1), i, 0.5f);
+        sources.setSample (static_cast<int> (ModSource::modWheel), i, 1.0f);
+    }
+
+    ModulationMatrix matrix;
+    matrix.setConstantSource (ModSource::velocity, -0.5f);
+    matrix.addRoute (ModSource::lfo1, ModDestination::cutoff, 100.0f);
+    matrix.addRoute (ModSource::modWheel, ModDestination::cutoff, 10.0f);
+    matrix.addRoute (ModSource::velocity, ModDestination::amp, 1.0f);
+    matrix.addRoute (ModSource::lfo2, ModDestination::pitch, 0.0f);  // zero gain, dropped
+    matrix.process (sources, destinations, numSamples);
+
+    CHECK (matrix.isRouted (ModDestination::cutoff));
+    CHECK (matrix.isRouted (ModDestination::amp));
+    CHECK_FALSE (matrix.isRouted (ModDestination::pitch));
+    CHECK_FALSE (matrix.isUsed (ModSource::lfo2));
+
+    CHECK (destinations.getSample (static_cast<int> (ModDestination::cutoff), numSamples - 1) == Catch::Approx (60.0f));
+    CHECK (destinations.getSample (static_cast<int> (ModDestination::amp), 0) == Catch::Approx (-0.5f));
+}
+
+TEST_CASE ("Modulation matrix routes reach the voices", "[modmatrix]")
+{
+    const auto reference = render ({});
+
+    SECTION ("a route with no destination leaves the sound untouched")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render ({ { ModSource::lfo2, ModDestination::none, 1.0f } })) == 0.0f);
+    }
+
+    SECTION ("LFO 2 to pitch changes the sound")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render ({ { ModSource::lfo2, ModDestination::pitch, 0.5f } })) > 0.01f);
+    }
+
+    SECTION ("envelope to amp changes the sound")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (reference, render ({ { ModSource::filterEnvelope, ModDestination::amp, -1.0f } })) > 0.01f);
+    }
+
+    SECTION ("modulated renders don't depend on the block size")
+    {
+        const std::initializer_list<Route> routes {
+            { ModSource::lfo2, ModDestination::drive, 0.8f },
+            { ModSource::random, ModDestination::detune, 0.5f },
+            { ModSource::ampEnvelope, ModDestination::resonance, 0.4f },
+            { ModSource::key, ModDestination::subMix, 1.0f },
+        };
+
+        CHECK (render_helpers::peakAbsoluteDifference (render (routes, 64), render (routes, 512)) < 1.0e-5f);
+    }
+}
@@ -0,0 +1,73 @@
+#include <MorphEngine.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Morph engine blends preset slots", "[morph]")
+{
+    MorphEngine morph;
+    morph.setEnabled (true);
+
+    VoiceParameters a, b;
+    a.filterCutoff = 100.0f;
+    b.filterCutoff = 10000.0f;
+    a.subMix = 0.0f;
+    b.subMix = 1.0f;
+    a.unisonVoices = 1;
+    b.unisonVoices = 5;
+
+    SECTION ("needs two slots")
+    {
+        morph.setSlot (0, a);
+        CHECK_FALSE (morph.isActive());
+    }
+
+    morph.setSlot (0, a);
+    morph.setSlot (1, b);
+    REQUIRE (morph.isActive());
+
+    SECTION ("end points reproduce the slots")
+    {
+        CHECK (morph.process (0.0f).filterCutoff == Catch::Approx (100.0f).epsilon (1.0e-4));
+        CHECK (morph.process (1.0f).filterCutoff == Catch::Approx (10000.0f).epsilon (1.0e-4));
+    }
+
+    SECTION ("cutoff blends in the log domain, mixes linearly, voices step")
+    {
+        const auto mid = morph.process (0.5f);
+        CHECK (mid.filterCutoff == Catch::Approx (1000.0f).epsilon (1.0e-3));
+        CHECK (mid.subMix == Catch::Approx (0.5f));
+        CHECK ((mid.unisonVoices == 1 || mid.unisonVoices == 5));
+        CHECK (morph.process (0.3f).unisonVoices == 1);
+        CHECK (morph.process (0.7f).unisonVoices == 5);
+    }
+}
+
+TEST_CASE ("Morph weights renormalise over the loaded slots", "[morph]")
+{
+    MorphEngine morph;
+    morph.setEnabled (true);
+
+    VoiceParameters a, c;
+    a.subMix = 0.0f;
+    c.subMix = 1.0f;
+
+    // Only A and C: x has nothing to blend, y moves from A to C
+    morph.setSlot (0, a);
+    morph.setSlot (2, c);
+    REQUIRE (morph.isActive());
+
+    SECTION ("the pad corners without a slot take the loaded one on their row")
+    {
+        morph.setPadY (1.0f);
+        CHECK (morph.process (0.0f).subMix == Catch::Approx (1.0f));
+        CHECK (morph.process (0.99f).subMix == Catch::Approx (1.0f));
+        CHECK (morph.process (1.0f).subMix == Catch::Approx (1.0f));
+    }
+
+    SECTION ("y blends the rows at any x")
+    {
+        morph.setPadY (0.25f);
+        CHECK (morph.process (0.0f).subMix == Catch::Approx (0.25f));
+        CHECK (morph.process (1.0f).subMix == Catch::Approx (0.25f));
+    }
+}
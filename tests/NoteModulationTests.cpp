@@ -0,0 +1,263 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numBlocks = 80;
+
+    struct Modulation
+    {
+        const char* parameterId;
+        double amount;  // normalised, as the host sends it
+        int32_t noteId;
+        int16_t channel;
+        int16_t key;
+    };
+
+    clap_event_note_t makeNote (uint16_t type, int32_t noteId, int16_t key)
+    {
+        clap_event_note_t note {};
+        note.header.size = sizeof (note);
+        note.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        note.header.type = type;
+        note.note_id = noteId;
+        note.port_index = 0;
+        note.channel = 0;
+        note.key = key;
+        note.velocity = 0.8;
+        return note;
+    }
+
+    // Two notes started as CLAP events (note IDs 1 and 2), modulated a few
+    // blocks in the way the CLAP wrapper hands a polyphonic CLAP_EVENT_PARAM_MOD over
+    juce::AudioBuffer<float> renderNotes (const Modulation* modulation, bool* parameterMoved = nullptr)
+    {
+        PluginProcessor plugin;
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+
+        const int numChannels = plugin.getTotalNumOutputChannels();
+        juce::AudioBuffer<float> output (numChannels, blockSize * numBlocks);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+        juce::MidiBuffer midi;
+        float valueBefore = 0.0f;
+
+        for (int index = 0; index < numBlocks; ++index)
+        {
+            if (index == 0)
+            {
+                auto first = makeNote (CLAP_EVENT_NOTE_ON, 1, 48);
+                auto second = makeNote (CLAP_EVENT_NOTE_ON, 2, 55);
+                plugin.handleDirectEvent (&first.header, 0);
+                plugin.handleDirectEvent (&second.header, 10);
+            }
+
+            if (index == 4 && modulation != nullptr)
+            {
+                auto* parameter = plugin.getAPVTS().getParameter (modulation->parameterId);
+                auto* capabilities = dynamic_cast<clap_juce_extensions::clap_juce_parameter_capabilities*> (parameter);
+                REQUIRE (capabilities != nullptr);
+                valueBefore = plugin.getAPVTS().getRawParameterValue (modulation->parameterId)->load();
+                CHECK (capabilities->supportsPolyphonicModulation());
+                capabilities->applyPolyphonicModulation (modulation->noteId, 0, modulation->channel, modulation->key, modulation->amount);
+            }
+
+            if (index == numBlocks - 30)
+            {
+                auto release = makeNote (CLAP_EVENT_NOTE_OFF, 1, -1);
+                release.channel = -1;
+                plugin.handleDirectEvent (&release.header, 0);
+                auto second = makeNote (CLAP_EVENT_NOTE_OFF, 2, 55);
+                plugin.handleDirectEvent (&second.header, 0);
+            }
+
+            midi.clear();
+            plugin.processBlock (block, midi);
+            for (int channel = 0; channel < numChannels; ++channel)
+                output.copyFrom (channel, index * blockSize, block, channel, 0, blockSize);
+        }
+
+        if (parameterMoved != nullptr && modulation != nullptr)
+            *parameterMoved = ! juce::exactlyEqual (valueBefore, plugin.getAPVTS().getRawParameterValue (modulation->parameterId)->load());
+
+        plugin.releaseResources();
+        return output;
+    }
+
+    // Sends a CLAP note event addressed by ID only (key and channel -1) or by key
+    void sendNote (PluginProcessor& plugin, uint16_t type, int32_t noteId, int16_t key, int sampleOffset = 0)
+    {
+        auto note = makeNote (type, noteId, key);
+        if (key < 0)
+            note.channel = -1;
+        plugin.handleDirectEvent (&note.header, sampleOffset);
+    }
+
+    // Renders totalBlocks blocks, calling sendEvents (plugin, blockIndex) before each
+    template <typename SendEvents>
+    juce::AudioBuffer<float> renderClapBlocks (int totalBlocks, SendEvents&& sendEvents)
+    {
+        PluginProcessor plugin;
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+
+        const int numChannels = plugin.getTotalNumOutputChannels();
+        juce::AudioBuffer<float> output (numChannels, blockSize * totalBlocks);
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (int index = 0; index < totalBlocks; ++index)
+        {
+            sendEvents (plugin, index);
+            plugin.processBlock (block, midi);
+            for (int channel = 0; channel < numChannels; ++channel)
+                output.copyFrom (channel, index * blockSize, block, channel, 0, blockSize);
+        }
+
+        plugin.releaseResources();
+        return output;
+    }
+
+    float blockMagnitude (const juce::AudioBuffer<float>& output, int blockIndex)
+    {
+        return output.getMagnitude (blockIndex * blockSize, blockSize);
+    }
+
+    // The same notes as MIDI, to check the CLAP notes sound like MIDI ones
+    juce::AudioBuffer<float> renderMidiNotes()
+    {
+        PluginProcessor plugin;
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 48, 0.8f), 0);
+        midi.addEvent (juce::MidiMessage::noteOn (1, 55, 0.8f), 10);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48, 0.8f), (numBlocks - 30) * blockSize);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 55, 0.8f), (numBlocks - 30) * blockSize);
+
+        auto output = render_helpers::renderMidi (plugin, midi, blockSize * numBlocks, blockSize);
+        plugin.releaseResources();
+        return output;
+    }
+}
+
+TEST_CASE ("CLAP per-note parameter modulation", "[clap]")
+{
+    const auto reference = renderNotes (nullptr);
+
+    SECTION ("CLAP notes play like MIDI notes")
+    {
+        CHECK (render_helpers::peakAbsoluteDifference (reference, renderMidiNotes()) == 0.0f);
+    }
+
+    SECTION ("a modulated note moves, the parameter doesn't")
+    {
+        const Modulation cutoff { PluginProcessor::FILTER_CUTOFF_ID, 0.3, 2, -1, -1 };
+        bool parameterMoved = true;
+        const auto modulated = renderNotes (&cutoff, &parameterMoved);
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, modulated) > 0.01f);
+        CHECK_FALSE (parameterMoved);
+    }
+
+    SECTION ("the note ID finds the same voice as its channel and key")
+    {
+        for (const auto* parameterId : { PluginProcessor::FILTER_RESONANCE_ID, PluginProcessor::DRIVE_AMOUNT_ID })
+        {
+            const Modulation byNoteId { parameterId, 0.4, 2, -1, -1 };
+            const Modulation byKey { parameterId, 0.4, -1, 0, 55 };
+
+            const auto first = renderNotes (&byNoteId);
+            CHECK (render_helpers::peakAbsoluteDifference (reference, first) > 0.001f);
+            CHECK (render_helpers::peakAbsoluteDifference (first, renderNotes (&byKey)) == 0.0f);
+        }
+    }
+
+    SECTION ("notes nobody plays are left alone")
+    {
+        const Modulation unknownNote { PluginProcessor::UNISON_DETUNE_ID, 0.5, 7, -1, -1 };
+        const Modulation otherKey { PluginProcessor::FILTER_CUTOFF_ID, 0.3, -1, 0, 60 };
+
+        CHECK (render_helpers::peakAbsoluteDifference (reference, renderNotes (&unknownNote)) == 0.0f);
+        CHECK (render_helpers::peakAbsoluteDifference (reference, renderNotes (&otherKey)) == 0.0f);
+    }
+}
+
+TEST_CASE ("CLAP note IDs last as long as their notes", "[clap]")
+{
+    SECTION ("a note-off for an unknown ID releases nothing")
+    {
+        auto render = [] (bool sendStray) {
+            return renderClapBlocks (40, [sendStray] (PluginProcessor& plugin, int index) {
+                if (index == 0)
+                {
+                    sendNote (plugin, CLAP_EVENT_NOTE_ON, 1, 48);
+                    sendNote (plugin, CLAP_EVENT_NOTE_ON, 2, 55, 10);
+                }
+
+                if (index == 10 && sendStray)
+                {
+                    sendNote (plugin, CLAP_EVENT_NOTE_OFF, 99, -1);
+                    sendNote (plugin, CLAP_EVENT_NOTE_CHOKE, 98, -1);
+                }
+            });
+        };
+
+        CHECK (render_helpers::peakAbsoluteDifference (render (false), render (true)) == 0.0f);
+    }
+
+    SECTION ("a held note's ID outlives many short notes")
+    {
+        // Note 1 is held while 80 short notes on different keys come and go -
+        // more than the ring has slots, so only forgetting the ended ones
+        // keeps note 1's
+        constexpr int numShortNotes = 80;
+        constexpr int releaseBlock = 2 * numShortNotes + 2;
+        constexpr int totalBlocks = releaseBlock + 100;  // 100 ms release
+
+        const auto output = renderClapBlocks (totalBlocks, [] (PluginProcessor& plugin, int index) {
+            if (index == 0)
+                sendNote (plugin, CLAP_EVENT_NOTE_ON, 1, 36);
+
+            if (index >= 1 && index <= 2 * numShortNotes)
+            {
+                const auto shortNote = (index - 1) / 2;
+                if (index % 2 == 1)
+                    sendNote (plugin, CLAP_EVENT_NOTE_ON, 100 + shortNote, static_cast<int16_t> (40 + shortNote));
+                else
+                    sendNote (plugin, CLAP_EVENT_NOTE_OFF, 100 + shortNote, -1);
+            }
+
+            if (index == releaseBlock)
+                sendNote (plugin, CLAP_EVENT_NOTE_OFF, 1, -1);
+        });
+
+        CHECK (blockMagnitude (output, releaseBlock - 1) > 0.01f);
+        CHECK (blockMagnitude (output, totalBlocks - 1) < 1.0e-5f);
+    }
+
+    SECTION ("a choke stops the note without a release tail")
+    {
+        constexpr int stopBlock = 20;
+
+        auto render = [] (uint16_t type) {
+            return renderClapBlocks (stopBlock + 4, [type] (PluginProcessor& plugin, int index) {
+                if (index == 0)
+                    sendNote (plugin, CLAP_EVENT_NOTE_ON, 1, 48);
+                if (index == stopBlock)
+                    sendNote (plugin, type, 1, -1);
+            });
+        };
+
+        const auto released = render (CLAP_EVENT_NOTE_OFF);
+        const auto choked = render (CLAP_EVENT_NOTE_CHOKE);
+
+        CHECK (blockMagnitude (released, stopBlock + 1) > 0.001f);
+        CHECK (blockMagnitude (choked, stopBlock) > 0.001f);  // a short fade, not a cut
+        CHECK (blockMagnitude (choked, stopBlock + 1) < 1.0e-5f);
+    }
+}
@@ -0,0 +1,143 @@
+#include <PartitionedConvolution.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    // Decaying noise, long enough to reach the background tail partitions
+    juce::AudioBuffer<float> makeImpulse (int length)
+    {
+        juce::Random random (1234);
+        juce::AudioBuffer<float> impulse (1, length);
+        for (int i = 0; i < length; ++i)
+            impulse.setSample (0, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp (-4.0f * static_cast<float> (i) / static_cast<float> (length)));
+        return impulse;
+    }
+
+    juce::AudioBuffer<float> makeInput (int length)
+    {
+        juce::Random random (99);
+        juce::AudioBuffer<float> input (1, length);
+        for (int i = 0; i < length; ++i)
+            input.setSample (0, i, random.nextFloat() * 2.0f - 1.0f);
+        return input;
+    }
+
+    // Straightforward time-domain convolution with the IR normalised to unit energy
+    std::vector<float> convolveDirect (const juce::AudioBuffer<float>& input, const juce::AudioBuffer<float>& impulse)
+    {
+        double energy = 0.0;
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            energy += impulse.getSample (0, i) * impulse.getSample (0, i);
+        const auto gain = 1.0 / std::sqrt (energy);
+
+        std::vector<float> output (static_cast<size_t> (input.getNumSamples()));
+        for (int n = 0; n < input.getNumSamples(); ++n)
+        {
+            double sum = 0.0;
+            for (int k = 0; k <= juce::jmin (n, impulse.getNumSamples() - 1); ++k)
+                sum += impulse.getSample (0, k) * gain * input.getSample (0, n - k);
+            output[static_cast<size_t> (n)] = static_cast<float> (sum);
+        }
+        return output;
+    }
+
+    juce::AudioBuffer<float> convolvePartitioned (const juce::AudioBuffer<float>& input, const juce::AudioBuffer<float>& impulse, int blockSize, float mix = 1.0f)
+    {
+        PartitionedConvolution convolution;
+        convolution.prepare (sampleRate, 1);
+        convolution.loadImpulseResponse (impulse, sampleRate);
+
+        juce::AudioBuffer<float> output (input);
+        for (int start = 0; start < output.getNumSamples(); start += blockSize)
+        {
+            const auto numSamples = juce::jmin (blockSize, output.getNumSamples() - start);
+            juce::AudioBuffer<float> block (output.getArrayOfWritePointers(), 1, start, numSamples);
+            convolution.process (block, mix);
+        }
+        return output;
+    }
+}
+
+TEST_CASE ("Partitioned convolution", "[convolution]")
+{
+    const auto impulse = makeImpulse (5000);  // head, body and three tail partitions
+    const auto input = makeInput (12000);
+    const auto expected = convolveDirect (input, impulse);
+
+    SECTION ("matches direct convolution with no latency, at any block size")
+    {
+        for (const auto blockSize : { 1, 37, 64, 512, 4096 })
+        {
+            const auto output = convolvePartitioned (input, impulse, blockSize);
+
+            float maxError = 0.0f;
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                maxError = std::max (maxError, std::abs (output.getSample (0, i) - expected[static_cast<size_t> (i)]));
+
+            INFO ("block size " << blockSize);
+            CHECK (maxError < 1.0e-4f);
+        }
+    }
+
+    SECTION ("a short IR only uses the audio thread stages")
+    {
+        const auto shortImpulse = makeImpulse (300);
+        const auto shortExpected = convolveDirect (input, shortImpulse);
+        const auto output = convolvePartitioned (input, shortImpulse, 256);
+
+        for (int i = 0; i < output.getNumSamples(); ++i)
+            REQUIRE (std::abs (output.getSample (0, i) - shortExpected[static_cast<size_t> (i)]) < 1.0e-4f);
+    }
+
+    SECTION ("mix 0 passes the dry signal")
+    {
+        const auto output = convolvePartitioned (input, impulse, 256, 0.0f);
+
+        for (int i = 0; i < output.getNumSamples(); ++i)
+            REQUIRE (output.getSample (0, i) == input.getSample (0, i));
+    }
+
+    SECTION ("double buffers convolve in place, the dry signal stays double")
+    {
+        juce::AudioBuffer<double> doubleInput (1, input.getNumSamples());
+        for (int i = 0; i < input.getNumSamples(); ++i)
+            doubleInput.setSample (0, i, static_cast<double> (input.getSample (0, i)) + 1.0e-10);
+
+        for (const auto mix : { 0.0f, 1.0f })
+        {
+            PartitionedConvolution convolution;
+            convolution.prepare (sampleRate, 1);
+            convolution.loadImpulseResponse (impulse, sampleRate);
+
+            juce::AudioBuffer<double> output (doubleInput);
+            for (int start = 0; start < output.getNumSamples(); start += 256)
+            {
+                juce::AudioBuffer<double> block (output.getArrayOfWritePointers(), 1, start, juce::jmin (256, output.getNumSamples() - start));
+                convolution.process (block, mix);
+            }
+
+            for (int i = 0; i < output.getNumSamples(); ++i)
+            {
+                if (juce::exactlyEqual (mix, 0.0f))
+                    REQUIRE (juce::exactlyEqual (output.getSample (0, i), doubleInput.getSample (0, i)));
+                else
+                    REQUIRE (std::abs (output.getSample (0, i) - static_cast<double> (expected[static_cast<size_t> (i)])) < 1.0e-4);
+            }
+        }
+    }
+
+    SECTION ("without an IR the signal is untouched")
+    {
+        PartitionedConvolution convolution;
+        convolution.prepare (sampleRate, 1);
+
+        juce::AudioBuffer<float> output (input);
+        convolution.process (output, 1.0f);
+        CHECK_FALSE (convolution.isRinging());
+
+        for (int i = 0; i < output.getNumSamples(); ++i)
+            REQUIRE (output.getSample (0, i) == input.getSample (0, i));
+    }
+}
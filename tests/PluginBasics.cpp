@@ -1,5 +1,6 @@
 #include "helpers/test_helpers.h"
 #include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
@@ -28,3 +29,121 @@ TEST_CASE ("IPP version", "[ipp]")
     CHECK_THAT (ippsGetLibVersion()->Version, Catch::Matchers::Equals ("2022.2.0 (r0x42db1a66)"));
 }
 #endif
+
+namespace
+{
+    // Undoes the always-on output clipper, tanh (x * 0.8) * 1.2
+    float beforeClipper (float output)
+    {
+        return std::atanh (output / 1.2f) / 0.8f;
+    }
+
+    void startNote (PluginProcessor& plugin, juce::AudioBuffer<float>& buffer)
+    {
+        plugin.setRateAndBufferSizeDetails (48000.0, 256);
+        plugin.prepareToPlay (48000.0, 256);
+
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+        plugin.processBlock (buffer, midi);
+    }
+}
+
+TEST_CASE ("Preset switch while playing", "[presets]")
+{
+    PluginProcessor plugin;
+    juce::AudioBuffer<float> buffer (2, 256);
+    juce::MidiBuffer midi;
+    startNote (plugin, buffer);
+
+    SECTION ("parameters reach the host in one pass")
+    {
+        plugin.nextPreset();
+
+        CHECK (plugin.getCurrentPresetName() == plugin.getPresetManager().getCurrentPreset().name);
+        CHECK (plugin.getAPVTS().getRawParameterValue (PluginProcessor::UNISON_VOICES_ID)->load()
+               == static_cast<float> (plugin.getPresetManager().getCurrentPreset().unisonVoices));
+    }
+
+    SECTION ("the old sound ramps down to silence instead of clicking")
+    {
+        // The same note left alone, for what the output would have been
+        PluginProcessor unswitched;
+        juce::AudioBuffer<float> reference (2, 256);
+        startNote (unswitched, reference);
+        unswitched.processBlock (reference, midi);
+
+        plugin.nextPreset();
+        plugin.processBlock (buffer, midi);
+
+        // 5ms at 48kHz: the gain falls linearly from 1 to 0 over 240 samples
+        // while the old preset keeps playing underneath
+        const int fadeLength = 240;
+        for (int i = 0; i < fadeLength; ++i)
+        {
+            const auto expected = beforeClipper (reference.getSample (0, i)) * (1.0f - static_cast<float> (i) / fadeLength);
+            CHECK (beforeClipper (buffer.getSample (0, i)) == Catch::Approx (expected).margin (1.0e-4));
+        }
+
+        CHECK (std::abs (buffer.getSample (0, fadeLength - 1)) < 0.01f);
+
+        unswitched.releaseResources();
+    }
+
+    SECTION ("switches made between blocks collapse into the last one")
+    {
+        // More switches than the audio thread could ever have queued
+        for (int i = 0; i < 12; ++i)
+            plugin.nextPreset();
+
+        // The fade-out ends inside this block and the preset the host sees is swapped in
+        plugin.processBlock (buffer, midi);
+
+        const auto& applied = plugin.getAppliedVoiceParameters();
+        const auto& apvts = plugin.getAPVTS();
+        CHECK (applied.filterCutoff == Catch::Approx (apvts.getRawParameterValue (PluginProcessor::FILTER_CUTOFF_ID)->load()));
+        CHECK (applied.filterResonance == Catch::Approx (apvts.getRawParameterValue (PluginProcessor::FILTER_RESONANCE_ID)->load()));
+        CHECK (applied.ampRelease == Catch::Approx (apvts.getRawParameterValue (PluginProcessor::AMP_RELEASE_ID)->load()));
+        CHECK (applied.driveAmount == Catch::Approx (apvts.getRawParameterValue (PluginProcessor::DRIVE_AMOUNT_ID)->load()));
+        CHECK (static_cast<float> (applied.unisonVoices) == apvts.getRawParameterValue (PluginProcessor::UNISON_VOICES_ID)->load());
+    }
+
+    plugin.releaseResources();
+}
+
+TEST_CASE ("Silent blocks skip the voices", "[instance]")
+{
+    PluginProcessor plugin;
+    plugin.setRateAndBufferSizeDetails (48000.0, 256);
+    plugin.prepareToPlay (48000.0, 256);
+
+    juce::AudioBuffer<float> buffer (2, 256);
+    juce::MidiBuffer midi;
+
+    SECTION ("idle output is cleared")
+    {
+        buffer.clear();
+        buffer.setSample (0, 10, 1.0f);
+        plugin.processBlock (buffer, midi);
+
+        CHECK (buffer.getMagnitude (0, buffer.getNumSamples()) == 0.0f);
+        CHECK (plugin.getCurrentOutputLevel() == 0.0f);
+    }
+
+    SECTION ("a note still starts from silence")
+    {
+        plugin.processBlock (buffer, midi);
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+        plugin.processBlock (buffer, midi);
+
+        CHECK (buffer.getMagnitude (0, buffer.getNumSamples()) > 0.0f);
+    }
+
+    SECTION ("the tail follows the amp release")
+    {
+        plugin.getAPVTS().getParameter (PluginProcessor::AMP_RELEASE_ID)->setValueNotifyingHost (1.0f);
+        CHECK (plugin.getTailLengthSeconds() == Catch::Approx (5.0));
+    }
+
+    plugin.releaseResources();
+}
@@ -0,0 +1,105 @@
+#include "helpers/render_helpers.h"
+#include <PluginProcessor.h>
+#include <PrerenderCache.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int noteOffSample = 24000;
+    constexpr int totalSamples = 96000;  // long enough for the release to finish
+
+    // Plays one held note and its release
+    juce::AudioBuffer<float> renderNote (PluginProcessor& plugin)
+    {
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 36), noteOffSample);
+        return render_helpers::renderMidi (plugin, midi, totalSamples, blockSize);
+    }
+
+    // A static patch without velocity layers, so the cached note is the exact one played
+    void prepare (PluginProcessor& plugin, bool noteCache)
+    {
+        auto& apvts = plugin.getAPVTS();
+        apvts.getParameter (PluginProcessor::VELOCITY_TO_FILTER_ID)->setValueNotifyingHost (0.0f);
+        apvts.getParameter (PluginProcessor::VELOCITY_TO_AMP_ID)->setValueNotifyingHost (0.0f);
+        apvts.getParameter (PluginProcessor::LFO_AMOUNT_ID)->setValueNotifyingHost (0.0f);
+        apvts.getParameter (PluginProcessor::GLIDE_TIME_ID)->setValueNotifyingHost (0.0f);
+        apvts.getParameter (PluginProcessor::NOTE_CACHE_ID)->setValueNotifyingHost (noteCache ? 1.0f : 0.0f);
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+    }
+}
+
+TEST_CASE ("Static patch detection", "[cache]")
+{
+    VoiceParameters params;
+    params.lfoAmount = 0.0f;
+    params.glideTime = 0.0f;
+
+    SECTION ("the default routes are static")
+    {
+        CHECK (PrerenderCache::isStatic (params));
+    }
+
+    SECTION ("LFO depth makes every note different")
+    {
+        params.lfoAmount = 0.3f;
+        CHECK_FALSE (PrerenderCache::isStatic (params));
+    }
+
+    SECTION ("so does a random route")
+    {
+        params.modRoutes[3] = { static_cast<int> (ModSource::random), static_cast<int> (ModDestination::cutoff), 0.5f };
+        CHECK_FALSE (PrerenderCache::isStatic (params));
+    }
+
+    SECTION ("velocity layers only when velocity changes the sound")
+    {
+        params.velocityToFilter = 0.0f;
+        params.velocityToAmp = 0.0f;
+        CHECK_FALSE (PrerenderCache::isVelocitySensitive (params));
+
+        params.velocityToAmp = 0.5f;
+        CHECK (PrerenderCache::isVelocitySensitive (params));
+    }
+}
+
+TEST_CASE ("Note cache renders", "[cache]")
+{
+    PluginProcessor live;
+    prepare (live, false);
+    renderNote (live);
+    const auto expected = renderNote (live);
+    live.releaseResources();
+
+    PluginProcessor cached;
+    prepare (cached, true);
+
+    // The first note plays live and requests its entry
+    renderNote (cached);
+    for (int i = 0; i < 500 && ! cached.getPrerenderCache().isUpToDate(); ++i)
+        juce::Thread::sleep (10);
+    REQUIRE (cached.getPrerenderCache().isUpToDate());
+
+    const auto output = renderNote (cached);
+    cached.releaseResources();
+
+    SECTION ("a repeated note plays from memory")
+    {
+        CHECK (cached.getPrerenderCache().getNumHits() > 0);
+    }
+
+    SECTION ("the held note sounds like the live render")
+    {
+        float peakDifference = 0.0f;
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            for (int i = 0; i < noteOffSample; ++i)
+                peakDifference = juce::jmax (peakDifference, std::abs (output.getSample (ch, i) - expected.getSample (ch, i)));
+
+        CHECK (peakDifference < 1.0e-3f);
+    }
+}
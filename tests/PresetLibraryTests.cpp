@@ -0,0 +1,83 @@
+#include <PresetLibrary.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    // The library scans on its own thread - poll until the index settles
+    bool waitForEntries (const PresetLibrary& library, size_t expected)
+    {
+        for (int attempt = 0; attempt < 500; ++attempt)
+        {
+            if (library.getIndex()->entries.size() == expected && ! library.isScanning())
+                return true;
+
+            juce::Thread::sleep (10);
+        }
+
+        return false;
+    }
+}
+
+TEST_CASE ("Preset library indexes and searches user presets", "[presets]")
+{
+    juce::TemporaryFile tempDirectory;
+    const auto directory = tempDirectory.getFile();
+    REQUIRE (directory.createDirectory());
+
+    PresetLibrary library;
+    library.setDirectory (directory);
+
+    const PresetManager factory;
+    auto sub = factory.getPresets()[0];
+    sub.name = "Sub Rumble";
+    auto reese = factory.getPresets()[1];
+    reese.name = "Reese Growl";
+    auto subTwo = factory.getPresets()[0];
+    subTwo.name = "Sub Knock";
+    subTwo.filterCutoff = 321.0f;
+
+    REQUIRE (library.savePreset (sub, "tester", { "808", "Sub" }));
+    REQUIRE (library.savePreset (reese, "tester", { "dnb" }));
+    REQUIRE (library.savePreset (subTwo, "someone", { "sub" }));
+    library.rescan();
+
+    REQUIRE (waitForEntries (library, 3));
+
+    SECTION ("name prefix search is case insensitive and sorted")
+    {
+        const auto results = library.search ("sub", 10);
+        REQUIRE (results.size() == 2);
+        CHECK (results[0].name == "Sub Knock");
+        CHECK (results[1].name == "Sub Rumble");
+    }
+
+    SECTION ("tag search")
+    {
+        CHECK (library.search ("#sub", 10).size() == 2);
+        CHECK (library.search ("#808", 10).size() == 1);
+        CHECK (library.search ("reese #sub", 10).empty());
+    }
+
+    SECTION ("key parameters are indexed, full preset loads lazily")
+    {
+        const auto results = library.search ("sub knock", 10);
+        REQUIRE (results.size() == 1);
+        CHECK (results[0].filterCutoff == Catch::Approx (321.0f));
+
+        const auto loaded = PresetLibrary::loadPreset (results[0].file);
+        REQUIRE (loaded.has_value());
+        CHECK (loaded->name == "Sub Knock");
+        CHECK (loaded->subMix == Catch::Approx (subTwo.subMix));
+    }
+
+    SECTION ("deleted files drop out on rescan")
+    {
+        library.search ("reese", 1).front().file.deleteFile();
+        library.rescan();
+        REQUIRE (waitForEntries (library, 2));
+        CHECK (library.search ("reese", 10).empty());
+    }
+
+    directory.deleteRecursively();
+}
@@ -0,0 +1,171 @@
+#include <QualityGovernor.h>
+#include <SynthVoice.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 480;  // 10 ms
+    constexpr double blockSeconds = blockSize / sampleRate;
+
+    // Feeds blocks that each took the given share of their deadline
+    QualityGovernor::Level run (QualityGovernor& governor, float load, double seconds, bool enabled = true)
+    {
+        auto level = governor.getLevel();
+        for (double elapsed = 0.0; elapsed < seconds; elapsed += blockSeconds)
+            level = governor.update (load * blockSeconds, blockSize, enabled);
+        return level;
+    }
+
+    // One voice played through a plain juce::Synthesiser, so it's active
+    // between note-on and the end of its tail the way the processor's are
+    struct TestVoice
+    {
+        explicit TestVoice (const VoiceParameters& params)
+        {
+            bank.prepare (blockSize);
+            synth.addSound (new SynthSound());
+            synth.addVoice (voice = new SynthVoice (bank, 0));
+            synth.setCurrentPlaybackSampleRate (sampleRate);
+            voice->prepareToPlay (sampleRate, blockSize, 1);
+            voice->setParameters (params);
+            voice->skipParameterSmoothing();
+        }
+
+        juce::AudioBuffer<float> render (int numSamples)
+        {
+            juce::AudioBuffer<float> buffer (1, numSamples);
+            buffer.clear();
+            for (int start = 0; start < numSamples; start += blockSize)
+                synth.renderNextBlock (buffer, {}, start, juce::jmin (blockSize, numSamples - start));
+            return buffer;
+        }
+
+        VoiceBank bank { 1 };
+        juce::Synthesiser synth;
+        SynthVoice* voice = nullptr;
+    };
+
+    float peakDifference (const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float peak = 0.0f;
+        for (int i = 0; i < a.getNumSamples(); ++i)
+            peak = juce::jmax (peak, std::abs (a.getSample (0, i) - b.getSample (0, i)));
+        return peak;
+    }
+}
+
+TEST_CASE ("Quality governor", "[quality]")
+{
+    QualityGovernor governor;
+    governor.prepare (sampleRate);
+
+    SECTION ("a light load keeps full quality")
+    {
+        CHECK (run (governor, 0.3f, 5.0) == QualityGovernor::Level::full);
+        CHECK (governor.getLoad() == Catch::Approx (0.3f).margin (0.01f));
+    }
+
+    SECTION ("disabled, it only measures")
+    {
+        CHECK (run (governor, 0.95f, 2.0, false) == QualityGovernor::Level::full);
+        CHECK (governor.getLoad() > 0.9f);
+        CHECK (governor.getNumDowngrades() == 0);
+    }
+
+    SECTION ("sustained pressure steps down one level at a time")
+    {
+        CHECK (run (governor, 0.95f, 0.1) == QualityGovernor::Level::full);  // the smoothed load is still rising
+        CHECK (run (governor, 0.95f, 0.3) == QualityGovernor::Level::reduced);
+        CHECK (run (governor, 0.95f, 2.0) == QualityGovernor::Level::minimal);
+        CHECK (governor.getNumDowngrades() == 3);
+    }
+
+    SECTION ("a block past its deadline steps down at once")
+    {
+        CHECK (governor.update (1.5 * blockSeconds, blockSize, true) == QualityGovernor::Level::reduced);
+    }
+
+    SECTION ("recovery waits for a calm stretch")
+    {
+        governor.update (1.5 * blockSeconds, blockSize, true);
+        REQUIRE (governor.getLevel() == QualityGovernor::Level::reduced);
+
+        // Between the thresholds nothing moves either way
+        CHECK (run (governor, 0.65f, 5.0) == QualityGovernor::Level::reduced);
+
+        CHECK (run (governor, 0.2f, 1.0) == QualityGovernor::Level::reduced);
+        CHECK (run (governor, 0.2f, 2.0) == QualityGovernor::Level::full);
+    }
+
+    SECTION ("the levels give up features in order")
+    {
+        using Level = QualityGovernor::Level;
+        CHECK (QualityGovernor::allowsHqFilter (Level::full));
+        CHECK_FALSE (QualityGovernor::allowsHqFilter (Level::reduced));
+        CHECK (QualityGovernor::allowsDriveOversampling (Level::reduced));
+        CHECK_FALSE (QualityGovernor::allowsDriveOversampling (Level::low));
+        CHECK (QualityGovernor::getMaxUnisonVoices (Level::low) < QualityGovernor::getMaxUnisonVoices (Level::reduced));
+        CHECK (QualityGovernor::cutsQuietTails (Level::minimal));
+        CHECK_FALSE (QualityGovernor::cutsQuietTails (Level::low));
+    }
+}
+
+TEST_CASE ("Quality steps don't click sounding voices", "[quality]")
+{
+    VoiceParameters params;
+    params.driveAmount = 0.6f;
+    params.filterResonance = 0.7f;
+
+    SECTION ("oversampling changes wait for the next note")
+    {
+        TestVoice steady (params), stepped (params);
+        for (auto* v : { &steady, &stepped })
+        {
+            v->synth.noteOn (1, 36, 1.0f);
+            v->render (4800);
+        }
+
+        // The governor steps down mid-note: the note plays on unchanged
+        stepped.voice->setFilterOversampling (true);
+        stepped.voice->setDriveOversampling (false);
+        CHECK (peakDifference (steady.render (4800), stepped.render (4800)) == 0.0f);
+
+        // ...and the next note from silence takes the new settings
+        for (auto* v : { &steady, &stepped })
+        {
+            v->synth.noteOff (1, 36, 0.0f, false);
+            v->synth.noteOn (1, 36, 1.0f);
+        }
+
+        CHECK (peakDifference (steady.render (4800), stepped.render (4800)) > 1.0e-4f);
+    }
+
+    SECTION ("a cut tail fades out over a few milliseconds")
+    {
+        params.ampRelease = 4.0f;
+        TestVoice test (params);
+        test.synth.noteOn (1, 36, 1.0f);
+        test.render (4800);
+        test.synth.noteOff (1, 36, 0.0f, true);
+
+        // Not quiet enough yet
+        CHECK_FALSE (test.voice->cutQuietTail (QualityGovernor::quietTailLevel));
+
+        int released = 0;
+        while (! test.voice->cutQuietTail (QualityGovernor::quietTailLevel))
+        {
+            test.render (blockSize);
+            released += blockSize;
+            REQUIRE (released < 10 * 48000);
+        }
+
+        // Still sounding straight after the cut, silent and free a few ms later
+        CHECK (test.voice->isVoiceActive());
+        const auto fade = test.render (blockSize);
+        CHECK (fade.getMagnitude (0, 0, 16) > 0.0f);
+        CHECK (fade.getMagnitude (0, 0, 16) > fade.getMagnitude (0, 240, 16));
+        CHECK_FALSE (test.voice->isVoiceActive());
+    }
+}
@@ -0,0 +1,232 @@
+#include "helpers/render_helpers.h"
+#include <RenderDaemon.h>
+#include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <mutex>
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr double tailSeconds = 1.0;
+    constexpr int noteOffSample = 24000;
+    constexpr int totalSamples = noteOffSample + static_cast<int> (tailSeconds * sampleRate);
+
+    // Client stub: sends request lines and collects the responses by job id
+    class Client
+    {
+    public:
+        explicit Client (int numInstances)
+            : daemon ({ numInstances, sampleRate, blockSize }, [this] (const juce::String& line) {
+                  const std::lock_guard guard (lock);
+                  responses.push_back (juce::JSON::parse (line));
+              })
+        {
+        }
+
+        void sendJob (const juce::String& id, const juce::File& midi, const juce::File& output, const juce::String& extra = {})
+        {
+            REQUIRE (daemon.handleLine ("{\"id\": \"" + id + "\", \"midi\": " + juce::JSON::toString (midi.getFullPathName())
+                                        + ", \"output\": " + juce::JSON::toString (output.getFullPathName())
+                                        + ", \"tail\": " + juce::String (tailSeconds) + ", \"bitDepth\": 32" + extra + "}"));
+        }
+
+        std::vector<juce::var> collectInOrder()
+        {
+            daemon.waitForJobs();
+
+            const std::lock_guard guard (lock);
+            return responses;
+        }
+
+        std::map<juce::String, juce::var> collect()
+        {
+            std::map<juce::String, juce::var> byId;
+            for (const auto& response : collectInOrder())
+                byId[response["id"].toString()] = response;
+            return byId;
+        }
+
+    private:
+        std::mutex lock;
+        std::vector<juce::var> responses;
+
+    public:
+        RenderDaemon daemon;
+    };
+
+    // Half a second of C1
+    juce::File writeMidiFile (const juce::File& directory)
+    {
+        juce::MidiMessageSequence track;
+        track.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0.0);
+        track.addEvent (juce::MidiMessage::noteOff (1, 36), 960.0);  // 120 bpm: half a second
+
+        juce::MidiFile midiFile;
+        midiFile.setTicksPerQuarterNote (960);
+        midiFile.addTrack (track);
+
+        const auto file = directory.getChildFile ("note.mid");
+        juce::FileOutputStream stream (file);
+        REQUIRE (midiFile.writeTo (stream));
+        return file;
+    }
+
+    juce::File writeStateFile (const juce::File& directory)
+    {
+        PluginProcessor plugin;
+        plugin.getAPVTS().getParameter (PluginProcessor::FILTER_CUTOFF_ID)->setValueNotifyingHost (0.2f);
+
+        juce::MemoryBlock state;
+        plugin.getStateInformation (state);
+
+        const auto file = directory.getChildFile ("bright.state");
+        REQUIRE (file.replaceWithData (state.getData(), state.getSize()));
+        return file;
+    }
+
+    // A state that changes what presets don't: FX rack, LFO 2 and a matrix route
+    juce::File writeFxStateFile (const juce::File& directory)
+    {
+        PluginProcessor plugin;
+        auto& apvts = plugin.getAPVTS();
+        apvts.getParameter (PluginProcessor::FX_CHORUS_ENABLED_ID)->setValueNotifyingHost (1.0f);
+        apvts.getParameter (PluginProcessor::FX_CHORUS_MIX_ID)->setValueNotifyingHost (1.0f);
+        apvts.getParameter (PluginProcessor::FX_COMP_ENABLED_ID)->setValueNotifyingHost (1.0f);
+        apvts.getParameter (PluginProcessor::LFO2_RATE_ID)->setValueNotifyingHost (0.8f);
+        apvts.getParameter (PluginProcessor::MOD_AMOUNT_IDS[0])->setValueNotifyingHost (1.0f);
+
+        juce::MemoryBlock state;
+        plugin.getStateInformation (state);
+
+        const auto file = directory.getChildFile ("chorus.state");
+        REQUIRE (file.replaceWithData (state.getData(), state.getSize()));
+        return file;
+    }
+
+    juce::AudioBuffer<float> readWav (const juce::File& file)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        REQUIRE (reader != nullptr);
+
+        juce::AudioBuffer<float> buffer (static_cast<int> (reader->numChannels), static_cast<int> (reader->lengthInSamples));
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return buffer;
+    }
+
+    // The same note through a freshly constructed processor, rendering offline
+    juce::AudioBuffer<float> renderFresh (int presetIndex = -1)
+    {
+        PluginProcessor plugin;
+        if (presetIndex >= 0)
+        {
+            auto& presets = plugin.getPresetManager();
+            presets.setCurrentPresetIndex (presetIndex);
+            plugin.loadPreset (presets.getCurrentPreset());
+        }
+
+        plugin.setNonRealtime (true);
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+        plugin.reset();
+
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0);
+        midi.addEvent (juce::MidiMessage::noteOff (1, 36), noteOffSample);
+        return render_helpers::renderMidi (plugin, midi, totalSamples, blockSize);
+    }
+}
+
+TEST_CASE ("Render daemon", "[daemon]")
+{
+    juce::TemporaryFile tempDirectory;
+    const auto directory = tempDirectory.getFile();
+    REQUIRE (directory.createDirectory());
+
+    const auto midiFile = writeMidiFile (directory);
+
+    SECTION ("jobs render to disk and answer by id")
+    {
+        const auto stateFile = writeStateFile (directory);
+
+        Client client (2);
+        client.sendJob ("first", midiFile, directory.getChildFile ("first.wav"));
+        client.sendJob ("again", midiFile, directory.getChildFile ("again.wav"));
+        client.sendJob ("bright", midiFile, directory.getChildFile ("bright.wav"), ", \"state\": " + juce::JSON::toString (stateFile.getFullPathName()));
+        client.sendJob ("missing", directory.getChildFile ("missing.mid"), directory.getChildFile ("missing.wav"));
+
+        auto responses = client.collect();
+        REQUIRE (responses.size() == 4);
+        CHECK (responses["first"]["status"].toString() == "ok");
+        CHECK (responses["again"]["status"].toString() == "ok");
+        CHECK (responses["bright"]["status"].toString() == "ok");
+        CHECK (responses["missing"]["status"].toString() == "error");
+        CHECK (static_cast<int> (responses["first"]["samples"]) == totalSamples);
+
+        // A reused instance renders like a fresh one
+        const auto first = readWav (directory.getChildFile ("first.wav"));
+        const auto fresh = renderFresh();
+        REQUIRE (first.getNumSamples() == totalSamples);
+        CHECK (render_helpers::peakAbsoluteDifference (first, fresh) < 1.0e-5f);
+        CHECK (render_helpers::peakAbsoluteDifference (readWav (directory.getChildFile ("again.wav")), fresh) < 1.0e-5f);
+        CHECK (render_helpers::peakAbsoluteDifference (readWav (directory.getChildFile ("bright.wav")), fresh) > 0.01f);
+    }
+
+    SECTION ("a warm instance keeps its state and preparation")
+    {
+        Client client (1);
+        for (const auto* id : { "a", "b", "c" })
+            client.sendJob (id, midiFile, directory.getChildFile (juce::String (id) + ".wav"), ", \"preset\": 1");
+        client.collect();
+
+        auto stats = client.daemon.getStats();
+        CHECK (stats.jobsRendered == 3);
+        CHECK (stats.statesRestored == 1);
+        CHECK (stats.instancesPrepared == 1);
+
+        client.sendJob ("d", midiFile, directory.getChildFile ("d.wav"), ", \"preset\": 1, \"blockSize\": 128");
+        client.collect();
+        CHECK (client.daemon.getStats().instancesPrepared == 2);
+    }
+
+    SECTION ("a preset job doesn't inherit the previous job's state")
+    {
+        const auto stateFile = writeFxStateFile (directory);
+
+        // One instance, so both jobs land on it one after the other
+        Client client (1);
+        client.sendJob ("chorus", midiFile, directory.getChildFile ("chorus.wav"), ", \"state\": " + juce::JSON::toString (stateFile.getFullPathName()));
+        client.collect();
+        client.sendJob ("preset", midiFile, directory.getChildFile ("preset.wav"), ", \"preset\": 1");
+
+        auto responses = client.collect();
+        REQUIRE (responses["chorus"]["status"].toString() == "ok");
+        REQUIRE (responses["preset"]["status"].toString() == "ok");
+
+        const auto fresh = renderFresh (1);
+        CHECK (render_helpers::peakAbsoluteDifference (readWav (directory.getChildFile ("preset.wav")), fresh) < 1.0e-5f);
+
+        // ...while the state job really did sound different from a fresh instance
+        CHECK (render_helpers::peakAbsoluteDifference (readWav (directory.getChildFile ("chorus.wav")), renderFresh()) > 0.01f);
+    }
+
+    SECTION ("bad requests are answered, quit ends the session")
+    {
+        Client client (1);
+        CHECK (client.daemon.handleLine ("not json"));
+        CHECK (client.daemon.handleLine ("{\"id\": \"x\", \"midi\": \"nowhere.mid\"}"));
+        CHECK (client.daemon.handleLine ("{\"command\": \"stats\"}"));
+        CHECK_FALSE (client.daemon.handleLine ("{\"command\": \"quit\"}"));
+
+        // Requests that never reach a worker are answered straight away, in order
+        const auto responses = client.collectInOrder();
+        REQUIRE (responses.size() == 3);
+        CHECK (responses[0]["status"].toString() == "error");
+        CHECK (responses[1]["id"].toString() == "x");
+        CHECK (responses[1]["status"].toString() == "error");
+        CHECK (static_cast<int> (responses[2]["instances"]) == 1);
+    }
+}
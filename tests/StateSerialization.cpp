@@ -0,0 +1,285 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Binary state round trip", "[state]")
+{
+    PluginProcessor source;
+    source.nextPreset();
+    source.getAPVTS().getParameter (PluginProcessor::FILTER_CUTOFF_ID)->setValueNotifyingHost (0.42f);
+
+    juce::MemoryBlock state;
+    source.getStateInformation (state);
+
+    REQUIRE (StateSerializer::isBinaryState (state.getData(), static_cast<int> (state.getSize())));
+
+    PluginProcessor restored;
+    restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+    CHECK (restored.getPresetManager().getCurrentPresetIndex() == source.getPresetManager().getCurrentPresetIndex());
+
+    for (auto* p : source.getParameters())
+    {
+        auto* sourceParam = dynamic_cast<juce::RangedAudioParameter*> (p);
+        REQUIRE (sourceParam != nullptr);
+
+        auto* restoredParam = restored.getAPVTS().getParameter (sourceParam->getParameterID());
+        REQUIRE (restoredParam != nullptr);
+
+        INFO (sourceParam->getParameterID());
+        CHECK (restoredParam->getValue() == Catch::Approx (sourceParam->getValue()).margin (1.0e-6));
+    }
+}
+
+TEST_CASE ("Legacy XML state is still read", "[state]")
+{
+    PluginProcessor source;
+    source.getAPVTS().getParameter (PluginProcessor::DRIVE_AMOUNT_ID)->setValueNotifyingHost (0.75f);
+
+    // What getStateInformation used to write
+    juce::MemoryBlock legacyState;
+    std::unique_ptr<juce::XmlElement> xml (source.getAPVTS().copyState().createXml());
+    juce::AudioProcessor::copyXmlToBinary (*xml, legacyState);
+
+    REQUIRE_FALSE (StateSerializer::isBinaryState (legacyState.getData(), static_cast<int> (legacyState.getSize())));
+
+    PluginProcessor restored;
+    restored.setStateInformation (legacyState.getData(), static_cast<int> (legacyState.getSize()));
+
+    CHECK (restored.getAPVTS().getParameter (PluginProcessor::DRIVE_AMOUNT_ID)->getValue() == Catch::Approx (0.75f).margin (0.01));
+}
+
+TEST_CASE ("Cached state follows parameter changes", "[state]")
+{
+    PluginProcessor plugin;
+
+    juce::MemoryBlock first, second;
+    plugin.getStateInformation (first);
+    CHECK (plugin.getNumStateWrites() == 1);
+
+    // Nothing changed: the blob comes from the cache, not a second write
+    plugin.getStateInformation (second);
+    CHECK (plugin.getNumStateWrites() == 1);
+    CHECK (first == second);
+
+    plugin.getAPVTS().getParameter (PluginProcessor::SUB_MIX_ID)->setValueNotifyingHost (0.123f);
+
+    juce::MemoryBlock changed;
+    plugin.getStateInformation (changed);
+    CHECK (plugin.getNumStateWrites() == 2);
+    CHECK (changed != first);
+
+    // A change that isn't a parameter invalidates it too
+    plugin.getMorphEngine().setPadY (0.5f);
+    juce::MemoryBlock morphed;
+    plugin.getStateInformation (morphed);
+    CHECK (plugin.getNumStateWrites() == 3);
+    CHECK (morphed != changed);
+
+    PluginProcessor restored;
+    restored.setStateInformation (changed.getData(), static_cast<int> (changed.getSize()));
+    CHECK (restored.getAPVTS().getParameter (PluginProcessor::SUB_MIX_ID)->getValue() == Catch::Approx (0.123f).margin (0.01));
+}
+
+TEST_CASE ("A loaded user preset survives a state round trip", "[state]")
+{
+    juce::TemporaryFile tempDirectory;
+    const auto directory = tempDirectory.getFile();
+    REQUIRE (directory.createDirectory());
+
+    PresetLibrary library;
+    library.setDirectory (directory);
+
+    auto preset = PresetManager().getPresets()[2];
+    preset.name = "Basement Wobble";
+    REQUIRE (library.savePreset (preset, "tester", {}));
+
+    const auto files = directory.findChildFiles (juce::File::findFiles, false, juce::String ("*") + PresetLibrary::fileExtension);
+    REQUIRE (files.size() == 1);
+
+    PluginProcessor source;
+    REQUIRE (source.loadUserPreset (files[0]));
+
+    juce::MemoryBlock state;
+    source.getStateInformation (state);
+
+    SECTION ("name and file come back instead of the factory preset at the index")
+    {
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+        CHECK (restored.getCurrentPresetName() == "Basement Wobble");
+        CHECK (restored.getCurrentUserPresetFile() == files[0]);
+    }
+
+    SECTION ("a factory preset afterwards clears it")
+    {
+        source.nextPreset();
+        source.getStateInformation (state);
+
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+        CHECK (restored.getCurrentUserPresetFile() == juce::File());
+        CHECK (restored.getCurrentPresetName() == source.getCurrentPresetName());
+    }
+
+    SECTION ("readers that skip the chunks still get the parameters")
+    {
+        juce::MemoryBlock parametersOnly;
+        source.getStateInformation (parametersOnly);
+        int presetIndex = -1;
+
+        PluginProcessor restored;
+        CHECK (StateSerializer (restored.getAPVTS()).read (parametersOnly.getData(), static_cast<int> (parametersOnly.getSize()), presetIndex));
+        CHECK (presetIndex == source.getPresetManager().getCurrentPresetIndex());
+    }
+}
+
+TEST_CASE ("Morph slots and pad survive a state round trip", "[state][morph]")
+{
+    PluginProcessor source;
+    auto& morph = source.getMorphEngine();
+
+    VoiceParameters a, b, d;
+    a.filterCutoff = 180.0f;
+    a.unisonVoices = 3;
+    b.filterCutoff = 7200.0f;
+    b.glideTime = 0.25f;
+    b.modRoutes[1] = { static_cast<int> (ModSource::modWheel), static_cast<int> (ModDestination::drive), -0.4f };
+    d.subOctave = 2;
+    d.ampRelease = 1.5f;
+
+    morph.setSlot (0, a);
+    morph.setSlot (1, b);
+    morph.setSlot (3, d);
+    morph.setEnabled (true);
+
+    juce::MemoryBlock state;
+    source.getStateInformation (state);
+
+    SECTION ("changing the pad invalidates the cached state")
+    {
+        morph.setPadY (0.7f);
+
+        juce::MemoryBlock moved;
+        source.getStateInformation (moved);
+        CHECK (moved != state);
+    }
+
+    morph.setPadY (0.7f);
+    source.getStateInformation (state);
+
+    SECTION ("slots, pad Y and the enabled flag come back")
+    {
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        const auto& restoredMorph = restored.getMorphEngine();
+
+        CHECK (restoredMorph.isEnabled());
+        CHECK (restoredMorph.getPadY() == 0.7f);
+        CHECK (restoredMorph.isSlotUsed (0));
+        CHECK (restoredMorph.isSlotUsed (1));
+        CHECK_FALSE (restoredMorph.isSlotUsed (2));
+        CHECK (restoredMorph.isSlotUsed (3));
+
+        CHECK (restoredMorph.getSlot (0).filterCutoff == 180.0f);
+        CHECK (restoredMorph.getSlot (0).unisonVoices == 3);
+        CHECK (restoredMorph.getSlot (1).filterCutoff == 7200.0f);
+        CHECK (restoredMorph.getSlot (1).glideTime == 0.25f);
+        CHECK (restoredMorph.getSlot (1).modRoutes[1].source == static_cast<int> (ModSource::modWheel));
+        CHECK (restoredMorph.getSlot (1).modRoutes[1].destination == static_cast<int> (ModDestination::drive));
+        CHECK (restoredMorph.getSlot (1).modRoutes[1].amount == -0.4f);
+        CHECK (restoredMorph.getSlot (3).subOctave == 2);
+        CHECK (restoredMorph.getSlot (3).ampRelease == 1.5f);
+    }
+
+    SECTION ("a state without the morph block leaves morphing off")
+    {
+        juce::MemoryBlock parametersOnly;
+        StateSerializer (source.getAPVTS()).write (parametersOnly, 0);
+
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        restored.setStateInformation (parametersOnly.getData(), static_cast<int> (parametersOnly.getSize()));
+
+        CHECK_FALSE (restored.getMorphEngine().isEnabled());
+        for (int slot = 0; slot < MorphEngine::maxSlots; ++slot)
+            CHECK_FALSE (restored.getMorphEngine().isSlotUsed (slot));
+    }
+
+    SECTION ("a truncated morph block is ignored")
+    {
+        juce::MemoryBlock block;
+        {
+            juce::MemoryOutputStream stream (block, false);
+            morph.writeState (stream);
+        }
+
+        MorphEngine other;
+        juce::MemoryInputStream truncated (block.getData(), block.getSize() - 3, false);
+        CHECK_FALSE (other.readState (truncated));
+        CHECK_FALSE (other.isSlotUsed (0));
+    }
+}
+
+TEST_CASE ("A loaded cabinet IR survives a state round trip", "[state][cabinet]")
+{
+    juce::TemporaryFile tempDirectory;
+    const auto directory = tempDirectory.getFile();
+    REQUIRE (directory.createDirectory());
+
+    // A short decaying IR is enough - only the file reference is saved
+    const auto impulseFile = directory.getChildFile ("Small Room.wav");
+    {
+        juce::AudioBuffer<float> impulse (1, 256);
+        for (int i = 0; i < impulse.getNumSamples(); ++i)
+            impulse.setSample (0, i, std::pow (0.97f, static_cast<float> (i)));
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor (new juce::FileOutputStream (impulseFile), 48000.0, 1, 24, {}, 0));
+        REQUIRE (writer != nullptr);
+        REQUIRE (writer->writeFromAudioSampleBuffer (impulse, 0, impulse.getNumSamples()));
+    }
+
+    PluginProcessor source;
+    juce::MemoryBlock before;
+    source.getStateInformation (before);
+
+    REQUIRE (source.loadCabinetImpulse (impulseFile));
+
+    juce::MemoryBlock state;
+    source.getStateInformation (state);
+    CHECK (state != before);
+
+    SECTION ("the IR is loaded again from its file")
+    {
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+        CHECK (restored.getCabinet().hasImpulseResponse());
+        CHECK (restored.getCabinet().getImpulseName() == "Small Room");
+        CHECK (restored.getCabinetImpulseFile() == impulseFile);
+    }
+
+    SECTION ("a state without an IR clears the previous one")
+    {
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+        restored.setStateInformation (before.getData(), static_cast<int> (before.getSize()));
+
+        CHECK_FALSE (restored.getCabinet().hasImpulseResponse());
+        CHECK (restored.getCabinetImpulseFile() == juce::File());
+    }
+
+    SECTION ("a missing file keeps the reference but loads nothing")
+    {
+        REQUIRE (impulseFile.deleteFile());
+
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), static_cast<int> (state.getSize()));
+
+        CHECK_FALSE (restored.getCabinet().hasImpulseResponse());
+        CHECK (restored.getCabinetImpulseFile() == impulseFile);
+    }
+}
@@ -0,0 +1,131 @@
+#include <VoiceBank.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Voice bank lays oscillators out as voice-indexed lanes", "[voices]")
+{
+    VoiceBank bank (6);
+    bank.prepare (512);
+    const auto tileSize = bank.getTileSize();
+
+    SECTION ("a lane holds every voice in one aligned line")
+    {
+        CHECK (bank.getLaneStride() == VoiceBank::voicesPerLine);
+
+        for (int lane = 0; lane < VoiceBank::numLanes; ++lane)
+        {
+            INFO ("lane " << lane);
+            CHECK (reinterpret_cast<std::uintptr_t> (&bank.phase (lane, 0)) % VoiceBank::alignment == 0);
+
+            for (int voice = 0; voice < bank.getNumVoices(); ++voice)
+            {
+                CHECK (&bank.phase (lane, voice) == &bank.phase (lane, 0) + voice);
+                CHECK (bank.phase (lane, voice) == 0.0);
+            }
+        }
+
+        CHECK (reinterpret_cast<std::uintptr_t> (&bank.increment (0, 0, 0)) % VoiceBank::alignment == 0);
+        CHECK (&bank.increment (1, 0, 0) == &bank.increment (0, 0, 0) + VoiceBank::numLanes * bank.getLaneStride());
+    }
+
+    SECTION ("a tile of step rows fits the L1 budget, and never exceeds a block")
+    {
+        const auto tileBytes = static_cast<size_t> (tileSize * VoiceBank::numLanes * bank.getLaneStride()) * sizeof (double);
+        CHECK (tileSize > 1);
+        CHECK (tileSize < 512);
+        CHECK (tileBytes <= VoiceBank::tileBytes);
+
+        VoiceBank small (6);
+        small.prepare (16);
+        CHECK (small.getTileSize() == 16);
+    }
+
+    SECTION ("stepping all voices together matches stepping each on its own")
+    {
+        VoiceBank single (6);
+        single.prepare (512);
+
+        for (int voice = 0; voice < bank.getNumVoices(); ++voice)
+        {
+            for (int sample = 0; sample < tileSize; ++sample)
+            {
+                for (int lane = 0; lane < VoiceBank::numLanes; ++lane)
+                {
+                    const auto increment = 0.01 * (voice + 1) + 0.003 * lane + 0.0001 * sample;
+                    bank.increment (sample, lane, voice) = increment;
+                    single.increment (sample, lane, voice) = increment;
+                }
+            }
+
+            bank.markActive (voice);
+            single.stepVoice (voice, tileSize);
+        }
+
+        bank.stepActive (tileSize);
+
+        for (int voice = 0; voice < bank.getNumVoices(); ++voice)
+        {
+            for (int lane = 0; lane < VoiceBank::numLanes; ++lane)
+            {
+                CHECK (bank.phase (lane, voice) == single.phase (lane, voice));
+                CHECK (bank.phase (lane, voice) >= 0.0);
+                CHECK (bank.phase (lane, voice) < 1.0);
+
+                for (int sample = 0; sample < tileSize; ++sample)
+                    CHECK (bank.phaseAt (sample, lane, voice) == single.phaseAt (sample, lane, voice));
+            }
+        }
+    }
+
+    SECTION ("the rows hold the phase each sample was rendered at")
+    {
+        for (int sample = 0; sample < 4; ++sample)
+            bank.increment (sample, 0, 2) = 0.375;
+
+        bank.markActive (2);
+        bank.stepActive (4);
+
+        CHECK (bank.phaseAt (0, 0, 2) == 0.0);
+        CHECK (bank.phaseAt (1, 0, 2) == 0.375);
+        CHECK (bank.phaseAt (2, 0, 2) == 0.75);
+        CHECK (bank.phaseAt (3, 0, 2) == 0.125);
+        CHECK (bank.phase (0, 2) == 0.5);
+        CHECK (bank.phase (VoiceBank::subLane, 2) == 0.0);
+    }
+
+    SECTION ("voices that didn't write a tile stand still, whatever their rows held")
+    {
+        // A full line, with leftovers from an earlier tile in every voice's rows
+        VoiceBank full (VoiceBank::voicesPerLine);
+        full.prepare (512);
+
+        for (int voice = 0; voice < full.getNumVoices(); ++voice)
+            for (int sample = 0; sample < 3; ++sample)
+                for (int lane = 0; lane < VoiceBank::numLanes; ++lane)
+                    full.increment (sample, lane, voice) = 0.25;
+
+        // Enough voices sound for the line to step; the others must not move
+        auto isSounding = [] (int voice) { return voice != 2 && voice != 5; };
+        full.beginTile();
+        for (int voice = 0; voice < full.getNumVoices(); ++voice)
+            if (isSounding (voice))
+                full.markActive (voice);
+
+        REQUIRE (full.getNumActiveVoices() >= VoiceBank::minVoicesToStepTogether);
+        full.stepActive (3);
+
+        for (int voice = 0; voice < full.getNumVoices(); ++voice)
+        {
+            INFO ("voice " << voice);
+            CHECK (full.phase (0, voice) == (isSounding (voice) ? 0.75 : 0.0));
+
+            if (isSounding (voice))
+                CHECK (full.phaseAt (2, 0, voice) == 0.5);
+        }
+
+        // A new tile forgets them: nothing is marked, nothing steps
+        full.beginTile();
+        CHECK (full.getNumActiveVoices() == 0);
+        full.stepActive (3);
+        CHECK (full.phase (0, 0) == 0.75);
+    }
+}
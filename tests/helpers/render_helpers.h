@@ -0,0 +1,185 @@
+#pragma once
+#include <PluginProcessor.h>
+#include <juce_dsp/juce_dsp.h>
+
+/* Offline rendering helpers shared by the regression tests.
+ *
+ * The fixed phrase covers a short stab, a soft note, a hard accent and two
+ * overlapping legato notes (so glide and voice allocation are exercised),
+ * followed by enough silence for the longest factory release to finish.
+ */
+namespace render_helpers
+{
+    static constexpr double phraseLengthSeconds = 3.0;
+
+    [[maybe_unused]] static juce::MidiBuffer makeFixedPhrase (double sampleRate)
+    {
+        struct NoteEvent
+        {
+            int note;
+            juce::uint8 velocity;
+            double onSeconds;
+            double offSeconds;
+        };
+
+        static constexpr NoteEvent notes[] = {
+            { 36, 100, 0.00, 0.40 },
+            { 43, 64, 0.50, 0.90 },
+            { 48, 127, 1.00, 1.25 },
+            { 38, 90, 1.30, 1.80 },
+            { 41, 110, 1.60, 2.10 },
+        };
+
+        auto toSample = [sampleRate] (double seconds) { return juce::roundToInt (seconds * sampleRate); };
+
+        juce::MidiBuffer phrase;
+        for (const auto& n : notes)
+        {
+            phrase.addEvent (juce::MidiMessage::noteOn (1, n.note, n.velocity), toSample (n.onSeconds));
+            phrase.addEvent (juce::MidiMessage::noteOff (1, n.note), toSample (n.offSeconds));
+        }
+
+        return phrase;
+    }
+
+    // Renders a MIDI buffer through a prepared processor, slicing it into host-sized blocks
+    template <typename SampleType = float>
+    [[maybe_unused]] static juce::AudioBuffer<SampleType> renderMidi (PluginProcessor& plugin,
+        const juce::MidiBuffer& midi,
+        int totalSamples,
+        int blockSize)
+    {
+        const int numChannels = plugin.getTotalNumOutputChannels();
+        juce::AudioBuffer<SampleType> output (numChannels, totalSamples);
+        juce::AudioBuffer<SampleType> block (numChannels, blockSize);
+        juce::MidiBuffer blockMidi;
+
+        for (int pos = 0; pos < totalSamples; pos += blockSize)
+        {
+            const int numSamples = juce::jmin (blockSize, totalSamples - pos);
+            block.setSize (numChannels, numSamples, false, false, true);
+
+            blockMidi.clear();
+            for (const auto metadata : midi)
+                if (metadata.samplePosition >= pos && metadata.samplePosition < pos + numSamples)
+                    blockMidi.addEvent (metadata.getMessage(), metadata.samplePosition - pos);
+
+            plugin.processBlock (block, blockMidi);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                output.copyFrom (ch, pos, block, ch, 0, numSamples);
+        }
+
+        return output;
+    }
+
+    // Renders the fixed phrase with the given factory preset loaded
+    template <typename SampleType = float>
+    [[maybe_unused]] static juce::AudioBuffer<SampleType> renderFactoryPreset (int presetIndex, double sampleRate, int blockSize)
+    {
+        PluginProcessor plugin;
+        plugin.setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                          : juce::AudioProcessor::singlePrecision);
+        plugin.getPresetManager().setCurrentPresetIndex (presetIndex);
+        plugin.loadPreset (plugin.getPresetManager().getCurrentPreset());
+
+        plugin.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        plugin.prepareToPlay (sampleRate, blockSize);
+
+        const auto totalSamples = static_cast<int> (std::ceil (phraseLengthSeconds * sampleRate));
+        auto output = renderMidi<SampleType> (plugin, makeFixedPhrase (sampleRate), totalSamples, blockSize);
+
+        plugin.releaseResources();
+        return output;
+    }
+
+    //==============================================================================
+    // Comparison metrics
+
+    // RMS of (test - reference) relative to the RMS of the reference, in dB
+    [[maybe_unused]] static float relativeErrorDecibels (const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& test)
+    {
+        const int numChannels = juce::jmin (reference.getNumChannels(), test.getNumChannels());
+        const int numSamples = juce::jmin (reference.getNumSamples(), test.getNumSamples());
+
+        double errorEnergy = 0.0;
+        double referenceEnergy = 0.0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* ref = reference.getReadPointer (ch);
+            auto* out = test.getReadPointer (ch);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double diff = out[i] - ref[i];
+                errorEnergy += diff * diff;
+                referenceEnergy += static_cast<double> (ref[i]) * ref[i];
+            }
+        }
+
+        if (errorEnergy <= 0.0)
+            return -200.0f;
+
+        return static_cast<float> (10.0 * std::log10 (errorEnergy / juce::jmax (referenceEnergy, 1.0e-20)));
+    }
+
+    [[maybe_unused]] static float peakAbsoluteDifference (const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& test)
+    {
+        const int numChannels = juce::jmin (reference.getNumChannels(), test.getNumChannels());
+        const int numSamples = juce::jmin (reference.getNumSamples(), test.getNumSamples());
+
+        float peak = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                peak = juce::jmax (peak, std::abs (test.getSample (ch, i) - reference.getSample (ch, i)));
+
+        return peak;
+    }
+
+    // Long-term average spectrum of channel 0, summed into log-spaced bands (dB)
+    [[maybe_unused]] static std::vector<float> bandSpectrumDecibels (const juce::AudioBuffer<float>& buffer, double sampleRate, int numBands = 32)
+    {
+        constexpr int fftOrder = 12;
+        constexpr int fftSize = 1 << fftOrder;
+        constexpr int hopSize = fftSize / 2;
+
+        juce::dsp::FFT fft (fftOrder);
+        juce::dsp::WindowingFunction<float> window (fftSize, juce::dsp::WindowingFunction<float>::hann, false);
+
+        std::vector<float> frame (2 * fftSize);
+        std::vector<double> power (fftSize / 2 + 1, 0.0);
+        auto* data = buffer.getReadPointer (0);
+
+        for (int start = 0; start + fftSize <= buffer.getNumSamples(); start += hopSize)
+        {
+            std::fill (frame.begin(), frame.end(), 0.0f);
+            std::copy (data + start, data + start + fftSize, frame.begin());
+            window.multiplyWithWindowingTable (frame.data(), fftSize);
+            fft.performFrequencyOnlyForwardTransform (frame.data(), true);
+
+            for (size_t bin = 0; bin < power.size(); ++bin)
+                power[bin] += static_cast<double> (frame[bin]) * frame[bin];
+        }
+
+        const double minHz = 20.0;
+        const double maxHz = sampleRate * 0.5;
+        std::vector<float> bands (static_cast<size_t> (numBands));
+
+        for (int b = 0; b < numBands; ++b)
+        {
+            const double lowHz = minHz * std::pow (maxHz / minHz, b / static_cast<double> (numBands));
+            const double highHz = minHz * std::pow (maxHz / minHz, (b + 1) / static_cast<double> (numBands));
+            const auto lowBin = static_cast<size_t> (lowHz * fftSize / sampleRate);
+            const auto highBin = juce::jmin (power.size() - 1, static_cast<size_t> (highHz * fftSize / sampleRate));
+
+            double energy = 0.0;
+            for (auto bin = lowBin; bin <= highBin; ++bin)
+                energy += power[bin];
+
+            bands[static_cast<size_t> (b)] = static_cast<float> (10.0 * std::log10 (energy + 1.0e-20));
+        }
+
+        return bands;
+    }
+}